@@ -5,8 +5,11 @@
  *
 */
 
+#include <algorithm>
 #include <array>
 #include <iostream>
+#include <nftables/libnftables.h>
+#include <set>
 #include <spdlog/spdlog.h>
 #include <sstream>
 #include "firewall/Firewall.h"
@@ -23,15 +26,37 @@ const auto ipv6_matches = "/ietf-access-control-list:acls/acl/aces/ace/matches/i
 const auto action = "/ietf-access-control-list:acls/acl/aces/ace/actions/forwarding";
 }
 
-std::string generateNftConfig(velia::Log logger, const libyang::DataNode& tree, const std::vector<std::filesystem::path>& nftIncludes)
+const auto LOCALHOST_RULE_COMMENT = "Accept any localhost traffic"s;
+
+/** @short Extracts the handles of the added rules from the echo of nft, as a multimap of rule comment -> handle, in the order of the rules */
+std::multimap<std::string, uint64_t> parseEcho(const std::string& echo)
 {
-    std::ostringstream ss;
-    ss << "flush ruleset" << "\n";
-    ss << "add table inet filter" << "\n";
-    ss << "add chain inet filter acls { type filter hook input priority 0; }\n";
-    ss << "add rule inet filter acls ct state established,related accept\n";
-    ss << "add rule inet filter acls iif lo accept comment \"Accept any localhost traffic\"\n";
+    // e.g., `add rule inet filter acls ip saddr 192.0.2.0/24 drop comment "foo" # handle 5`
+    const auto handleMarker = " # handle "s;
+    const auto commentMarker = " comment \""s;
+
+    std::multimap<std::string, uint64_t> res;
+    std::istringstream ss(echo);
+    std::string line;
+    while (std::getline(ss, line)) {
+        auto handlePos = line.rfind(handleMarker);
+        auto commentPos = line.find(commentMarker);
+        if (handlePos == std::string::npos || commentPos == std::string::npos || commentPos > handlePos) {
+            continue;
+        }
+        auto nameBegin = commentPos + commentMarker.size();
+        auto nameEnd = line.rfind('"', handlePos);
+        res.emplace(line.substr(nameBegin, nameEnd - nameBegin), std::stoull(line.substr(handlePos + handleMarker.size())));
+    }
+    return res;
+}
+}
+
+namespace velia::firewall {
 
+/** @short Translates the ACL config @p tree into the nftables rules, in the order of the ACEs */
+std::vector<Rule> parseAcl(velia::Log logger, const libyang::DataNode& tree)
+{
     constexpr std::array skippedNodes{
         // Top-level container - don't care
         "/ietf-access-control-list:acls",
@@ -53,6 +78,7 @@ std::string generateNftConfig(velia::Log logger, const libyang::DataNode& tree,
     };
 
     logger->trace("traversing the tree");
+    std::vector<Rule> rules;
     std::string comment;
     std::string match;
     for (auto node : tree.childrenDfs()) {
@@ -70,27 +96,28 @@ std::string generateNftConfig(velia::Log logger, const libyang::DataNode& tree,
             comment = velia::utils::asString(node);
         } else if (nodeSchemaPath == nodepaths::ipv4_matches) {
             // Here we save the ip we're matching against.
-            match = " ip saddr "s + velia::utils::asString(node);
+            match = "ip saddr "s + velia::utils::asString(node) + " ";
         } else if (nodeSchemaPath == nodepaths::ipv6_matches) {
             // Here we save the ip we're matching against.
-            match = " ip6 saddr "s + velia::utils::asString(node);
+            match = "ip6 saddr "s + velia::utils::asString(node) + " ";
         } else if (nodeSchemaPath == nodepaths::action) {
             // Action is the last statement we get, so this is where we create the actual rule.
-            ss << "add rule inet filter acls" << match;
+            auto statement = match;
             auto action = velia::utils::asString(node);
             if (action == "ietf-access-control-list:accept") {
-                ss << " accept";
+                statement += "accept";
             } else if (action == "ietf-access-control-list:drop") {
-                ss << " drop";
+                statement += "drop";
             } else if (action == "ietf-access-control-list:reject") {
-                ss << " reject";
+                statement += "reject";
             } else {
                 // This should theoretically never happen.
                 throw std::logic_error("unsupported ACE action: "s + action);
             }
 
             // After the action, we only add the comment. This is the end of the rule.
-            ss << " comment \"" << comment << "\"\n";
+            statement += " comment \"" + comment + "\"";
+            rules.push_back({comment, statement});
             match = "";
             comment = "";
         } else {
@@ -98,33 +125,210 @@ std::string generateNftConfig(velia::Log logger, const libyang::DataNode& tree,
         }
     }
 
+    return rules;
+}
+
+/** @short Renders a script for `nft -f` which replaces the whole ruleset with the fixed rules and the ACE @p rules */
+std::string generateNftConfig(const std::vector<Rule>& rules, const std::vector<std::filesystem::path>& nftIncludes)
+{
+    std::ostringstream ss;
+    ss << "flush ruleset" << "\n";
+    ss << "add table inet filter" << "\n";
+    ss << "add chain inet filter acls { type filter hook input priority 0; }\n";
+    ss << "add rule inet filter acls ct state established,related accept\n";
+    ss << "add rule inet filter acls iif lo accept comment \"" << LOCALHOST_RULE_COMMENT << "\"\n";
+
+    for (const auto& rule : rules) {
+        ss << "add rule inet filter acls " << rule.statement << "\n";
+    }
+
     for (const auto& path : nftIncludes) {
         ss << "include \"" << path.c_str() << "\"\n";
     }
 
     return ss.str();
 }
+
+/** @short Translates the ACL config @p tree into a script for `nft -f` */
+std::string generateNftConfig(velia::Log logger, const libyang::DataNode& tree, const std::vector<std::filesystem::path>& nftIncludes)
+{
+    return generateNftConfig(parseAcl(logger, tree), nftIncludes);
+}
+
+/**
+ * @short Renders a script for `nft -f` which turns the @p installed ACE rules into the new @p rules
+ *
+ * The rules which keep their relative order stay in place, and they are replaced only when their statement changes. All
+ * other rules are deleted, and the new or moved ones are added right behind the preceding rule which stays in place.
+ * The result is empty when there is nothing to change.
+ */
+std::string generateNftUpdate(const InstalledRules& installed, const std::vector<Rule>& rules)
+{
+    std::map<std::string, size_t> installedIndexes;
+    for (size_t i = 0; i < installed.rules.size(); ++i) {
+        installedIndexes.emplace(installed.rules[i].name, i);
+    }
+
+    // The rules which stay in place are the longest subsequence of the new rules which keeps the installed order
+    std::vector<size_t> tails; // index into rules of the last element of the best increasing subsequence of length i+1
+    std::vector<std::optional<size_t>> predecessors(rules.size());
+    for (size_t i = 0; i < rules.size(); ++i) {
+        auto it = installedIndexes.find(rules[i].name);
+        if (it == installedIndexes.end()) {
+            continue;
+        }
+        auto pos = std::lower_bound(tails.begin(), tails.end(), it->second, [&](size_t ruleIndex, size_t installedIndex) {
+            return installedIndexes.at(rules[ruleIndex].name) < installedIndex;
+        });
+        if (pos != tails.begin()) {
+            predecessors[i] = *std::prev(pos);
+        }
+        if (pos == tails.end()) {
+            tails.push_back(i);
+        } else {
+            *pos = i;
+        }
+    }
+    std::vector<bool> inPlace(rules.size());
+    for (auto i = tails.empty() ? std::nullopt : std::optional{tails.back()}; i; i = predecessors[*i]) {
+        inPlace[*i] = true;
+    }
+
+    std::set<std::string> kept;
+    for (size_t i = 0; i < rules.size(); ++i) {
+        if (inPlace[i]) {
+            kept.insert(rules[i].name);
+        }
+    }
+
+    std::ostringstream ss;
+    for (const auto& rule : installed.rules) {
+        if (!kept.contains(rule.name)) {
+            ss << "delete rule inet filter acls handle " << installed.handles.at(rule.name) << "\n";
+        }
+    }
+
+    auto anchor = installed.anchor;
+    std::vector<const Rule*> added;
+    auto addBehindAnchor = [&]() {
+        // all of them are added right behind the same rule, so the last one goes first
+        for (auto it = added.rbegin(); it != added.rend(); ++it) {
+            ss << "add rule inet filter acls position " << anchor << " " << (*it)->statement << "\n";
+        }
+        added.clear();
+    };
+    for (size_t i = 0; i < rules.size(); ++i) {
+        if (!inPlace[i]) {
+            added.push_back(&rules[i]);
+            continue;
+        }
+
+        addBehindAnchor();
+        anchor = installed.handles.at(rules[i].name);
+        if (installed.rules[installedIndexes.at(rules[i].name)].statement != rules[i].statement) {
+            ss << "replace rule inet filter acls handle " << anchor << " " << rules[i].statement << "\n";
+        }
+    }
+    addBehindAnchor();
+
+    return ss.str();
+}
 }
 
 velia::firewall::SysrepoFirewall::SysrepoFirewall(sysrepo::Session srSess, NftConfigConsumer consumer, const std::vector<std::filesystem::path>& nftIncludeFiles)
-    : m_sub()
-    , m_log(spdlog::get("firewall"))
+    : m_log(spdlog::get("firewall"))
+    , m_consumer(std::move(consumer))
+    , m_nftIncludeFiles(nftIncludeFiles)
 {
     auto lyCtx = srSess.getContext();
     utils::ensureModuleImplemented(srSess, "ietf-access-control-list", "2019-03-04");
     utils::ensureModuleImplemented(srSess, "czechlight-firewall", "2021-01-25");
 
-    sysrepo::ModuleChangeCb cb = [nftIncludeFiles, logger = m_log, consumer = std::move(consumer)] (sysrepo::Session session, auto, auto, auto, auto, auto) {
-        logger->debug("Applying new data from sysrepo");
+    sysrepo::ModuleChangeCb cb = [this] (sysrepo::Session session, auto, auto, auto, auto, auto) {
+        m_log->debug("Applying new data from sysrepo");
         auto data = session.getData("/" + ietf_acl_module + ":*");
-
-        auto config = generateNftConfig(logger, *data, nftIncludeFiles);
-        logger->trace("running the consumer...");
-        consumer(config);
-        logger->trace("consumer done.");
-
+        apply(parseAcl(m_log, *data));
         return sysrepo::ErrorCode::Ok;
     };
 
     m_sub = srSess.onModuleChange(ietf_acl_module, cb, std::nullopt, 0, sysrepo::SubscribeOptions::DoneOnly | sysrepo::SubscribeOptions::Enabled);
 }
+
+/** @short Changes just the ACE rules which differ from what is installed, or loads the whole ruleset if that is not possible */
+void velia::firewall::SysrepoFirewall::apply(const std::vector<Rule>& rules)
+{
+    if (m_installed) {
+        auto script = generateNftUpdate(*m_installed, rules);
+        if (script.empty()) {
+            m_log->debug("No change of the ACE rules");
+            return;
+        }
+
+        try {
+            m_log->trace("running the consumer...");
+            auto echo = parseEcho(m_consumer(script));
+            m_log->trace("consumer done.");
+
+            std::map<std::string, uint64_t> handles;
+            for (const auto& rule : rules) {
+                if (auto it = echo.find(rule.name); it != echo.end()) {
+                    handles.emplace(rule.name, it->second);
+                } else if (auto it = m_installed->handles.find(rule.name); it != m_installed->handles.end()) {
+                    handles.emplace(rule.name, it->second);
+                } else {
+                    throw std::runtime_error{"nft did not report the handle of the rule for ACE '" + rule.name + "'"};
+                }
+            }
+            m_installed = InstalledRules{rules, std::move(handles), m_installed->anchor};
+            return;
+        } catch (const std::exception& e) {
+            m_log->warn("Cannot update the ACE rules ({}), reloading the whole ruleset", e.what());
+            m_installed.reset();
+        }
+    }
+
+    m_log->trace("running the consumer...");
+    auto echo = parseEcho(m_consumer(generateNftConfig(rules, m_nftIncludeFiles)));
+    m_log->trace("consumer done.");
+
+    // every ACE comment is unique, but an ACE can be named just like the localhost rule which is echoed first
+    InstalledRules installed{rules, {}, 0};
+    auto anchor = echo.extract(LOCALHOST_RULE_COMMENT);
+    if (!anchor) {
+        throw std::runtime_error{"nft did not report the handle of the localhost rule"};
+    }
+    installed.anchor = anchor.mapped();
+    for (const auto& rule : rules) {
+        auto it = echo.find(rule.name);
+        if (it == echo.end()) {
+            throw std::runtime_error{"nft did not report the handle of the rule for ACE '" + rule.name + "'"};
+        }
+        installed.handles.emplace(rule.name, it->second);
+    }
+    m_installed = std::move(installed);
+}
+
+velia::firewall::Nftables::Nftables()
+    : m_ctx(nft_ctx_new(NFT_CTX_DEFAULT), nft_ctx_free)
+{
+    if (!m_ctx) {
+        throw std::runtime_error{"Cannot create the nftables context"};
+    }
+    nft_ctx_output_set_flags(m_ctx.get(), nft_ctx_output_get_flags(m_ctx.get()) | NFT_CTX_OUTPUT_ECHO | NFT_CTX_OUTPUT_HANDLE);
+    if (nft_ctx_buffer_output(m_ctx.get()) != 0 || nft_ctx_buffer_error(m_ctx.get()) != 0) {
+        throw std::runtime_error{"Cannot set up the nftables output buffers"};
+    }
+}
+
+/** @short Runs the @p script in a single transaction, and returns its echo. Throws with the nft error message on failure. */
+std::string velia::firewall::Nftables::run(const std::string& script)
+{
+    auto ret = nft_run_cmd_from_buffer(m_ctx.get(), script.c_str());
+    // the buffers are reused by the next command, so they have to be read (and reset) each time
+    std::string output = nft_ctx_get_output_buffer(m_ctx.get());
+    std::string error = nft_ctx_get_error_buffer(m_ctx.get());
+    if (ret != 0) {
+        throw std::runtime_error{"nft failed: " + error};
+    }
+    return output;
+}
@@ -5,17 +5,55 @@
  *
 */
 
+#pragma once
+
+#include <map>
 #include <sysrepo-cpp/Subscription.hpp>
 #include "utils/log-fwd.h"
 
 namespace velia::firewall {
+/** @short One ACE, as an nftables rule in the `inet filter acls` chain */
+struct Rule {
+    std::string name; ///< ACE name, which is also used as the rule comment
+    std::string statement; ///< everything after the chain name, e.g., `ip saddr 192.0.2.0/24 drop comment "foo"`
+    bool operator==(const Rule& other) const noexcept = default;
+};
+
+/** @short The ACE rules as they are installed in the kernel */
+struct InstalledRules {
+    std::vector<Rule> rules;
+    std::map<std::string, uint64_t> handles; ///< ACE name -> handle of its rule
+    uint64_t anchor; ///< handle of the last fixed rule which precedes all ACEs
+};
+
+std::vector<Rule> parseAcl(velia::Log logger, const libyang::DataNode& tree);
+std::string generateNftConfig(const std::vector<Rule>& rules, const std::vector<std::filesystem::path>& nftIncludes);
+std::string generateNftConfig(velia::Log logger, const libyang::DataNode& tree, const std::vector<std::filesystem::path>& nftIncludes);
+std::string generateNftUpdate(const InstalledRules& installed, const std::vector<Rule>& rules);
+
 class SysrepoFirewall {
 public:
-    using NftConfigConsumer = std::function<void(const std::string& config)>;
+    /** @short Runs an nft script as a single transaction and returns its echo, i.e., the output of `nft --echo --handle -f -` */
+    using NftConfigConsumer = std::function<std::string(const std::string& config)>;
     SysrepoFirewall(sysrepo::Session srSess, NftConfigConsumer consumer, const std::vector<std::filesystem::path>& nftIncludeFiles = {});
 
 private:
-    std::optional<sysrepo::Subscription> m_sub;
     velia::Log m_log;
+    NftConfigConsumer m_consumer;
+    std::vector<std::filesystem::path> m_nftIncludeFiles;
+    std::optional<InstalledRules> m_installed; ///< nullopt until the whole ruleset is loaded for the first time, or after an update fails
+    std::optional<sysrepo::Subscription> m_sub; // last, so that the callbacks are gone before the state they use
+
+    void apply(const std::vector<Rule>& rules);
+};
+
+/** @short An in-process nftables instance, i.e., what `nft --echo --handle` does, but without spawning it */
+class Nftables {
+public:
+    Nftables();
+    std::string run(const std::string& script);
+
+private:
+    std::unique_ptr<struct nft_ctx, std::function<void(struct nft_ctx*)>> m_ctx;
 };
 }
@@ -107,6 +107,10 @@ HardwareInfo IETFHardware::process()
         pollData.merge(dataReader());
     }
 
+    for (const auto& observer : m_pollDataObservers) {
+        observer(pollData);
+    }
+
     /* the thresholds watchers are created dynamically
      *  - when a new sensor occurs then we add a new watcher
      *  - when a sensor disappears we remove the corresponding watcher
@@ -143,6 +147,11 @@ void IETFHardware::registerDataReader(const IETFHardware::DataReader& callable)
     m_callbacks.push_back(callable);
 }
 
+void IETFHardware::registerPollDataObserver(const IETFHardware::PollDataObserver& callable)
+{
+    m_pollDataObservers.push_back(callable);
+}
+
 /** @brief A namespace containing predefined data readers for IETFHardware class.
  * @see IETFHardware for more information
  */
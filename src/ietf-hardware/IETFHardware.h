@@ -72,11 +72,14 @@ class IETFHardware {
 public:
     /** @brief The component */
     using DataReader = std::function<SensorPollData()>;
+    /** @brief Gets the merged data from all data readers before they are processed */
+    using PollDataObserver = std::function<void(const SensorPollData&)>;
 
     IETFHardware();
     ~IETFHardware();
 
     void registerDataReader(const DataReader& callable);
+    void registerPollDataObserver(const PollDataObserver& callable);
     HardwareInfo process();
 
 private:
@@ -85,6 +88,8 @@ private:
     /** @brief registered components for individual modules */
     std::vector<DataReader> m_callbacks;
 
+    std::vector<PollDataObserver> m_pollDataObservers;
+
     /** @brief watchers for any sensor value xPath reported by data readers */
     std::map<std::string, Watcher<int64_t>> m_thresholdsWatchers;
 };
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <regex>
+#include "OpenMetrics.h"
+#include "utils/io.h"
+#include "utils/log.h"
+#include "utils/openmetrics.h"
+
+namespace {
+
+const auto SENSOR_VALUE = "velia_hardware_sensor_value";
+const auto SENSOR_OPER_STATUS = "velia_hardware_sensor_oper_status";
+const auto SENSOR_THRESHOLD = "velia_hardware_sensor_threshold_state";
+
+const std::vector<std::string> OPER_STATUSES{"ok", "unavailable", "nonoperational"};
+
+const std::vector<std::pair<velia::ietf_hardware::State, std::string>> THRESHOLD_STATES{
+    {velia::ietf_hardware::State::NoValue, "no-value"},
+    {velia::ietf_hardware::State::Disabled, "disabled"},
+    {velia::ietf_hardware::State::CriticalLow, "critical-low"},
+    {velia::ietf_hardware::State::WarningLow, "warning-low"},
+    {velia::ietf_hardware::State::Normal, "normal"},
+    {velia::ietf_hardware::State::WarningHigh, "warning-high"},
+    {velia::ietf_hardware::State::CriticalHigh, "critical-high"},
+};
+
+struct Sensor {
+    std::string component;
+    std::string xpath;
+    int64_t value;
+    std::string valueType;
+    std::string valueScale;
+    std::string operStatus;
+};
+
+std::string lookup(const velia::ietf_hardware::DataTree& dataTree, const std::string& key)
+{
+    if (auto it = dataTree.find(key); it != dataTree.end()) {
+        return it->second;
+    }
+    return "";
+}
+
+std::vector<Sensor> collectSensors(const velia::ietf_hardware::DataTree& dataTree)
+{
+    static const std::regex regex(R"(^(/ietf-hardware:hardware/component\[name='(.*)'\]/sensor-data/)value$)");
+    std::vector<Sensor> res;
+
+    for (const auto& [xpath, value] : dataTree) {
+        std::smatch match;
+        if (!std::regex_match(xpath, match, regex)) {
+            continue;
+        }
+
+        const auto prefix = match.str(1);
+        res.push_back(Sensor{
+            .component = match.str(2),
+            .xpath = xpath,
+            .value = std::stoll(value),
+            .valueType = lookup(dataTree, prefix + "value-type"),
+            .valueScale = lookup(dataTree, prefix + "value-scale"),
+            .operStatus = lookup(dataTree, prefix + "oper-status"),
+        });
+    }
+
+    return res;
+}
+}
+
+namespace velia::ietf_hardware {
+
+/** @short Renders sensors from the @p dataTree and their last known @p thresholdStates as a Prometheus text format document
+ *
+ * The sensor value is exported as is, i.e., the same way as the ietf-hardware YANG model does it. The value-type and value-scale are exported as labels.
+ */
+std::string renderOpenMetrics(const DataTree& dataTree, const std::map<std::string, State>& thresholdStates)
+{
+    const auto sensors = collectSensors(dataTree);
+    utils::openmetrics::Builder builder;
+
+    builder.family(SENSOR_VALUE, "gauge", "Sensor value as reported by ietf-hardware, in units given by value_type and value_scale.");
+    for (const auto& sensor : sensors) {
+        builder.sample(SENSOR_VALUE, {{"component", sensor.component}, {"value_type", sensor.valueType}, {"value_scale", sensor.valueScale}}, sensor.value);
+    }
+
+    // these are OpenMetrics statesets in disguise, the textfile collector does not know that type
+    builder.family(SENSOR_OPER_STATUS, "gauge", "Operational status of the sensor, 1 for the current one.");
+    for (const auto& sensor : sensors) {
+        for (const auto& status : OPER_STATUSES) {
+            builder.sample(SENSOR_OPER_STATUS, {{"component", sensor.component}, {SENSOR_OPER_STATUS, status}}, int64_t{sensor.operStatus == status});
+        }
+    }
+
+    builder.family(SENSOR_THRESHOLD, "gauge", "Threshold state of the sensor, 1 for the current one.");
+    for (const auto& sensor : sensors) {
+        auto it = thresholdStates.find(sensor.xpath);
+        if (it == thresholdStates.end()) {
+            continue;
+        }
+
+        for (const auto& [state, name] : THRESHOLD_STATES) {
+            builder.sample(SENSOR_THRESHOLD, {{"component", sensor.component}, {SENSOR_THRESHOLD, name}}, int64_t{it->second == state});
+        }
+    }
+
+    return builder.str();
+}
+
+OpenMetricsExporter::OpenMetricsExporter(std::filesystem::path filename)
+    : m_log(spdlog::get("hardware"))
+    , m_filename(std::move(filename))
+{
+}
+
+void OpenMetricsExporter::operator()(const HardwareInfo& info)
+{
+    for (const auto& [sensorXPath, update] : info.updatedTresholdCrossing) {
+        m_thresholdStates[sensorXPath] = update.newState;
+    }
+
+    try {
+        utils::replaceFile(m_filename, renderOpenMetrics(info.dataTree, m_thresholdStates));
+    } catch (const std::exception& e) {
+        m_log->warn("Cannot write OpenMetrics export to {}: {}", m_filename.string(), e.what());
+    }
+}
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include "ietf-hardware/IETFHardware.h"
+#include "ietf-hardware/thresholds_fwd.h"
+#include "utils/log-fwd.h"
+
+namespace velia::ietf_hardware {
+
+std::string renderOpenMetrics(const DataTree& dataTree, const std::map<std::string, State>& thresholdStates);
+
+/** @short Exports sensor values from the IETFHardware poll into a file in the Prometheus text format
+ *
+ * The file is meant to be picked up by the textfile collector of the Prometheus node_exporter.
+ * Threshold states are reported only as changes by IETFHardware::process(), so this class remembers the last known state of each sensor.
+ * The file is replaced atomically on every update, but it is not synced to the disk because it is rewritten on every poll.
+ */
+class OpenMetricsExporter {
+public:
+    explicit OpenMetricsExporter(std::filesystem::path filename);
+    void operator()(const HardwareInfo& info);
+
+private:
+    velia::Log m_log;
+    std::filesystem::path m_filename;
+    std::map<std::string, State> m_thresholdStates;
+};
+}
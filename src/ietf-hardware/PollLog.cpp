@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <charconv>
+#include <thread>
+#include "PollLog.h"
+#include "utils/log.h"
+
+using namespace std::literals;
+
+/* The log is a sequence of records, each one starting with a single-byte tag. Integers are stored in the host byte order.
+ * Strings are prefixed by their length (uint32_t).
+ *
+ *  - SensorDefinition: id (uint32_t), xpath (string), thresholds (4x: present (uint8_t), value (int64_t) and hysteresis (int64_t) if present)
+ *  - StaticData: number of leaves (uint32_t), followed by the (xpath, value) string pairs
+ *  - SideLoadedAlarms: number of alarms (uint32_t), followed by (alarmTypeId, resource, severity, text) string quadruplets
+ *  - Poll: timestamp in ns since epoch (int64_t), number of sensors (uint32_t), followed by (id (uint32_t), flags (uint8_t), value (int64_t) if present)
+ */
+
+namespace {
+
+const auto MAGIC = "VHWPOLL1"s;
+
+enum class Tag : uint8_t {
+    SensorDefinition = 'D',
+    StaticData = 'S',
+    SideLoadedAlarms = 'A',
+    Poll = 'P',
+};
+
+enum SensorFlags : uint8_t {
+    HasValue = 1 << 0,
+    HasThresholds = 1 << 1,
+};
+
+class TruncatedLog : public std::runtime_error {
+public:
+    TruncatedLog()
+        : std::runtime_error("Hardware poll log: truncated record")
+    {
+    }
+};
+
+template <typename T>
+void write(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void write(std::ostream& out, const std::string& str)
+{
+    write(out, static_cast<uint32_t>(str.size()));
+    out.write(str.data(), str.size());
+}
+
+void write(std::ostream& out, const std::optional<velia::ietf_hardware::OneThreshold<int64_t>>& threshold)
+{
+    write(out, static_cast<uint8_t>(threshold.has_value()));
+    if (threshold) {
+        write(out, threshold->value);
+        write(out, threshold->hysteresis);
+    }
+}
+
+void write(std::ostream& out, const velia::ietf_hardware::Thresholds<int64_t>& thresholds)
+{
+    write(out, thresholds.criticalLow);
+    write(out, thresholds.warningLow);
+    write(out, thresholds.warningHigh);
+    write(out, thresholds.criticalHigh);
+}
+
+template <typename T>
+T read(std::istream& in)
+{
+    T value;
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+        throw TruncatedLog();
+    }
+    return value;
+}
+
+std::string readString(std::istream& in)
+{
+    std::string str(read<uint32_t>(in), '\0');
+    if (!in.read(str.data(), str.size())) {
+        throw TruncatedLog();
+    }
+    return str;
+}
+
+std::optional<velia::ietf_hardware::OneThreshold<int64_t>> readThreshold(std::istream& in)
+{
+    if (!read<uint8_t>(in)) {
+        return std::nullopt;
+    }
+    auto value = read<int64_t>(in);
+    auto hysteresis = read<int64_t>(in);
+    return velia::ietf_hardware::OneThreshold<int64_t>{value, hysteresis};
+}
+
+velia::ietf_hardware::Thresholds<int64_t> readThresholds(std::istream& in)
+{
+    velia::ietf_hardware::Thresholds<int64_t> res;
+    res.criticalLow = readThreshold(in);
+    res.warningLow = readThreshold(in);
+    res.warningHigh = readThreshold(in);
+    res.criticalHigh = readThreshold(in);
+    return res;
+}
+
+std::optional<int64_t> sensorValue(const std::string& xpath, const std::string& value)
+{
+    if (!xpath.ends_with("/sensor-data/value")) {
+        return std::nullopt;
+    }
+
+    int64_t res;
+    if (auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), res); ec != std::errc{} || ptr != value.data() + value.size()) {
+        return std::nullopt;
+    }
+    return res;
+}
+}
+
+namespace velia::ietf_hardware {
+
+PollLogWriter::PollLogWriter(const std::filesystem::path& path)
+    : m_out(path, std::ios::binary | std::ios::trunc)
+{
+    if (!m_out.is_open()) {
+        throw std::runtime_error("Hardware poll log: cannot open " + path.string() + " for writing");
+    }
+    m_out.write(MAGIC.data(), MAGIC.size());
+}
+
+void PollLogWriter::record(const SensorPollData& pollData, std::chrono::system_clock::time_point timestamp)
+{
+    struct Sample {
+        uint32_t id;
+        uint8_t flags;
+        int64_t value;
+    };
+    std::map<std::string, Sample> samples;
+    DataTree staticData;
+
+    auto sensorId = [this](const std::string& xpath, const Thresholds<int64_t>& thresholds) {
+        auto it = m_sensors.find(xpath);
+        if (it == m_sensors.end()) {
+            it = m_sensors.emplace(xpath, SensorEntry{static_cast<uint32_t>(m_sensors.size()), thresholds}).first;
+        } else if (it->second.thresholds == thresholds) {
+            return it->second.id;
+        }
+
+        it->second.thresholds = thresholds;
+        write(m_out, Tag::SensorDefinition);
+        write(m_out, it->second.id);
+        write(m_out, xpath);
+        write(m_out, thresholds);
+        return it->second.id;
+    };
+
+    for (const auto& [xpath, thresholds] : pollData.thresholds) {
+        samples[xpath] = {sensorId(xpath, thresholds), HasThresholds, 0};
+    }
+
+    for (const auto& [xpath, value] : pollData.data) {
+        if (auto numericValue = sensorValue(xpath, value)) {
+            auto& sample = samples[xpath];
+            if (!(sample.flags & HasThresholds)) {
+                sample.id = sensorId(xpath, m_sensors.contains(xpath) ? m_sensors.at(xpath).thresholds : Thresholds<int64_t>{});
+            }
+            sample.flags |= HasValue;
+            sample.value = *numericValue;
+        } else {
+            staticData.emplace(xpath, value);
+        }
+    }
+
+    if (staticData != m_staticData) {
+        write(m_out, Tag::StaticData);
+        write(m_out, static_cast<uint32_t>(staticData.size()));
+        for (const auto& [xpath, value] : staticData) {
+            write(m_out, xpath);
+            write(m_out, value);
+        }
+        m_staticData = std::move(staticData);
+    }
+
+    if (pollData.sideLoadedAlarms != m_sideLoadedAlarms) {
+        write(m_out, Tag::SideLoadedAlarms);
+        write(m_out, static_cast<uint32_t>(pollData.sideLoadedAlarms.size()));
+        for (const auto& alarm : pollData.sideLoadedAlarms) {
+            write(m_out, alarm.alarmTypeId);
+            write(m_out, alarm.resource);
+            write(m_out, alarm.severity);
+            write(m_out, alarm.text);
+        }
+        m_sideLoadedAlarms = pollData.sideLoadedAlarms;
+    }
+
+    write(m_out, Tag::Poll);
+    write(m_out, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count()));
+    write(m_out, static_cast<uint32_t>(samples.size()));
+    for (const auto& [xpath, sample] : samples) {
+        write(m_out, sample.id);
+        write(m_out, sample.flags);
+        if (sample.flags & HasValue) {
+            write(m_out, sample.value);
+        }
+    }
+
+    // hand the record over to the kernel, so that it survives a crash of the daemon; no fsync, that would wear out the eMMC
+    m_out.flush();
+}
+
+PollLogReader::PollLogReader(const std::filesystem::path& path)
+    : m_log(spdlog::get("hardware"))
+    , m_in(path, std::ios::binary)
+{
+    if (!m_in.is_open()) {
+        throw std::runtime_error("Hardware poll log: cannot open " + path.string());
+    }
+
+    std::string magic(MAGIC.size(), '\0');
+    if (!m_in.read(magic.data(), magic.size()) || magic != MAGIC) {
+        throw std::runtime_error("Hardware poll log: " + path.string() + " is not a hardware poll log");
+    }
+}
+
+/** @short Returns the next recorded poll, or std::nullopt at the end of the log */
+std::optional<PollLogReader::Entry> PollLogReader::next()
+{
+    try {
+        while (true) {
+            Tag tag;
+            if (!m_in.read(reinterpret_cast<char*>(&tag), sizeof(tag))) {
+                return std::nullopt;
+            }
+
+            switch (tag) {
+            case Tag::SensorDefinition: {
+                auto id = read<uint32_t>(m_in);
+                auto xpath = readString(m_in);
+                m_sensors[id] = {std::move(xpath), readThresholds(m_in)};
+                break;
+            }
+            case Tag::StaticData: {
+                m_staticData.clear();
+                for (auto count = read<uint32_t>(m_in); count > 0; --count) {
+                    auto xpath = readString(m_in);
+                    m_staticData.emplace(std::move(xpath), readString(m_in));
+                }
+                break;
+            }
+            case Tag::SideLoadedAlarms: {
+                m_sideLoadedAlarms.clear();
+                for (auto count = read<uint32_t>(m_in); count > 0; --count) {
+                    SideLoadedAlarm alarm;
+                    alarm.alarmTypeId = readString(m_in);
+                    alarm.resource = readString(m_in);
+                    alarm.severity = readString(m_in);
+                    alarm.text = readString(m_in);
+                    m_sideLoadedAlarms.insert(std::move(alarm));
+                }
+                break;
+            }
+            case Tag::Poll: {
+                Entry entry;
+                entry.timestamp = std::chrono::system_clock::time_point{std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{read<int64_t>(m_in)})};
+                entry.pollData.data = m_staticData;
+                entry.pollData.sideLoadedAlarms = m_sideLoadedAlarms;
+
+                for (auto count = read<uint32_t>(m_in); count > 0; --count) {
+                    auto id = read<uint32_t>(m_in);
+                    auto flags = read<uint8_t>(m_in);
+                    const auto& sensor = m_sensors.at(id);
+
+                    if (flags & HasValue) {
+                        entry.pollData.data[sensor.xpath] = std::to_string(read<int64_t>(m_in));
+                    }
+                    if (flags & HasThresholds) {
+                        entry.pollData.thresholds.emplace(sensor.xpath, sensor.thresholds);
+                    }
+                }
+                return entry;
+            }
+            default:
+                throw std::runtime_error("Hardware poll log: unknown record type " + std::to_string(static_cast<int>(tag)));
+            }
+        }
+    } catch (const TruncatedLog& e) {
+        // the recording process was probably killed in the middle of writing a record
+        m_log->warn("{}, ignoring the rest of the log", e.what());
+        return std::nullopt;
+    }
+}
+
+namespace data_reader {
+
+struct Replay::State {
+    State(const std::filesystem::path& path, ReplaySpeed speed)
+        : reader(path)
+        , speed(speed)
+        , log(spdlog::get("hardware"))
+    {
+    }
+
+    PollLogReader reader;
+    ReplaySpeed speed;
+    velia::Log log;
+    std::optional<std::chrono::system_clock::time_point> lastRecorded;
+    std::chrono::steady_clock::time_point lastReplayed;
+    SensorPollData last;
+    bool finished = false;
+};
+
+Replay::Replay(const std::filesystem::path& path, ReplaySpeed speed)
+    : m_state(std::make_shared<State>(path, speed))
+{
+}
+
+SensorPollData Replay::operator()() const
+{
+    auto& state = *m_state;
+
+    if (!state.finished) {
+        if (auto entry = state.reader.next()) {
+            if (state.speed == ReplaySpeed::Realtime && state.lastRecorded) {
+                std::this_thread::sleep_until(state.lastReplayed + std::chrono::duration_cast<std::chrono::steady_clock::duration>(entry->timestamp - *state.lastRecorded));
+            }
+
+            state.lastRecorded = entry->timestamp;
+            state.lastReplayed = std::chrono::steady_clock::now();
+            state.last = std::move(entry->pollData);
+            return state.last;
+        }
+
+        state.finished = true;
+        state.log->info("Replay of the hardware poll log has finished, repeating the last recorded data");
+    }
+
+    // there is no more pacing from the log, so don't make the caller spin
+    std::this_thread::sleep_for(1s);
+    return state.last;
+}
+}
+}
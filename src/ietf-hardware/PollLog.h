@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include "ietf-hardware/IETFHardware.h"
+#include "utils/log-fwd.h"
+
+namespace velia::ietf_hardware {
+
+/** @short Records SensorPollData from each IETFHardware poll into a compact binary log
+ *
+ * Every sensor is assigned a numeric ID. Its XPath and thresholds are written only once, on first occurrence (or when the thresholds change).
+ * Each poll is then stored as a timestamp and a list of (sensor ID, value) pairs.
+ * The remaining, mostly static, parts of the data tree and the side-loaded alarms are written only when they change.
+ *
+ * @see PollLogReader
+ */
+class PollLogWriter {
+public:
+    explicit PollLogWriter(const std::filesystem::path& path);
+    void record(const SensorPollData& pollData, std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now());
+
+private:
+    struct SensorEntry {
+        uint32_t id;
+        Thresholds<int64_t> thresholds;
+    };
+
+    std::ofstream m_out;
+    std::map<std::string, SensorEntry> m_sensors;
+    DataTree m_staticData;
+    std::set<SideLoadedAlarm> m_sideLoadedAlarms;
+};
+
+/** @short Reads back logs produced by PollLogWriter */
+class PollLogReader {
+public:
+    struct Entry {
+        std::chrono::system_clock::time_point timestamp;
+        SensorPollData pollData;
+    };
+
+    explicit PollLogReader(const std::filesystem::path& path);
+    std::optional<Entry> next();
+
+private:
+    struct SensorEntry {
+        std::string xpath;
+        Thresholds<int64_t> thresholds;
+    };
+
+    velia::Log m_log;
+    std::ifstream m_in;
+    std::map<uint32_t, SensorEntry> m_sensors;
+    DataTree m_staticData;
+    std::set<SideLoadedAlarm> m_sideLoadedAlarms;
+};
+
+namespace data_reader {
+
+enum class ReplaySpeed {
+    Realtime, /**< @short Wait between polls as long as was recorded in the log */
+    AsFastAsPossible,
+};
+
+/** @short Replays poll data recorded by PollLogWriter instead of reading them from the hardware
+ *
+ * When the log is exhausted, the last recorded poll is returned over and over again.
+ * The pacing is done by the data reader itself, so the poll interval of the caller should be zero.
+ */
+struct Replay {
+    Replay(const std::filesystem::path& path, ReplaySpeed speed);
+    SensorPollData operator()() const;
+
+private:
+    struct State;
+    std::shared_ptr<State> m_state;
+};
+}
+}
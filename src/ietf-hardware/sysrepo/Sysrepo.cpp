@@ -81,11 +81,12 @@ std::string toYangAlarmSeverity(velia::ietf_hardware::State state)
 namespace velia::ietf_hardware::sysrepo {
 
 /** @brief The constructor expects the HardwareState instance which will provide the actual hardware state data and the poll interval */
-Sysrepo::Sysrepo(::sysrepo::Session session, std::shared_ptr<IETFHardware> hwState, std::chrono::microseconds pollInterval)
+Sysrepo::Sysrepo(::sysrepo::Session session, std::shared_ptr<IETFHardware> hwState, std::chrono::microseconds pollInterval, PollObserver pollObserver)
     : m_log(spdlog::get("hardware"))
     , m_pollInterval(std::move(pollInterval))
     , m_session(std::move(session))
     , m_hwState(std::move(hwState))
+    , m_pollObserver(std::move(pollObserver))
     , m_quit(false)
 {
     // we're only interested in propagating the asset-id to the operational DS, which means a subscriber for running
@@ -119,7 +120,12 @@ Sysrepo::Sysrepo(::sysrepo::Session session, std::shared_ptr<IETFHardware> hwSta
             auto benchmark = std::make_optional<velia::utils::MeasureTime>("ietf-hardware/poll");
             m_log->trace("IetfHardware poll");
 
-            auto [hwStateValues, thresholds, activeSensors, sideLoadedAlarms] = m_hwState->process();
+            auto hwInfo = m_hwState->process();
+            if (m_pollObserver) {
+                m_pollObserver(hwInfo);
+            }
+
+            auto& [hwStateValues, thresholds, activeSensors, sideLoadedAlarms] = hwInfo;
             std::set<std::string> deletedComponents;
             std::vector<std::string> newSensors;
 
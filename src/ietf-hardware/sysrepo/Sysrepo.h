@@ -7,6 +7,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <sysrepo-cpp/Subscription.hpp>
 #include <thread>
@@ -18,12 +19,15 @@ namespace velia::ietf_hardware::sysrepo {
 /** @class Sysrepo
  *  A callback class for operational data in Sysrepo. This class expects a shared_pointer<HardwareState> instance.
  *  It asks HardwareState instance for the hardware state data every @p pollInterval interval and it pushes them into Sysrepo.
+ *  Each poll result is also passed to the optional @p pollObserver, e.g., for exporting the data elsewhere.
  *
  *  @see velia::ietf_hardware::IETFHardware
  */
 class Sysrepo {
 public:
-    Sysrepo(::sysrepo::Session session, std::shared_ptr<IETFHardware> driver, std::chrono::microseconds pollInterval);
+    using PollObserver = std::function<void(const HardwareInfo&)>;
+
+    Sysrepo(::sysrepo::Session session, std::shared_ptr<IETFHardware> driver, std::chrono::microseconds pollInterval, PollObserver pollObserver = {});
     ~Sysrepo();
 
 private:
@@ -32,6 +36,7 @@ private:
     ::sysrepo::Session m_session;
     std::optional<::sysrepo::Subscription> m_assetSub;
     std::shared_ptr<IETFHardware> m_hwState;
+    PollObserver m_pollObserver;
     std::atomic<bool> m_quit;
     std::thread m_pollThread;
 };
@@ -18,11 +18,15 @@ template <typename Value>
 struct OneThreshold {
     Value value;
     Value hysteresis;
+
+    bool operator==(const OneThreshold<Value>& other) const = default;
 };
 
 template <typename Value>
 struct Thresholds {
     std::optional<OneThreshold<Value>> criticalLow, warningLow, warningHigh, criticalHigh;
+
+    bool operator==(const Thresholds<Value>& other) const = default;
 };
 
 template <typename Value>
@@ -5,9 +5,7 @@
 #include <unistd.h>
 #include "VELIA_VERSION.h"
 #include "firewall/Firewall.h"
-#include "system_vars.h"
 #include "utils/exceptions.h"
-#include "utils/exec.h"
 #include "utils/journal.h"
 #include "utils/log-init.h"
 #include "utils/log.h"
@@ -63,11 +61,13 @@ int main(int argc, char* argv[])
 
     auto srConn = sysrepo::Connection{};
     auto srSess = srConn.sessionStart();
-    velia::firewall::SysrepoFirewall firewall(srSess, [] (const auto& config) {
+    velia::firewall::Nftables nft;
+    velia::firewall::SysrepoFirewall firewall(srSess, [&nft] (const auto& config) {
         spdlog::get("firewall")->debug("running nft...");
-        velia::utils::execAndWait(spdlog::get("firewall"), NFT_EXECUTABLE, {"-f", "-"}, config);
+        auto echo = nft.run(config);
 
         spdlog::get("firewall")->debug("nft config applied.");
+        return echo;
     }, nftIncludeFiles);
 
     waitUntilSignaled();
@@ -6,6 +6,8 @@
 #include "VELIA_VERSION.h"
 #include "ietf-hardware/Factory.h"
 #include "ietf-hardware/IETFHardware.h"
+#include "ietf-hardware/OpenMetrics.h"
+#include "ietf-hardware/PollLog.h"
 #include "ietf-hardware/sysrepo/Sysrepo.h"
 #include "utils/exceptions.h"
 #include "utils/journal.h"
@@ -19,7 +21,9 @@ static const char usage[] =
 
 Usage:
   veliad-hardware
-    [--appliance=<Model>]
+    [--appliance=<Model> | --replay=<Path> [--replay-fast]]
+    [--record=<Path>]
+    [--metrics-file=<Path>]
     [--hardware-log-level=<Level>]
     [--main-log-level=<Level>]
     [--sysrepo-log-level=<Level>]
@@ -30,6 +34,11 @@ Options:
   -h --help                         Show this screen.
   --version                         Show version.
   --appliance=<Model>               Initialize IETF Hardware and outputs for specific appliance.
+  --record=<Path>                   Record data from each hardware poll into a binary log.
+  --replay=<Path>                   Instead of reading the hardware, replay data from a log created via --record.
+  --replay-fast                     Replay the log as fast as possible instead of in real time.
+  --metrics-file=<Path>             Export sensor data into this file in the Prometheus text format
+                                    (e.g., for the textfile collector of Prometheus node_exporter).
   --hardware-log-level=<N>          Log level for the hardware drivers [default: 3]
                                     (0 -> critical, 1 -> error, 2 -> warning, 3 -> info,
                                     4 -> debug, 5 -> trace)
@@ -61,13 +70,31 @@ int main(int argc, char* argv[])
 
     // initialize ietf-hardware
     std::shared_ptr<velia::ietf_hardware::IETFHardware> ietfHardware;
+    std::chrono::microseconds pollInterval = std::chrono::milliseconds{1500};
     if (const auto& appliance = args["--appliance"]) {
         ietfHardware = velia::ietf_hardware::create(appliance.asString());
+    } else if (const auto& replay = args["--replay"]) {
+        ietfHardware = std::make_shared<velia::ietf_hardware::IETFHardware>();
+        ietfHardware->registerDataReader(velia::ietf_hardware::data_reader::Replay(
+            replay.asString(),
+            args["--replay-fast"].asBool() ? velia::ietf_hardware::data_reader::ReplaySpeed::AsFastAsPossible : velia::ietf_hardware::data_reader::ReplaySpeed::Realtime));
+        pollInterval = std::chrono::microseconds::zero(); // the replay is paced by the recorded timestamps
     } else {
         ietfHardware = std::make_shared<velia::ietf_hardware::IETFHardware>();
     }
 
-    auto sysrepoIETFHardware = velia::ietf_hardware::sysrepo::Sysrepo(srSess, ietfHardware, std::chrono::milliseconds{1500});
+    if (const auto& record = args["--record"]) {
+        ietfHardware->registerPollDataObserver([writer = std::make_shared<velia::ietf_hardware::PollLogWriter>(record.asString())](const auto& pollData) {
+            writer->record(pollData);
+        });
+    }
+
+    velia::ietf_hardware::sysrepo::Sysrepo::PollObserver pollObserver;
+    if (const auto& metricsFile = args["--metrics-file"]) {
+        pollObserver = velia::ietf_hardware::OpenMetricsExporter(metricsFile.asString());
+    }
+
+    auto sysrepoIETFHardware = velia::ietf_hardware::sysrepo::Sysrepo(srSess, ietfHardware, pollInterval, pollObserver);
 
     waitUntilSignaled();
 
@@ -1,11 +1,19 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <docopt.h>
+#include <sdbus-c++/sdbus-c++.h>
 #include <spdlog/sinks/ansicolor_sink.h>
 #include <spdlog/spdlog.h>
 #include <sysrepo-cpp/Session.hpp>
 #include "VELIA_VERSION.h"
 #include "main.h"
 #include "network/Factory.h"
+#include "network/LLDPListener.h"
+#include "network/ManagedLinks.h"
+#include "network/NetworkdReload.h"
 #include "network/NetworkctlUtils.h"
+#include "network/OpenMetrics.h"
 #include "system_vars.h"
 #include "utils/exceptions.h"
 #include "utils/exec.h"
@@ -25,6 +33,10 @@ Usage:
     [--main-log-level=<Level>]
     [--sysrepo-log-level=<Level>]
     [--network-log-level=<Level>]
+    [--metrics-file=<Path>]
+    [--metrics-interval=<Seconds>]
+    [--statistics-interval=<Seconds>]
+    [--rib=<Name=Table>]...
   veliad-network (-h | --help)
   veliad-network --version
 
@@ -36,6 +48,13 @@ Options:
                                     4 -> debug, 5 -> trace)
   --sysrepo-log-level=<N>           Log level for the sysrepo library [default: 3]
   --network-log-level=<N>           Log level for the network stuff [default: 3]
+  --metrics-file=<Path>             Periodically export interface statistics into this file in the Prometheus
+                                    text format (e.g., for the textfile collector of Prometheus node_exporter).
+  --metrics-interval=<Seconds>      How often to export the interface statistics into the --metrics-file [default: 15]
+  --statistics-interval=<Seconds>   How often to sample the interface statistics and traffic rates [default: 5]
+  --rib=<Name=Table>                Also publish a kernel routing table as the ipv4-<Name> and ipv6-<Name> RIBs. The Table is
+                                    either a numeric table ID, or a name of a VRF device. The main table is always published
+                                    as ipv4-master and ipv6-master.
 )";
 
 DBUS_EVENTLOOP_INIT
@@ -59,20 +78,52 @@ int main(int argc, char* argv[])
     spdlog::get("sysrepo")->set_level(parseLogLevel("Sysrepo library", args["--sysrepo-log-level"]));
     spdlog::get("network")->set_level(parseLogLevel("Network logging", args["--network-log-level"]));
 
+    std::vector<velia::network::RibSource> ribs{velia::network::MAIN_RIB};
+    for (const auto& rib : args["--rib"].asStringList()) {
+        auto pos = rib.find('=');
+        if (pos == std::string::npos || pos == 0 || pos == rib.size() - 1) {
+            throw std::runtime_error("RIB: expecting <Name>=<Table>, got '" + rib + "'");
+        }
+
+        auto name = rib.substr(0, pos);
+        auto table = rib.substr(pos + 1);
+        if (std::any_of(ribs.begin(), ribs.end(), [&name](const auto& other) { return other.name == name; })) {
+            throw std::runtime_error("RIB: name '" + name + "' is already used, got '" + rib + "'");
+        }
+        if (std::all_of(table.begin(), table.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            uint32_t id;
+            if (auto [ptr, ec] = std::from_chars(table.data(), table.data() + table.size(), id); ec != std::errc{}) {
+                throw std::runtime_error("RIB: table '" + table + "' is not a valid routing table ID");
+            }
+            ribs.push_back({.name = name, .table = id});
+        } else {
+            ribs.push_back({.name = name, .table = table});
+        }
+    }
+
     const std::filesystem::path runtimeConfigDirectory = "/run/systemd/network";
     const std::filesystem::path systemdConfigDirectory = "/usr/lib/systemd/network";
 
     const auto networkctlListOutput = velia::utils::execAndWait(spdlog::get("network"), NETWORKCTL_EXECUTABLE, {"list", "--json=short"}, "");
     const auto managedLinks = velia::network::systemdNetworkdManagedLinks(networkctlListOutput);
 
+    auto dbusConnection = sdbus::createSystemBusConnection();
+    auto networkdReload = std::make_shared<velia::network::NetworkdReload>(
+        *dbusConnection,
+        "org.freedesktop.network1",
+        std::set<std::string>{managedLinks.begin(), managedLinks.end()},
+        std::vector<std::filesystem::path>{runtimeConfigDirectory, systemdConfigDirectory});
+    auto managedLinksMonitor = std::make_shared<velia::network::ManagedLinksMonitor>(*dbusConnection, "org.freedesktop.network1", managedLinks);
+    auto lldpListener = std::make_shared<velia::network::LLDPListener>(managedLinks);
+
     auto daemons = velia::network::create(
         sysrepo::Connection{},
         "/cfg/network/",
         runtimeConfigDirectory,
-        // IMPORTANT: veliad-network will only configure those interfaces which are "managed by systemd-networkd"
-        // at the time this code starts up. In practice, this means that this code does not support dynamic hotplug
-        // of interfaces, and that there MUST be exactly one `foo.network` for each of the managed interfaces, and
-        // that it's base name matches the name of the interface exactly.
+        // IMPORTANT: veliad-network will only configure those interfaces which are "managed by systemd-networkd".
+        // The list is updated at runtime as links come and go, see the ManagedLinksMonitor below. There MUST be
+        // exactly one `foo.network` for each of the managed interfaces, and its base name must match the name of
+        // the interface exactly.
         //
         // On CzechLight devices, this is taken care of by CzechLight/br2-external's "factory defaults" in
         // board/czechlight/clearfog/overlay/usr/lib/systemd/network/*.network, and by CzechLight/br2-external's
@@ -80,35 +131,35 @@ int main(int argc, char* argv[])
         // factory-defaults), and later from /cfg (where we pre-generate them from the startup DS) into /run
         // (where we store stuff from the running DS).
         managedLinks,
-        [runtimeConfigDirectory, systemdConfigDirectory, managedLinks = std::set<std::string>{managedLinks.begin(), managedLinks.end()}](const auto&) {
-            auto log = spdlog::get("network");
-
-            /* In 2021, executing 'networkctl reload' was not enough. For bridge interfaces, we had to also bring the interface down and up.
-             * As of 5/2025, it seems that bare 'networkctl reload' is sufficient.
-             * Manpage of networkctl says that reload should be enough except for few cases (like changing VLANs etc.), but they said that in 2021 too.
-             * */
-            velia::utils::execAndWait(log, NETWORKCTL_EXECUTABLE, {"reload"}, "");
-
-            const auto statusJson = velia::utils::execAndWait(log, NETWORKCTL_EXECUTABLE, {"status", "--json=short"}, "Reloading systemd-networkd configuration");
-            for (const auto& [linkName, confFiles] : velia::network::linkConfigurationFiles(statusJson, managedLinks)) {
-                const std::string confFilename = "10-"s + linkName + ".network";
-
-                if (!confFiles.networkFile) {
-                    log->error("Did not find a configuration file for systemd-networkd managed link {}", linkName);
-                } else if (confFiles.networkFile != runtimeConfigDirectory / confFilename && confFiles.networkFile != systemdConfigDirectory / confFilename) {
-                    log->error("Unexpected configuration file for link {}: {}", linkName, confFiles.networkFile->string());
-                }
-
-                if (!confFiles.dropinFiles.empty()) {
-                    log->error("Unexpected drop-in configuration files for link {}", linkName);
-                }
+        [networkdReload](const velia::network::IETFInterfacesConfig::ChangedUnits& changes) {
+            if (!changes.changedOrNew.empty() || !changes.deleted.empty()) {
+                networkdReload->request();
             }
         },
-        []() { return velia::utils::execAndWait(spdlog::get("network"), NETWORKCTL_EXECUTABLE, {"lldp", "--json=short"}, ""); },
-        velia::network::LLDPDataProvider::LocalData{
-            .chassisId = velia::network::getLocalChassisId(networkctlListOutput),
-            .chassisSubtype = "local"}
-    );
+        std::make_shared<velia::network::LLDPDataProvider>(
+            lldpListener,
+            velia::network::LLDPDataProvider::LocalData{
+                .chassisId = velia::network::getLocalChassisId(networkctlListOutput),
+                .chassisSubtype = "local"}),
+        std::chrono::seconds{args["--statistics-interval"].asLong()},
+        [managedLinksMonitor]() { managedLinksMonitor->linksChanged(); },
+        ribs);
+
+    managedLinksMonitor->onChange([&daemons, networkdReload, lldpListener](const std::vector<std::string>& links) {
+        daemons.startupConfig.setManagedLinks(links);
+        daemons.runtimeConfig.setManagedLinks(links);
+        networkdReload->setManagedLinks({links.begin(), links.end()});
+        lldpListener->setLinks(links);
+    });
+    // the links might have changed since we asked networkctl, and the notifications were ignored until now
+    managedLinksMonitor->linksChanged();
+
+    std::optional<velia::network::OpenMetricsExporter> metricsExporter;
+    if (const auto& metricsFile = args["--metrics-file"]) {
+        metricsExporter.emplace(daemons.opsData.rtnetlink(), metricsFile.asString(), std::chrono::seconds{args["--metrics-interval"].asLong()});
+    }
+
     waitUntilSignaled();
+    managedLinksMonitor->onChange(nullptr);
     return 0;
 }
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "BridgeFdb.h"
+
+namespace velia::network {
+
+void BridgeFdb::set(int bridge, int port, const std::string& macAddress, int vlan, Type type)
+{
+    Key key{bridge, macAddress, vlan};
+
+    if (auto [it, inserted] = m_ports.try_emplace(key, port); !inserted && it->second != port) {
+        m_entries.erase(PortKey{it->second, key});
+        it->second = port;
+    }
+
+    m_entries.insert_or_assign(PortKey{port, std::move(key)}, type);
+}
+
+void BridgeFdb::remove(int bridge, const std::string& macAddress, int vlan)
+{
+    Key key{bridge, macAddress, vlan};
+
+    if (auto it = m_ports.find(key); it != m_ports.end()) {
+        m_entries.erase(PortKey{it->second, key});
+        m_ports.erase(it);
+    }
+}
+
+/** @brief Forgets all entries which point to the given link, as well as the whole FDB of the link if it is a bridge */
+void BridgeFdb::removeLink(int ifindex)
+{
+    for (auto it = m_entries.lower_bound(PortKey{ifindex, {}}); it != m_entries.end() && it->first.port == ifindex;) {
+        m_ports.erase(it->first.key);
+        it = m_entries.erase(it);
+    }
+
+    for (auto it = m_ports.lower_bound(Key{ifindex, {}, 0}); it != m_ports.end() && it->first.bridge == ifindex;) {
+        m_entries.erase(PortKey{it->second, it->first});
+        it = m_ports.erase(it);
+    }
+}
+
+/** @brief FDB entries which point to the given port */
+std::vector<BridgeFdb::Entry> BridgeFdb::entries(int port) const
+{
+    std::vector<Entry> res;
+    for (auto it = m_entries.lower_bound(PortKey{port, {}}); it != m_entries.end() && it->first.port == port; ++it) {
+        res.push_back({it->first.key.macAddress, it->first.key.vlan, it->second});
+    }
+    return res;
+}
+
+size_t BridgeFdb::size() const
+{
+    return m_ports.size();
+}
+}
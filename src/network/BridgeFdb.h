@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace velia::network {
+
+/** @brief In-memory copy of the forwarding databases of all bridges
+ *
+ * The table is maintained from the individual AF_BRIDGE netlink neighbour events, so that reading it does not require any netlink dumps.
+ * Just like in the kernel (and in libnl), an entry is identified by its bridge, MAC address and VLAN. The port which the entry points to
+ * can change over time as the MAC address moves around the network.
+ */
+class BridgeFdb {
+public:
+    enum class Type {
+        Dynamic, ///< learned from the traffic
+        Static, ///< added by the admin, never ages out
+        Permanent, ///< an address of the bridge itself or of one of its ports
+    };
+
+    struct Entry {
+        std::string macAddress;
+        int vlan; ///< 0 when the entry is not specific to a VLAN
+        Type type;
+
+        bool operator==(const Entry&) const = default;
+    };
+
+    void set(int bridge, int port, const std::string& macAddress, int vlan, Type type);
+    void remove(int bridge, const std::string& macAddress, int vlan);
+    void removeLink(int ifindex);
+    std::vector<Entry> entries(int port) const;
+    size_t size() const;
+
+private:
+    struct Key {
+        int bridge;
+        std::string macAddress;
+        int vlan;
+
+        auto operator<=>(const Key&) const = default;
+    };
+
+    struct PortKey {
+        int port;
+        Key key;
+
+        auto operator<=>(const PortKey&) const = default;
+    };
+
+    std::map<Key, int> m_ports; ///< which port an entry points to
+    std::map<PortKey, Type> m_entries; ///< ordered by the port so that the lookups of a single port do not have to go through everything
+};
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "EthtoolSampler.h"
+#include "utils/log.h"
+
+namespace velia::network {
+
+/** @brief Takes the first sample right away and then keeps sampling every @p interval in a background thread */
+EthtoolSampler::EthtoolSampler(Source source, std::chrono::milliseconds interval)
+    : m_log(spdlog::get("network"))
+    , m_source(std::move(source))
+    , m_task([this]() { sample(); }, interval)
+{
+}
+
+void EthtoolSampler::sample()
+{
+    std::map<std::string, Rtnetlink::EthtoolLinkInfo> current;
+    try {
+        current = m_source();
+    } catch (const std::exception& e) {
+        m_log->warn("Cannot query ethtool link information: {}", e.what());
+        return;
+    }
+
+    std::lock_guard lock(m_dataMtx);
+    m_snapshot = std::move(current);
+}
+
+std::map<std::string, Rtnetlink::EthtoolLinkInfo> EthtoolSampler::snapshot() const
+{
+    std::lock_guard lock(m_dataMtx);
+    return m_snapshot;
+}
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include "network/Rtnetlink.h"
+#include "utils/log-fwd.h"
+#include "utils/periodic.h"
+
+namespace velia::network {
+
+/** @brief Periodically asks the drivers about link speed, duplex and the Ethernet error counters, so that the readers are served from a snapshot
+ *
+ * Some drivers read these from the hardware over a slow bus, which is why this runs on its own (and slower) cadence than StatisticsSampler.
+ */
+class EthtoolSampler {
+public:
+    using Source = std::function<std::map<std::string, Rtnetlink::EthtoolLinkInfo>()>;
+
+    EthtoolSampler(Source source, std::chrono::milliseconds interval);
+    void sample();
+    std::map<std::string, Rtnetlink::EthtoolLinkInfo> snapshot() const;
+
+private:
+    velia::Log m_log;
+    Source m_source;
+
+    mutable std::mutex m_dataMtx; ///< protects m_snapshot
+    std::map<std::string, Rtnetlink::EthtoolLinkInfo> m_snapshot;
+
+    utils::PeriodicTask m_task; // last, so that the background sampling stops before the rest is destroyed
+};
+}
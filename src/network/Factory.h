@@ -19,19 +19,20 @@ Services create(
     const std::filesystem::path& runtimeNetworkDirectory,
     const std::vector<std::string>& managedLinks,
     IETFInterfacesConfig::reload_cb_t runningNetworkReloadCB,
-    LLDPDataProvider::data_callback_t lldpCallback,
-    LLDPDataProvider::LocalData lldpLocalData)
+    std::shared_ptr<LLDPDataProvider> lldp,
+    std::chrono::milliseconds statisticsInterval = std::chrono::seconds{5},
+    std::function<void()> linkSetChanged = {},
+    const std::vector<RibSource>& ribs = {MAIN_RIB})
 {
     std::filesystem::create_directories(runtimeNetworkDirectory);
     std::filesystem::create_directories(persistentNetworkDirectory);
     auto running = conn.sessionStart(sysrepo::Datastore::Running);
     return {
         // IETFInterfaces has a background thread which acceses the session at random times
-        .opsData = velia::network::IETFInterfaces{conn.sessionStart(sysrepo::Datastore::Operational)},
+        .opsData = velia::network::IETFInterfaces{conn.sessionStart(sysrepo::Datastore::Operational), statisticsInterval, std::move(linkSetChanged), ribs},
         .startupConfig = IETFInterfacesConfig{conn.sessionStart(sysrepo::Datastore::Startup), persistentNetworkDirectory, managedLinks, [](const auto&) {}},
         .runtimeConfig = IETFInterfacesConfig{running, runtimeNetworkDirectory, managedLinks, std::move(runningNetworkReloadCB)},
-        .lldp = LLDPSysrepo{running,
-                            std::make_shared<velia::network::LLDPDataProvider>(std::move(lldpCallback), std::move(lldpLocalData))},
+        .lldp = LLDPSysrepo{running, std::move(lldp)},
     };
 }
 }
@@ -5,11 +5,14 @@
  *
  */
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <filesystem>
+#include <iterator>
 #include <linux/if_arp.h>
 #include <linux/netdevice.h>
-#include <map>
+#include <netlink/route/link/vrf.h>
+#include <regex>
 #include "IETFInterfaces.h"
 #include "Rtnetlink.h"
 #include "utils/log.h"
@@ -19,26 +22,52 @@ using namespace std::string_literals;
 
 namespace {
 
-/** @brief Computes the length of the const C-string (array of const char) *including* the terminating zero
- *
- * Credits: https://dbj.org/cpp-zero-time-strlen-and-strnlen/
- */
-template <size_t N>
-inline constexpr size_t arrlen(const char (&)[N]) noexcept
-{
-    return N;
-}
-
 const auto CZECHLIGHT_NETWORK_MODULE_NAME = "czechlight-network"s;
 const auto IETF_IP_MODULE_NAME = "ietf-ip"s;
 const auto IETF_INTERFACES_MODULE_NAME = "ietf-interfaces"s;
 const auto IETF_ROUTING_MODULE_NAME = "ietf-routing"s;
 const auto IETF_IPV4_UNICAST_ROUTING_MODULE_NAME = "ietf-ipv4-unicast-routing";
 const auto IETF_IPV6_UNICAST_ROUTING_MODULE_NAME = "ietf-ipv6-unicast-routing";
+const auto VELIA_INTERFACES_MODULE_NAME = "velia-interfaces"s;
 const auto IETF_INTERFACES = "/"s + IETF_INTERFACES_MODULE_NAME + ":interfaces"s;
 
 const auto PHYS_ADDR_BUF_SIZE = 6 * 2 /* 2 chars per 6 bytes in the address */ + 5 /* delimiters (':') between bytes */ + 1 /* \0 */;
-const auto IPV6ADDRSTRLEN_WITH_PREFIX = INET6_ADDRSTRLEN + 1 + 3 /* plus slash and max three-digits prefix */;
+
+/* Link and address changes come in bursts, e.g., when a bridge with several ports goes up */
+const auto INTERFACES_QUIET_PERIOD = std::chrono::milliseconds{50};
+const auto INTERFACES_MAX_DELAY = std::chrono::milliseconds{500};
+const auto INTERFACES_MAX_BATCH = 512;
+
+/* Routing table changes come in bursts, e.g., when an interface goes down or when DHCP renews a lease. */
+const auto ROUTES_QUIET_PERIOD = std::chrono::milliseconds{100};
+const auto ROUTES_MAX_DELAY = std::chrono::milliseconds{1000};
+
+/* Traffic rates are averaged over (at least) this long period */
+const auto STATISTICS_RATES_WINDOW = std::chrono::seconds{30};
+
+/* Link speed rarely changes, and some drivers are slow to report the error counters */
+const auto ETHTOOL_INTERVAL = std::chrono::seconds{30};
+
+/** @brief Checks whether the module is implemented with the feature enabled, i.e., whether the nodes gated by it can be published */
+bool isFeatureEnabled(sysrepo::Session session, const std::string& module, const std::string& revision, const std::string& feature)
+{
+    auto mod = session.getContext().getModule(module, revision);
+    return mod && mod->implemented() && mod->featureEnabled(feature);
+}
+
+/** @brief The kernel routing tables which are published as the given RIBs */
+velia::network::Rtnetlink::RouteTables routeTables(const std::vector<velia::network::RibSource>& ribs)
+{
+    velia::network::Rtnetlink::RouteTables res;
+    for (const auto& rib : ribs) {
+        if (const auto* table = std::get_if<uint32_t>(&rib.table)) {
+            res.ids.insert(*table);
+        } else {
+            res.vrfs.insert(std::get<std::string>(rib.table));
+        }
+    }
+    return res;
+}
 
 std::string operStatusToString(uint8_t operStatus, velia::Log log)
 {
@@ -124,37 +153,49 @@ std::string getIPVersion(int addrFamily)
     }
 }
 
-/** @brief Returns YANG structure for ietf-ip:ipv(4|6)/neighbours. Set requestedAddrFamily to required ip version (AF_INET for ipv4 or AF_INET6 for ipv6). */
-velia::utils::YANGData collectNeighboursIP(std::shared_ptr<velia::network::Rtnetlink> rtnetlink, int requestedAddrFamily, velia::Log log)
+/** @brief Extracts the name of the interface from the request XPath, if the request is limited to a single interface
+ *
+ * Example input:  /ietf-interfaces:interfaces/interface[name='eth0']/ietf-ip:ipv4/neighbor
+ * Example output: eth0
+ */
+std::optional<std::string> requestedLinkName(std::optional<std::string_view> requestXPath)
 {
-    velia::utils::YANGData values;
-
-    for (const auto& [neigh, link] : rtnetlink->getNeighbours()) {
-        if (rtnl_neigh_get_state(neigh.get()) == NUD_NOARP) {
-            continue;
-        }
+    static const std::regex regex(R"(/ietf-interfaces:interfaces/interface\[name=('|")(.*?)\1\].*)");
+    std::smatch match;
 
-        auto linkName = rtnl_link_get_name(link.get());
-
-        auto ipAddr = rtnl_neigh_get_dst(neigh.get());
-        auto ipAddrFamily = nl_addr_get_family(ipAddr);
+    if (!requestXPath) {
+        return std::nullopt;
+    }
 
-        if (ipAddrFamily != requestedAddrFamily) {
-            continue;
-        }
+    if (const std::string xpath{*requestXPath}; std::regex_match(xpath, match, regex)) {
+        return match.str(2);
+    }
 
-        auto ipAddress = binaddrToString(nl_addr_get_binary_addr(ipAddr), ipAddrFamily);
+    return std::nullopt;
+}
 
-        auto llAddr = rtnl_neigh_get_lladdr(neigh.get());
-        std::array<char, PHYS_ADDR_BUF_SIZE> llAddrBuf {};
-        if (auto llAddress = nl_addr2str(llAddr, llAddrBuf.data(), llAddrBuf.size()); llAddress != "none"s) {
-            values.emplace_back(IETF_INTERFACES + "/interface[name='" + linkName + "']/ietf-ip:" + getIPVersion(ipAddrFamily) + "/neighbor[ip='" + ipAddress + "']/link-layer-address", llAddress);
-        } else {
-            log->warn("Neighbor '{}' on link '{}' returned link layer address 'none'", ipAddress, linkName);
-        }
+BridgeFdb::Type fdbEntryType(int state)
+{
+    if (state & NUD_PERMANENT) {
+        return BridgeFdb::Type::Permanent;
     }
+    if (state & NUD_NOARP) {
+        return BridgeFdb::Type::Static;
+    }
+    return BridgeFdb::Type::Dynamic;
+}
 
-    return values;
+std::string fdbEntryTypeToString(BridgeFdb::Type type)
+{
+    switch (type) {
+    case BridgeFdb::Type::Dynamic:
+        return "dynamic";
+    case BridgeFdb::Type::Static:
+        return "static";
+    case BridgeFdb::Type::Permanent:
+        return "permanent";
+    }
+    __builtin_unreachable();
 }
 
 /** @brief Determine if link is a bridge
@@ -169,18 +210,50 @@ bool isBridge(rtnl_link* link)
 {
     return std::filesystem::exists("/sys/class/net/"s + rtnl_link_get_name(link) + "/bridge");
 }
+
+/** @brief Like utils::valuesPush, but the removals from our stored ops edit happen *before* the new values are added
+ *
+ * That's needed for keyless lists, where the stale entries must be gone before the new ones are appended at their positions,
+ * and for batched changes, where a node can be removed and then created again.
+ */
+void removeAndPush(sysrepo::Session session, const std::vector<std::string>& foreignRemovals, const std::vector<std::string>& ourRemovals, const velia::utils::YANGData& values)
+{
+    if (foreignRemovals.empty() && ourRemovals.empty() && values.empty()) {
+        return;
+    }
+
+    velia::utils::ScopedDatastoreSwitch s(session, sysrepo::Datastore::Operational);
+    auto edit = session.operationalChanges();
+    velia::utils::valuesToYang({}, foreignRemovals, ourRemovals, session, edit);
+    velia::utils::valuesToYang(values, {}, {}, session, edit);
+
+    if (edit) {
+        session.editBatch(*edit, sysrepo::DefaultOperation::Replace);
+        session.applyChanges();
+    }
+}
 }
 
 namespace velia::network {
 
-IETFInterfaces::IETFInterfaces(::sysrepo::Session srSess)
+IETFInterfaces::IETFInterfaces(::sysrepo::Session srSess, std::chrono::milliseconds statisticsInterval, std::function<void()> linkSetChanged, const std::vector<RibSource>& ribs)
     : m_srSession(srSess)
     , m_srSubscribe()
     , m_log(spdlog::get("network"))
+    , m_linkSetChanged(std::move(linkSetChanged))
+    , m_interfacesPublisher([this]() { publishInterfaces(); }, INTERFACES_QUIET_PERIOD, INTERFACES_MAX_DELAY)
+    , m_routingInterfaces(isFeatureEnabled(m_srSession, IETF_ROUTING_MODULE_NAME, "2018-03-13", "router-id"))
+    , m_routingTable(m_log, ribs)
+    , m_routesPublisher([this]() { publishRoutes(); }, ROUTES_QUIET_PERIOD, ROUTES_MAX_DELAY)
     , m_rtnetlink(std::make_shared<Rtnetlink>(
           [this](rtnl_link* link, int action) { onLinkUpdate(link, action); },
           [this](rtnl_addr* addr, int action) { onAddrUpdate(addr, action); },
-          [this](rtnl_route* addr, int action) { onRouteUpdate(addr, action); }))
+          [this](rtnl_route* addr, int action) { onRouteUpdate(addr, action); },
+          [this](rtnl_neigh* neigh, int action) { onNeighUpdate(neigh, action); },
+          Rtnetlink::EventLoop::Internal,
+          routeTables(ribs)))
+    , m_statisticsSampler([this]() { return linkCounters(); }, statisticsInterval, STATISTICS_RATES_WINDOW)
+    , m_ethtoolSampler([this]() { return ethtoolLinkInfo(); }, ETHTOOL_INTERVAL)
 {
     utils::ensureModuleImplemented(m_srSession, IETF_INTERFACES_MODULE_NAME, "2018-02-20");
     utils::ensureModuleImplemented(m_srSession, IETF_IP_MODULE_NAME, "2018-02-22");
@@ -188,21 +261,40 @@ IETFInterfaces::IETFInterfaces(::sysrepo::Session srSess)
     utils::ensureModuleImplemented(m_srSession, IETF_IPV4_UNICAST_ROUTING_MODULE_NAME, "2018-03-13");
     utils::ensureModuleImplemented(m_srSession, IETF_IPV6_UNICAST_ROUTING_MODULE_NAME, "2018-03-13");
     utils::ensureModuleImplemented(m_srSession, CZECHLIGHT_NETWORK_MODULE_NAME, "2026-03-09");
+    utils::ensureModuleImplemented(m_srSession, VELIA_INTERFACES_MODULE_NAME, "2026-10-18");
 
     m_rtnetlink->invokeInitialCallbacks();
-    // TODO: Implement /ietf-routing:routing/interfaces and /ietf-routing:routing/router-id
+    publishInterfaces(); // do not wait for the debouncer, the initial data should be there as soon as we're constructed
+    m_statisticsSampler.sample(); // the link names are only known now
 
     sysrepo::OperGetCb statsCb = [this](auto session, auto, auto, auto, auto, auto, auto& parent) {
         utils::YANGData values;
-        for (const auto& link : m_rtnetlink->getLinks()) {
-            const auto yangPrefix = IETF_INTERFACES + "/interface[name='" + rtnl_link_get_name(link.get()) + "']/statistics";
-
-            values.emplace_back(yangPrefix + "/in-octets", std::to_string(rtnl_link_get_stat(link.get(), RTNL_LINK_RX_BYTES)));
-            values.emplace_back(yangPrefix + "/out-octets", std::to_string(rtnl_link_get_stat(link.get(), RTNL_LINK_TX_BYTES)));
-            values.emplace_back(yangPrefix + "/in-discards", std::to_string(rtnl_link_get_stat(link.get(), RTNL_LINK_RX_DROPPED)));
-            values.emplace_back(yangPrefix + "/out-discards", std::to_string(rtnl_link_get_stat(link.get(), RTNL_LINK_TX_DROPPED)));
-            values.emplace_back(yangPrefix + "/in-errors", std::to_string(rtnl_link_get_stat(link.get(), RTNL_LINK_RX_ERRORS)));
-            values.emplace_back(yangPrefix + "/out-errors", std::to_string(rtnl_link_get_stat(link.get(), RTNL_LINK_TX_ERRORS)));
+        for (const auto& [name, stats] : m_statisticsSampler.snapshot()) {
+            const auto yangPrefix = IETF_INTERFACES + "/interface[name='" + name + "']/statistics";
+
+            values.emplace_back(yangPrefix + "/in-octets", std::to_string(stats.counters.inOctets));
+            values.emplace_back(yangPrefix + "/out-octets", std::to_string(stats.counters.outOctets));
+            values.emplace_back(yangPrefix + "/in-multicast-pkts", std::to_string(stats.counters.inMulticastPackets));
+            // these are yang:counter32, i.e., they wrap around at 2^32
+            values.emplace_back(yangPrefix + "/in-discards", std::to_string(static_cast<uint32_t>(stats.counters.inDiscards)));
+            values.emplace_back(yangPrefix + "/out-discards", std::to_string(static_cast<uint32_t>(stats.counters.outDiscards)));
+            values.emplace_back(yangPrefix + "/in-errors", std::to_string(static_cast<uint32_t>(stats.counters.inErrors)));
+            values.emplace_back(yangPrefix + "/out-errors", std::to_string(static_cast<uint32_t>(stats.counters.outErrors)));
+            values.emplace_back(yangPrefix + "/in-unknown-protos", std::to_string(static_cast<uint32_t>(stats.counters.inUnknownProtos)));
+
+            if (stats.rates) {
+                const auto ratesPrefix = yangPrefix + "/" + VELIA_INTERFACES_MODULE_NAME + ":rates";
+                values.emplace_back(ratesPrefix + "/in-bits-per-second", std::to_string(stats.rates->inBitsPerSecond));
+                values.emplace_back(ratesPrefix + "/out-bits-per-second", std::to_string(stats.rates->outBitsPerSecond));
+                values.emplace_back(ratesPrefix + "/in-packets-per-second", std::to_string(stats.rates->inPacketsPerSecond));
+                values.emplace_back(ratesPrefix + "/out-packets-per-second", std::to_string(stats.rates->outPacketsPerSecond));
+            }
+        }
+
+        for (const auto& [name, info] : m_ethtoolSampler.snapshot()) {
+            for (const auto& [counter, value] : info.counters) {
+                values.emplace_back(IETF_INTERFACES + "/interface[name='" + name + "']/statistics/" + VELIA_INTERFACES_MODULE_NAME + ":ethernet/" + counter, std::to_string(value));
+            }
         }
 
         utils::valuesToYang(values, {}, {}, session, parent);
@@ -212,18 +304,53 @@ IETFInterfaces::IETFInterfaces(::sysrepo::Session srSess)
     m_srSubscribe = m_srSession.onOperGet(IETF_INTERFACES_MODULE_NAME, statsCb, IETF_INTERFACES + "/interface/statistics");
 
     m_srSubscribe->onOperGet(
-        IETF_INTERFACES_MODULE_NAME, [this](auto session, auto, auto, auto, auto, auto, auto& parent) {
-            utils::valuesToYang(collectNeighboursIP(m_rtnetlink, AF_INET, m_log), {}, {}, session, parent);
+        IETF_INTERFACES_MODULE_NAME, [this](auto session, auto, auto, auto, auto requestXPath, auto, auto& parent) {
+            utils::valuesToYang(neighboursToYang(AF_INET, requestedLinkName(requestXPath)), {}, {}, session, parent);
             return sysrepo::ErrorCode::Ok;
         },
         IETF_INTERFACES + "/interface/ietf-ip:ipv4/neighbor");
 
     m_srSubscribe->onOperGet(
-        IETF_INTERFACES_MODULE_NAME, [this](auto session, auto, auto, auto, auto, auto, auto& parent) {
-            utils::valuesToYang(collectNeighboursIP(m_rtnetlink, AF_INET6, m_log), {}, {}, session, parent);
+        IETF_INTERFACES_MODULE_NAME, [this](auto session, auto, auto, auto, auto requestXPath, auto, auto& parent) {
+            utils::valuesToYang(neighboursToYang(AF_INET6, requestedLinkName(requestXPath)), {}, {}, session, parent);
             return sysrepo::ErrorCode::Ok;
         },
         IETF_INTERFACES + "/interface/ietf-ip:ipv6/neighbor");
+
+    sysrepo::OperGetCb linkModesCb = [this](auto session, auto, auto, auto, auto requestXPath, auto, auto& parent) {
+        const auto linkName = requestedLinkName(requestXPath);
+        utils::YANGData values;
+        for (const auto& [name, info] : m_ethtoolSampler.snapshot()) {
+            if (linkName && name != *linkName) {
+                continue;
+            }
+
+            if (info.speed) {
+                values.emplace_back(IETF_INTERFACES + "/interface[name='" + name + "']/speed", std::to_string(*info.speed));
+            }
+            if (info.fullDuplex) {
+                values.emplace_back(IETF_INTERFACES + "/interface[name='" + name + "']/" + VELIA_INTERFACES_MODULE_NAME + ":duplex", *info.fullDuplex ? "full" : "half");
+            }
+        }
+
+        utils::valuesToYang(values, {}, {}, session, parent);
+        return sysrepo::ErrorCode::Ok;
+    };
+    m_srSubscribe->onOperGet(IETF_INTERFACES_MODULE_NAME, linkModesCb, IETF_INTERFACES + "/interface/speed");
+    m_srSubscribe->onOperGet(IETF_INTERFACES_MODULE_NAME, linkModesCb, IETF_INTERFACES + "/interface/" + VELIA_INTERFACES_MODULE_NAME + ":duplex");
+
+    // the FDB of a busy bridge can have tens of thousands of entries, that's why it is not pushed into the operational DS
+    m_srSubscribe->onOperGet(
+        IETF_INTERFACES_MODULE_NAME, [this](auto session, auto, auto, auto, auto requestXPath, auto, auto& parent) {
+            utils::valuesToYang(bridgeFdbToYang(requestedLinkName(requestXPath)), {}, {}, session, parent);
+            return sysrepo::ErrorCode::Ok;
+        },
+        IETF_INTERFACES + "/interface/" + VELIA_INTERFACES_MODULE_NAME + ":bridge-fdb");
+}
+
+std::shared_ptr<Rtnetlink> IETFInterfaces::rtnetlink() const
+{
+    return m_rtnetlink;
 }
 
 void IETFInterfaces::onLinkUpdate(rtnl_link* link, int action)
@@ -231,10 +358,54 @@ void IETFInterfaces::onLinkUpdate(rtnl_link* link, int action)
     char* name = rtnl_link_get_name(link);
     m_log->trace("Netlink update on link '{}', action {}", name, nlActionToString(action));
 
+    bool linkSetChanged = false;
+    {
+        std::lock_guard lock(m_linkNamesMtx);
+        if (action == NL_ACT_DEL) {
+            linkSetChanged = m_linkNames.erase(rtnl_link_get_ifindex(link)) > 0;
+
+            std::lock_guard neighboursLock(m_neighboursMtx);
+            m_neighbours.removeLink(rtnl_link_get_ifindex(link));
+
+            std::lock_guard bridgeFdbLock(m_bridgeFdbMtx);
+            m_bridgeFdb.removeLink(rtnl_link_get_ifindex(link));
+        } else if (action == NL_ACT_CHANGE || action == NL_ACT_NEW) {
+            auto [it, inserted] = m_linkNames.try_emplace(rtnl_link_get_ifindex(link), name);
+            linkSetChanged = inserted || it->second != name;
+            it->second = name;
+        }
+    }
+    if (linkSetChanged && m_linkSetChanged) {
+        m_linkSetChanged();
+    }
+
+    if (action == NL_ACT_DEL || action == NL_ACT_CHANGE || action == NL_ACT_NEW) {
+        std::optional<uint32_t> vrfTable;
+        if (uint32_t table; rtnl_link_is_vrf(link) && rtnl_link_vrf_get_tableid(link, &table) == 0) {
+            vrfTable = table;
+        }
+
+        bool routesChanged;
+        {
+            std::lock_guard lock(m_routingTableMtx);
+            routesChanged = m_routingTable.updateLink(rtnl_link_get_ifindex(link), action == NL_ACT_DEL ? std::nullopt : std::optional<std::string>{name}, vrfTable);
+        }
+        if (routesChanged) {
+            m_routesPublisher.trigger();
+        }
+
+        RoutingInterfaces::Changes routingChanges;
+        {
+            std::lock_guard lock(m_routingInterfacesMtx);
+            routingChanges = m_routingInterfaces.updateLink(rtnl_link_get_ifindex(link), action == NL_ACT_DEL ? std::nullopt : std::optional<std::string>{name});
+        }
+        if (!routingChanges.values.empty() || !routingChanges.removals.empty()) {
+            enqueueInterfaceChanges(routingChanges.values, routingChanges.removals);
+        }
+    }
+
     if (action == NL_ACT_DEL) {
-        std::lock_guard<std::mutex> lock(m_mtx);
-        std::vector<std::string> deletePaths = {IETF_INTERFACES + "/interface[name='" + name + "']"};
-        utils::valuesPush(m_srSession, utils::YANGData{}, deletePaths, deletePaths);
+        enqueueInterfaceChanges({}, {IETF_INTERFACES + "/interface[name='" + name + "']"});
     } else if (action == NL_ACT_CHANGE || action == NL_ACT_NEW) {
         utils::YANGData values;
         std::vector<std::string> deletePaths;
@@ -255,13 +426,64 @@ void IETFInterfaces::onLinkUpdate(rtnl_link* link, int action)
         values.emplace_back(IETF_INTERFACES + "/interface[name='" + name + "']/oper-status",
                 operStatusToString(rtnl_link_get_operstate(link), m_log));
 
-        std::lock_guard<std::mutex> lock(m_mtx);
-        utils::valuesPush(m_srSession, values, deletePaths, deletePaths);
+        enqueueInterfaceChanges(values, deletePaths);
     } else {
         m_log->warn("Unhandled cache update action {} ({})", action, nlActionToString(action));
     }
 }
 
+/** @brief Speed, duplex and Ethernet error counters of all links, by the link name
+ *
+ * The names are taken from the link cache, not from the link callbacks, so that the EthtoolSampler gets the data for all links
+ * right when it is constructed.
+ */
+std::map<std::string, Rtnetlink::EthtoolLinkInfo> IETFInterfaces::ethtoolLinkInfo()
+{
+    auto linkInfo = m_rtnetlink->getEthtoolLinkInfo();
+
+    std::map<int, std::string> names;
+    m_rtnetlink->forEachLink([&names](rtnl_link* link) {
+        names.emplace(rtnl_link_get_ifindex(link), rtnl_link_get_name(link));
+    });
+
+    std::map<std::string, Rtnetlink::EthtoolLinkInfo> res;
+    for (auto& [ifindex, info] : linkInfo) {
+        if (auto it = names.find(ifindex); it != names.end()) {
+            res.emplace(it->second, std::move(info));
+        }
+    }
+    return res;
+}
+
+/** @brief Current counters of all links, which are known by their name */
+std::map<std::string, InterfaceCounters> IETFInterfaces::linkCounters()
+{
+    auto linkStats = m_rtnetlink->getLinkStatistics();
+
+    std::lock_guard lock(m_linkNamesMtx);
+    std::map<std::string, InterfaceCounters> res;
+    for (const auto& [ifindex, stats] : linkStats) {
+        auto it = m_linkNames.find(ifindex);
+        if (it == m_linkNames.end()) {
+            continue; // a link which has just appeared or disappeared
+        }
+
+        res.emplace(it->second, InterfaceCounters{
+            .inOctets = stats.rx_bytes,
+            .inPackets = stats.rx_packets,
+            .inMulticastPackets = stats.multicast,
+            .inDiscards = stats.rx_dropped,
+            .inErrors = stats.rx_errors,
+            .inUnknownProtos = stats.rx_nohandler,
+            .outOctets = stats.tx_bytes,
+            .outPackets = stats.tx_packets,
+            .outDiscards = stats.tx_dropped,
+            .outErrors = stats.tx_errors,
+        });
+    }
+    return res;
+}
+
 void IETFInterfaces::onAddrUpdate(rtnl_addr* addr, int action)
 {
     std::unique_ptr<rtnl_link, std::function<void(rtnl_link*)>> link(rtnl_addr_get_link(addr), [](rtnl_link* obj) { nl_object_put(OBJ_CAST(obj)); });
@@ -288,129 +510,197 @@ void IETFInterfaces::onAddrUpdate(rtnl_addr* addr, int action)
         values.emplace_back(yangPrefix + "/prefix-length", std::to_string(rtnl_addr_get_prefixlen(addr)));
     } else {
         m_log->warn("Unhandled cache update action {} ({})", action, nlActionToString(action));
+        return;
     }
 
-    std::lock_guard<std::mutex> lock(m_mtx);
-    utils::valuesPush(m_srSession, values, deletePaths, deletePaths);
+    {
+        std::lock_guard lock(m_routingInterfacesMtx);
+        auto routingChanges = m_routingInterfaces.updateAddress(rtnl_addr_get_ifindex(addr), addrFamily, ipAddress, action != NL_ACT_DEL);
+        std::move(routingChanges.values.begin(), routingChanges.values.end(), std::back_inserter(values));
+        std::move(routingChanges.removals.begin(), routingChanges.removals.end(), std::back_inserter(deletePaths));
+    }
+
+    enqueueInterfaceChanges(values, deletePaths);
 }
 
-void IETFInterfaces::onRouteUpdate(rtnl_route*, int)
+/** @brief Queues changes of the link and address data (and of the ietf-routing interfaces) for publishing, superseding whatever was queued for the same nodes before */
+void IETFInterfaces::enqueueInterfaceChanges(const utils::YANGData& values, const std::vector<std::string>& removals)
 {
-    /* NOTE:
-     * We don't know the position of the changed route in the list of routes
-     * Replace the whole subtree (and therefore fetch all routes to publish fresh data)
-     * Unfortunately, this function may be called several times during the "reconstruction" of the routing table.
-     */
+    size_t pending;
+    {
+        std::lock_guard lock(m_pendingInterfaceChangesMtx);
+        for (const auto& xpath : removals) {
+            // the removal wins over the queued changes of this node and of all its descendants, which all share the xpath as their prefix
+            for (auto it = m_pendingInterfaceChanges.lower_bound(xpath); it != m_pendingInterfaceChanges.end() && it->first.starts_with(xpath);) {
+                if (it->first.size() == xpath.size() || it->first[xpath.size()] == '/') {
+                    it = m_pendingInterfaceChanges.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            m_pendingInterfaceChanges.emplace(xpath, std::nullopt);
+        }
 
-    utils::YANGData values;
+        for (const auto& [xpath, value] : values) {
+            m_pendingInterfaceChanges.insert_or_assign(xpath, value);
+        }
+        pending = m_pendingInterfaceChanges.size();
+    }
 
-    auto routes = m_rtnetlink->getRoutes();
-    auto links = m_rtnetlink->getLinks();
+    if (pending >= INTERFACES_MAX_BATCH) {
+        m_interfacesPublisher.triggerNow();
+    } else {
+        m_interfacesPublisher.trigger();
+    }
+}
 
-    // ipv4 and ipv6 routes are in separate lists; keep a track of current index to the list so we correctly append the route to the end of the list
-    std::map<decltype(AF_INET), unsigned> routeIdx {{AF_INET, 1}, {AF_INET6, 1}};
+void IETFInterfaces::publishInterfaces()
+{
+    decltype(m_pendingInterfaceChanges) pending;
+    {
+        std::lock_guard lock(m_pendingInterfaceChangesMtx);
+        std::swap(pending, m_pendingInterfaceChanges);
+    }
 
-    for (const auto& route : routes) {
-        if (rtnl_route_get_table(route.get()) != RT_TABLE_MAIN) {
-            continue;
+    // the removals sort before the values in their subtrees, so a link which was removed and created again ends up with fresh data
+    utils::YANGData values;
+    std::vector<std::string> removals;
+    for (auto& [xpath, value] : pending) {
+        if (value) {
+            values.emplace_back(xpath, std::move(*value));
+        } else {
+            removals.emplace_back(xpath);
         }
+    }
 
-        if (rtnl_route_get_type(route.get()) != RTN_UNICAST) {
-            continue;
-        }
+    m_log->trace("Publishing interface changes: {} removals, {} values", removals.size(), values.size());
+    std::lock_guard lock(m_mtx);
+    removeAndPush(m_srSession, removals, removals, values);
+}
 
-        auto family = rtnl_route_get_family(route.get());
-        if (family != AF_INET && family != AF_INET6) {
-            continue;
-        }
+void IETFInterfaces::onRouteUpdate(rtnl_route* route, int action)
+{
+    bool changed;
+    {
+        std::lock_guard lock(m_routingTableMtx);
+        changed = m_routingTable.updateRoute(route, action);
+    }
 
-        auto proto = rtnl_route_get_protocol(route.get());
-        if (proto != RTPROT_KERNEL && proto != RTPROT_RA && proto != RTPROT_DHCP && proto != RTPROT_STATIC && proto != RTPROT_BOOT) {
-            std::array<char, arrlen("redirect")> buf; /* "redirect" is the longest value (libnl/lib/route/route_utils.c, init_proto_names) */
-            m_log->warn("Unimplemented routing protocol {} '{}'", proto, rtnl_route_proto2str(proto, buf.data(), buf.size()));
-            continue;
+    if (changed) {
+        m_routesPublisher.trigger();
+    }
+}
+
+void IETFInterfaces::onNeighUpdate(rtnl_neigh* neigh, int action)
+{
+    if (rtnl_neigh_get_family(neigh) == AF_BRIDGE) {
+        onBridgeFdbUpdate(neigh, action);
+        return;
+    }
+
+    auto ipAddr = rtnl_neigh_get_dst(neigh);
+    if (!ipAddr) {
+        return;
+    }
+    auto ipAddrFamily = nl_addr_get_family(ipAddr);
+    if (ipAddrFamily != AF_INET && ipAddrFamily != AF_INET6) {
+        return;
+    }
+
+    const auto ifindex = rtnl_neigh_get_ifindex(neigh);
+    const auto ipAddress = binaddrToString(nl_addr_get_binary_addr(ipAddr), ipAddrFamily);
+    m_log->trace("Netlink update on neighbour {} of link {}, action {}", ipAddress, ifindex, nlActionToString(action));
+
+    std::array<char, PHYS_ADDR_BUF_SIZE> llAddrBuf{};
+    const std::string llAddress = nl_addr2str(rtnl_neigh_get_lladdr(neigh), llAddrBuf.data(), llAddrBuf.size());
+
+    std::lock_guard lock(m_neighboursMtx);
+    if (action == NL_ACT_DEL) {
+        m_neighbours.remove(ifindex, ipAddrFamily, ipAddress);
+    } else if (action == NL_ACT_CHANGE || action == NL_ACT_NEW) {
+        // incomplete and failed entries have no link-layer address
+        if (rtnl_neigh_get_state(neigh) == NUD_NOARP || llAddress == "none"s) {
+            m_neighbours.remove(ifindex, ipAddrFamily, ipAddress);
+        } else {
+            m_neighbours.set(ifindex, ipAddrFamily, ipAddress, llAddress);
         }
+    } else {
+        m_log->warn("Unhandled cache update action {} ({})", action, nlActionToString(action));
+    }
+}
 
-        const auto ribName = family == AF_INET ? "ipv4-master"s : "ipv6-master"s;
-        const auto yangPrefix = "/ietf-routing:routing/ribs/rib[name='" + ribName + "']/routes/route["s + std::to_string(routeIdx[family]++) + "]/";
-        const auto familyYangPrefix = family == AF_INET ? "ietf-ipv4-unicast-routing"s : "ietf-ipv6-unicast-routing"s;
-
-        std::string destPrefix;
-        if (auto* addr = rtnl_route_get_dst(route.get()); addr != nullptr) {
-            if (nl_addr_iszero(addr)) {
-                destPrefix = family == AF_INET ? "0.0.0.0/0" : "::/0";
-            } else {
-                std::array<char, IPV6ADDRSTRLEN_WITH_PREFIX> data;
-                destPrefix = nl_addr2str(addr, data.data(), data.size());
-
-                // append prefix len if nl_addr2str fails to do that (when prefix length is 32 in ipv4 or 128 in ipv6)
-                if (destPrefix.find_first_of('/') == std::string::npos) {
-                    destPrefix += "/" + std::to_string(nl_addr_get_prefixlen(addr));
-                }
-            }
+void IETFInterfaces::onBridgeFdbUpdate(rtnl_neigh* neigh, int action)
+{
+    // entries without a master are the addresses which the port itself accepts ("bridge fdb ... self"), those are not a part of any bridge FDB
+    const auto bridge = rtnl_neigh_get_master(neigh);
+    if (bridge <= 0) {
+        return;
+    }
+
+    std::array<char, PHYS_ADDR_BUF_SIZE> llAddrBuf{};
+    const std::string macAddress = nl_addr2str(rtnl_neigh_get_lladdr(neigh), llAddrBuf.data(), llAddrBuf.size());
+    const auto vlan = std::max(rtnl_neigh_get_vlan(neigh), 0);
+    const auto port = rtnl_neigh_get_ifindex(neigh);
+    m_log->trace("Netlink update on FDB entry {} vlan {} of bridge {} (port {}), action {}", macAddress, vlan, bridge, port, nlActionToString(action));
+
+    std::lock_guard lock(m_bridgeFdbMtx);
+    if (action == NL_ACT_DEL) {
+        m_bridgeFdb.remove(bridge, macAddress, vlan);
+    } else if (action == NL_ACT_CHANGE || action == NL_ACT_NEW) {
+        m_bridgeFdb.set(bridge, port, macAddress, vlan, fdbEntryType(rtnl_neigh_get_state(neigh)));
+    } else {
+        m_log->warn("Unhandled cache update action {} ({})", action, nlActionToString(action));
+    }
+}
+
+/** @brief Returns YANG structure for velia-interfaces:bridge-fdb of all links, or just of @p linkName */
+utils::YANGData IETFInterfaces::bridgeFdbToYang(const std::optional<std::string>& linkName)
+{
+    utils::YANGData values;
+
+    std::scoped_lock lock(m_linkNamesMtx, m_bridgeFdbMtx);
+    for (const auto& [ifindex, name] : m_linkNames) {
+        if (linkName && name != *linkName) {
+            continue;
         }
 
-        values.emplace_back(yangPrefix + familyYangPrefix + ":destination-prefix", destPrefix);
-
-        auto scope = rtnl_route_get_scope(route.get());
-        std::string protoStr;
-        switch (proto) {
-        case RTPROT_KERNEL:
-            protoStr = scope == RT_SCOPE_LINK ? "direct" : "static";
-            break;
-        case RTPROT_STATIC:
-        case RTPROT_BOOT:
-            protoStr = "static";
-            break;
-        case RTPROT_DHCP:
-            protoStr = "czechlight-network:dhcp";
-            break;
-        case RTPROT_RA:
-            protoStr = "czechlight-network:ra";
-            break;
-        default:
-            throw std::invalid_argument("Unexpected route protocol ("s + std::to_string(proto) + ")");
+        for (const auto& entry : m_bridgeFdb.entries(ifindex)) {
+            values.emplace_back(IETF_INTERFACES + "/interface[name='" + name + "']/" + VELIA_INTERFACES_MODULE_NAME + ":bridge-fdb/entry[mac-address='" + entry.macAddress + "'][vlan='" + std::to_string(entry.vlan) + "']/type", fdbEntryTypeToString(entry.type));
         }
+    }
 
-        values.emplace_back(yangPrefix + "source-protocol", protoStr);
+    return values;
+}
 
-        auto routePreference = rtnl_route_get_priority(route.get());
-        values.emplace_back(yangPrefix + "route-preference", std::to_string(routePreference));
+/** @brief Returns YANG structure for ietf-ip:ipv(4|6)/neighbor of all links, or just of @p linkName. Set family to AF_INET for ipv4 or AF_INET6 for ipv6. */
+utils::YANGData IETFInterfaces::neighboursToYang(int family, const std::optional<std::string>& linkName)
+{
+    utils::YANGData values;
 
-        const auto hops = rtnl_route_get_nnexthops(route.get());
-        const bool multihop = hops > 1;
-        for (auto i = 0; i < hops; i++) {
-            rtnl_nexthop* nh = rtnl_route_nexthop_n(route.get(), i);
+    std::scoped_lock lock(m_linkNamesMtx, m_neighboursMtx);
+    for (const auto& [ifindex, name] : m_linkNames) {
+        if (linkName && name != *linkName) {
+            continue;
+        }
 
-            if (nl_addr* addr = rtnl_route_nh_get_gateway(nh); addr) {
-                std::string yangKey;
-                if (!multihop) {
-                    yangKey = yangPrefix + "next-hop/" + familyYangPrefix + ":next-hop-address";
-                } else {
-                    yangKey = yangPrefix + "next-hop/next-hop-list/next-hop[" + std::to_string(i + 1) + "]/" + familyYangPrefix + ":address";
-                }
+        for (const auto& neighbour : m_neighbours.neighbours(ifindex, family)) {
+            values.emplace_back(IETF_INTERFACES + "/interface[name='" + name + "']/ietf-ip:" + getIPVersion(family) + "/neighbor[ip='" + neighbour.ip + "']/link-layer-address", neighbour.linkLayerAddress);
+        }
+    }
 
-                std::array<char, IPV6ADDRSTRLEN_WITH_PREFIX> buf;
-                values.emplace_back(yangKey, nl_addr2str(addr, buf.data(), buf.size()));
-            }
+    return values;
+}
 
-            auto if_index = rtnl_route_nh_get_ifindex(nh);
-            if (auto linkIt = std::find_if(links.begin(), links.end(), [if_index](const Rtnetlink::nlLink& link) { return rtnl_link_get_ifindex(link.get()) == if_index; }); linkIt != links.end()) {
-                if (char* ifname = rtnl_link_get_name(linkIt->get()); ifname) {
-                    std::string yangKey;
-                    if (!multihop) {
-                        yangKey = yangPrefix + "next-hop/outgoing-interface";
-                    } else {
-                        yangKey = yangPrefix + "next-hop/next-hop-list/next-hop[" + std::to_string(i + 1) + "]/outgoing-interface";
-                    }
-
-                    values.emplace_back(yangKey, rtnl_link_get_name(linkIt->get()));
-                }
-            }
-        }
+void IETFInterfaces::publishRoutes()
+{
+    RoutingTable::Changes changes;
+    {
+        std::lock_guard lock(m_routingTableMtx);
+        changes = m_routingTable.changes();
     }
 
+    m_log->trace("Publishing routing table changes: {} removals, {} values", changes.removals.size(), changes.values.size());
     std::lock_guard<std::mutex> lock(m_mtx);
-    utils::valuesPush(m_srSession, values, {}, {});
+    removeAndPush(m_srSession, {}, changes.removals, changes.values);
 }
 }
@@ -6,31 +6,66 @@
  */
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <mutex>
 #include <sysrepo-cpp/Subscription.hpp>
+#include "network/BridgeFdb.h"
+#include "network/EthtoolSampler.h"
+#include "network/NeighbourTable.h"
+#include "network/RoutingInterfaces.h"
+#include "network/RoutingTable.h"
+#include "network/StatisticsSampler.h"
+#include "utils/debounce.h"
 #include "utils/log-fwd.h"
 
 struct rtnl_link;
 struct rtnl_addr;
 struct rtnl_route;
+struct rtnl_neigh;
 
 namespace velia::network {
 
-class Rtnetlink;
-
 class IETFInterfaces {
 public:
-    explicit IETFInterfaces(::sysrepo::Session srSess);
+    explicit IETFInterfaces(::sysrepo::Session srSess, std::chrono::milliseconds statisticsInterval = std::chrono::seconds{5}, std::function<void()> linkSetChanged = {}, const std::vector<RibSource>& ribs = {MAIN_RIB});
+    std::shared_ptr<Rtnetlink> rtnetlink() const;
 
 private:
     void onLinkUpdate(rtnl_link* link, int action);
     void onAddrUpdate(rtnl_addr* addr, int action);
     void onRouteUpdate(rtnl_route* addr, int action);
+    void onNeighUpdate(rtnl_neigh* neigh, int action);
+    void onBridgeFdbUpdate(rtnl_neigh* neigh, int action);
+    void publishRoutes();
+    void enqueueInterfaceChanges(const utils::YANGData& values, const std::vector<std::string>& removals);
+    void publishInterfaces();
+    std::map<std::string, InterfaceCounters> linkCounters();
+    std::map<std::string, Rtnetlink::EthtoolLinkInfo> ethtoolLinkInfo();
+    utils::YANGData neighboursToYang(int family, const std::optional<std::string>& linkName);
+    utils::YANGData bridgeFdbToYang(const std::optional<std::string>& linkName);
 
     ::sysrepo::Session m_srSession;
     std::optional<::sysrepo::Subscription> m_srSubscribe;
     velia::Log m_log;
-    std::mutex m_mtx;
-    std::shared_ptr<Rtnetlink> m_rtnetlink; // first to destroy, because the callback to rtnetlink uses m_srSession and m_log
+    std::function<void()> m_linkSetChanged; // invoked from netlink callbacks whenever a link appears, disappears or gets renamed
+    std::mutex m_mtx; // serializes the pushes into the operational DS
+    std::mutex m_pendingInterfaceChangesMtx; // protects m_pendingInterfaceChanges, which are queued from netlink callbacks and published from m_interfacesPublisher
+    std::map<std::string, std::optional<std::string>> m_pendingInterfaceChanges; // xpath -> new value, or std::nullopt for a removal
+    utils::Debouncer m_interfacesPublisher; // destroyed after m_rtnetlink so that the netlink callbacks can always trigger it
+    std::mutex m_linkNamesMtx; // protects m_linkNames, which is updated from netlink callbacks and read by m_statisticsSampler and the oper-get callbacks
+    std::map<int, std::string> m_linkNames; // ifindex -> name
+    std::mutex m_neighboursMtx; // protects m_neighbours, which is updated from netlink callbacks and read from the oper-get callbacks
+    NeighbourTable m_neighbours;
+    std::mutex m_bridgeFdbMtx; // protects m_bridgeFdb, which is updated from netlink callbacks and read from the oper-get callbacks
+    BridgeFdb m_bridgeFdb;
+    std::mutex m_routingInterfacesMtx; // protects m_routingInterfaces, which is updated from netlink callbacks
+    RoutingInterfaces m_routingInterfaces;
+    std::mutex m_routingTableMtx; // protects m_routingTable, which is updated from netlink callbacks and published from m_routesPublisher
+    RoutingTable m_routingTable;
+    utils::Debouncer m_routesPublisher; // destroyed after m_rtnetlink so that the netlink callbacks can always trigger it
+    std::shared_ptr<Rtnetlink> m_rtnetlink; // destroyed after m_statisticsSampler, because the callback to rtnetlink uses m_srSession and m_log
+    StatisticsSampler m_statisticsSampler; // destroyed after m_ethtoolSampler, its thread reads the links from m_rtnetlink
+    EthtoolSampler m_ethtoolSampler; // first to destroy, because its thread queries m_rtnetlink
 };
 }
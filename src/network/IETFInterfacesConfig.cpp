@@ -5,7 +5,10 @@
  *
  */
 
+#include <fmt/ranges.h>
 #include <numeric>
+#include <set>
+#include <sysrepo-cpp/Changes.hpp>
 #include "IETFInterfacesConfig.h"
 #include "utils/io.h"
 #include "utils/libyang.h"
@@ -28,6 +31,19 @@ const auto IETF_ROUTING = "/"s + IETF_ROUTING_MODULE_NAME + ":routing"s;
 const auto staticRoutingPrefix = IETF_ROUTING + "/control-plane-protocols/control-plane-protocol[name='static'][type='ietf-routing:static']";
 
 using NetworkConfiguration = std::multimap<std::string, std::vector<std::string>>;
+using StaticRoute = velia::network::IETFInterfacesConfig::StaticRoute;
+
+/** @brief Value of a leaf at a descendant schema @p path, if the leaf exists
+ *
+ * Unlike getUniqueSubtree(), this resolves a plain data path and does not invoke the XPath evaluator.
+ */
+std::optional<std::string> leafValue(const libyang::DataNode& start, const std::string& path)
+{
+    if (auto node = start.findPath(path)) {
+        return velia::utils::asString(*node);
+    }
+    return std::nullopt;
+}
 
 std::string generateNetworkConfigFile(const std::string& linkName, const NetworkConfiguration& values)
 {
@@ -54,21 +70,15 @@ std::string generateNetworkConfigFile(const std::string& linkName, const Network
  */
 bool protocolEnabled(const libyang::DataNode& linkEntry, const std::string& proto)
 {
-    const auto xpath = "ietf-ip:" + proto + "/enabled";
-
-    if (auto node = velia::utils::getUniqueSubtree(linkEntry, xpath)) {
-        return velia::utils::asString(node.value()) == "true"s;
-    }
-
-    return false;
+    return leafValue(linkEntry, "ietf-ip:" + proto + "/enabled") == "true"s;
 }
 
 /** @brief Adds values to [Network] section of systemd.network(5) config file. */
 void addNetworkConfig(NetworkConfiguration& configValues, const std::string& linkName, const libyang::DataNode& linkEntry) {
     NetworkConfiguration::mapped_type network;
 
-    if (auto node = velia::utils::getUniqueSubtree(linkEntry, "description")) {
-        network.push_back("Description="s + velia::utils::asString(node.value()));
+    if (auto description = leafValue(linkEntry, "description")) {
+        network.push_back("Description="s + *description);
     }
 
     // if addresses present, generate them...
@@ -82,8 +92,8 @@ void addNetworkConfig(NetworkConfiguration& configValues, const std::string& lin
         const auto addresses = linkEntry.findXPath(IPAddressListXPath);
 
         for (const auto& ipEntry : addresses) {
-            auto ipAddress = velia::utils::asString(velia::utils::getUniqueSubtree(ipEntry, "ip").value());
-            auto prefixLen = velia::utils::asString(velia::utils::getUniqueSubtree(ipEntry, "prefix-length").value());
+            auto ipAddress = *leafValue(ipEntry, "ip");
+            auto prefixLen = *leafValue(ipEntry, "prefix-length");
 
             spdlog::get("system")->trace("Link {}: address {}/{} configured", linkName, ipAddress, prefixLen);
             network.push_back("Address="s + ipAddress + "/" + prefixLen);
@@ -94,8 +104,8 @@ void addNetworkConfig(NetworkConfiguration& configValues, const std::string& lin
     // disable this behaviour when IPv6 is disabled or when link enslaved
     bool isSlave = false;
 
-    if (auto node = velia::utils::getUniqueSubtree(linkEntry, "czechlight-network:bridge")) {
-        network.push_back("Bridge="s + velia::utils::asString(node.value()));
+    if (auto bridge = leafValue(linkEntry, "czechlight-network:bridge")) {
+        network.push_back("Bridge="s + *bridge);
         isSlave = true;
     }
 
@@ -104,14 +114,13 @@ void addNetworkConfig(NetworkConfiguration& configValues, const std::string& lin
     }
 
     // network autoconfiguration
-    if (auto node = velia::utils::getUniqueSubtree(linkEntry, "ietf-ip:ipv6/ietf-ip:autoconf/ietf-ip:create-global-addresses"); protocolEnabled(linkEntry, "ipv6") && velia::utils::asString(node.value()) == "true"s) {
+    if (protocolEnabled(linkEntry, "ipv6") && leafValue(linkEntry, "ietf-ip:ipv6/ietf-ip:autoconf/ietf-ip:create-global-addresses") == "true"s) {
         network.push_back("IPv6AcceptRA=true");
     } else {
         network.push_back("IPv6AcceptRA=false");
     }
 
-    if (auto node = velia::utils::getUniqueSubtree(linkEntry, "ietf-ip:ipv4/czechlight-network:dhcp-client/czechlight-network:enabled");
-        protocolEnabled(linkEntry, "ipv4") && node && velia::utils::asString(node.value()) == "true"s) {
+    if (protocolEnabled(linkEntry, "ipv4") && leafValue(linkEntry, "ietf-ip:ipv4/czechlight-network:dhcp-client/czechlight-network:enabled") == "true"s) {
         network.push_back("DHCP=ipv4");
     } else {
         network.push_back("DHCP=no");
@@ -127,66 +136,93 @@ void addAutoconfConfig(NetworkConfiguration& configValues, const libyang::DataNo
 {
     NetworkConfiguration::mapped_type ipv6AcceptRA;
 
-    if (auto node = velia::utils::getUniqueSubtree(linkEntry, "ietf-ip:ipv6/autoconf/czechlight-network:accept-dns-advertisements"); node) {
-        ipv6AcceptRA.push_back("UseDNS="s + velia::utils::asString(node.value()));
-    } else {
-        ipv6AcceptRA.push_back("UseDNS=false");
-    }
+    ipv6AcceptRA.push_back("UseDNS="s + leafValue(linkEntry, "ietf-ip:ipv6/ietf-ip:autoconf/czechlight-network:accept-dns-advertisements").value_or("false"));
 
     configValues.emplace("IPv6AcceptRA", std::move(ipv6AcceptRA));
 
     NetworkConfiguration::mapped_type dhcpv4;
 
-    if (auto node = velia::utils::getUniqueSubtree(linkEntry, "ietf-ip:ipv4/czechlight-network:dhcp-client/czechlight-network:use-dns"); node) {
-        dhcpv4.push_back("UseDNS="s + velia::utils::asString(node.value()));
-    } else {
-        dhcpv4.push_back("UseDNS=false");
-    }
-
-    if (auto node = velia::utils::getUniqueSubtree(linkEntry, "ietf-ip:ipv4/czechlight-network:dhcp-client/czechlight-network:use-ntp"); node) {
-        dhcpv4.push_back("UseNTP="s + velia::utils::asString(node.value()));
-    } else {
-        dhcpv4.push_back("UseNTP=false");
-    }
+    dhcpv4.push_back("UseDNS="s + leafValue(linkEntry, "ietf-ip:ipv4/czechlight-network:dhcp-client/czechlight-network:use-dns").value_or("false"));
+    dhcpv4.push_back("UseNTP="s + leafValue(linkEntry, "ietf-ip:ipv4/czechlight-network:dhcp-client/czechlight-network:use-ntp").value_or("false"));
 
     configValues.emplace("DHCPv4", std::move(dhcpv4));
 }
 
 /** @brief Adds values to [Route] section of systemd.network(5) config file. */
-void addRoutingConfig(velia::Log log, NetworkConfiguration& configValues, const std::string& linkName, const libyang::DataNode& linkEntry, const std::optional<libyang::DataNode>& routingEntry)
+void addRoutingConfig(velia::Log log, NetworkConfiguration& configValues, const std::string& linkName, const libyang::DataNode& linkEntry, const std::vector<StaticRoute>& routes)
 {
-    if (!routingEntry) {
+    if (routes.empty()) {
         log->trace("{}.network: no routes specified in ietf-routing", linkName);
         return;
     }
 
-    for (const auto& ipProto : {"ipv4", "ipv6"}) {
-        if (!protocolEnabled(linkEntry, ipProto)) {
-            log->trace("{}.network: {} not enabled, skipping any configured {} routes", linkName, ipProto, ipProto);
+    for (const auto& route : routes) {
+        if (!protocolEnabled(linkEntry, route.protocol)) {
+            log->trace("{}.network: {} not enabled, skipping {} route {}", linkName, route.protocol, route.protocol, route.destination);
             continue;
         }
 
-        const auto routes = routingEntry->findXPath(staticRoutingPrefix + "/static-routes/ietf-"s + ipProto + "-unicast-routing:" + ipProto + "/route");
-        for (const auto& routeEntry : routes) {
-            const auto nextHopNode = velia::utils::getUniqueSubtree(routeEntry, "next-hop");
-            const auto outInterface = velia::utils::asString(*velia::utils::getUniqueSubtree(*nextHopNode, "outgoing-interface"));
-
-            if (outInterface != linkName) {
-                continue;
-            }
-
-            const auto destination = velia::utils::asString(*velia::utils::getUniqueSubtree(routeEntry, "destination-prefix"));
-            const auto nextHopAddress = velia::utils::asString(*velia::utils::getUniqueSubtree(*nextHopNode, "next-hop-address"));
-            const auto metric = velia::utils::asString(*velia::utils::getUniqueSubtree(*nextHopNode, "preference"));
-
-            log->debug("{}.network: adding route {} via {} dev {} metric {}", linkName, destination, nextHopAddress, linkName, metric);
-            configValues.emplace("Route", NetworkConfiguration::mapped_type{
-                                              "Destination="s + destination,
-                                              "Gateway="s + nextHopAddress,
-                                              "Metric="s + metric,
-                                          });
+        log->debug("{}.network: adding route {} via {} dev {} metric {}", linkName, route.destination, route.gateway, linkName, route.metric);
+        configValues.emplace("Route", NetworkConfiguration::mapped_type{
+                                          "Destination="s + route.destination,
+                                          "Gateway="s + route.gateway,
+                                          "Metric="s + route.metric,
+                                      });
+    }
+}
+
+/** @brief Static routes from ietf-routing grouped by their outgoing interface, IPv4 routes first */
+std::map<std::string, std::vector<StaticRoute>> staticRoutes(::sysrepo::Session session)
+{
+    std::map<std::string, std::vector<StaticRoute>> res;
+
+    auto routingData = session.getData(staticRoutingPrefix);
+    if (!routingData) {
+        return res;
+    }
+
+    for (const auto& ipProto : {"ipv4"s, "ipv6"s}) {
+        for (const auto& routeEntry : routingData->findXPath(staticRoutingPrefix + "/static-routes/ietf-" + ipProto + "-unicast-routing:" + ipProto + "/route")) {
+            res[*leafValue(routeEntry, "next-hop/outgoing-interface")].push_back(StaticRoute{
+                .protocol = ipProto,
+                .destination = *leafValue(routeEntry, "destination-prefix"),
+                .gateway = *leafValue(routeEntry, "next-hop/next-hop-address"),
+                .metric = *leafValue(routeEntry, "next-hop/ietf-rib-extension:preference"),
+            });
+        }
+    }
+
+    return res;
+}
+
+const std::vector<StaticRoute>& routesVia(const std::map<std::string, std::vector<StaticRoute>>& routes, const std::string& linkName)
+{
+    static const std::vector<StaticRoute> none;
+
+    auto it = routes.find(linkName);
+    return it == routes.end() ? none : it->second;
+}
+
+/** @brief Names of the interfaces which have a change in the ietf-interfaces subtree, or nullopt if the whole container changed */
+std::optional<std::set<std::string>> changedInterfaces(::sysrepo::Session session)
+{
+    std::set<std::string> res;
+
+    for (const auto& change : session.getChanges(IETF_INTERFACES + "//.")) {
+        // walk up to the list entry just below the top-level container
+        auto node = change.node;
+        while (node.parent() && node.parent()->parent()) {
+            node = *node.parent();
+        }
+
+        if (!node.parent()) {
+            return std::nullopt;
         }
+
+        res.insert(*leafValue(node, "name"));
     }
+
+    return res;
 }
 }
 
@@ -223,43 +259,94 @@ IETFInterfacesConfig::IETFInterfacesConfig(::sysrepo::Session srSess, std::files
         sysrepo::SubscribeOptions::DoneOnly | sysrepo::SubscribeOptions::Enabled); // we are subscribing for SR_EV_DONE, SR_SUBSCR_CHANGE_ALL_MODULES does not apply here
 }
 
-sysrepo::ErrorCode IETFInterfacesConfig::moduleChange(::sysrepo::Session session) const
+/** @brief Regenerates the configuration of those links which are affected by the change
+ *
+ * A link is regenerated when its ietf-interfaces subtree changed, or when the static routes which go through it changed.
+ * All links are regenerated on the first run.
+ */
+sysrepo::ErrorCode IETFInterfacesConfig::moduleChange(::sysrepo::Session session)
 {
-    std::map<std::string, std::optional<std::string>> networkConfigFiles;
+    std::lock_guard lock(m_mtx);
 
-    std::optional<libyang::DataNode> routingEntry;
-    auto routingData = session.getData(staticRoutingPrefix);
-    if (routingData) {
-        routingEntry = routingData->findPath(staticRoutingPrefix);
+    auto routes = staticRoutes(session);
+    auto changed = changedInterfaces(session);
+
+    std::set<std::string> affectedLinks;
+    for (const auto& linkName : m_managedLinks) {
+        if (!changed || changed->contains(linkName) || routesVia(routes, linkName) != routesVia(m_staticRoutes, linkName) || !m_networkFiles.contains(linkName)) {
+            affectedLinks.insert(linkName);
+        }
     }
+    m_staticRoutes = std::move(routes);
+
+    auto changedLinks = updateNetworkFiles(renderLinks(session, affectedLinks), m_configDirectory);
+    m_reloadCb(changedLinks);
+    return sysrepo::ErrorCode::Ok;
+}
 
+/** @brief Starts managing links which have appeared at runtime, and stops managing those which are gone
+ *
+ * Only the configuration of the new links is generated. The configuration files of the removed links are left alone, so that
+ * they are in place in case the link comes back.
+ */
+void IETFInterfacesConfig::setManagedLinks(const std::vector<std::string>& managedLinks)
+{
+    std::lock_guard lock(m_mtx);
+
+    std::set<std::string> added{managedLinks.begin(), managedLinks.end()};
     for (const auto& linkName : m_managedLinks) {
-        auto data = session.getData("/ietf-interfaces:interfaces/interface[name='" + linkName + "']");
-        if (!data) {
+        if (!added.erase(linkName) && m_networkFiles.erase(linkName)) {
+            m_log->info("Link {} is no longer managed", linkName);
+        }
+    }
+    m_managedLinks = managedLinks;
+
+    if (added.empty()) {
+        return;
+    }
+
+    m_log->info("Managing new links: {}", fmt::join(added, ", "));
+    auto changedLinks = updateNetworkFiles(renderLinks(m_srSession, added), m_configDirectory);
+    m_reloadCb(changedLinks);
+}
+
+/** @brief Generates the config files of the given links, or nullopt for the links which should be disabled */
+std::map<std::string, std::optional<std::string>> IETFInterfacesConfig::renderLinks(::sysrepo::Session session, const std::set<std::string>& affectedLinks) const
+{
+    std::map<std::string, std::optional<std::string>> networkConfigFiles;
+
+    std::optional<libyang::DataNode> data;
+    if (!affectedLinks.empty()) {
+        std::vector<std::string> xpaths;
+        for (const auto& linkName : affectedLinks) {
+            xpaths.push_back(IETF_INTERFACES + "/interface[name='" + linkName + "']");
+        }
+        data = session.getData(std::accumulate(std::next(xpaths.begin()), xpaths.end(), xpaths.front(), [](const auto& acc, const auto& xpath) { return acc + " | " + xpath; }));
+    }
+
+    for (const auto& linkName : affectedLinks) {
+        auto linkEntry = data ? data->findPath(IETF_INTERFACES + "/interface[name='" + linkName + "']") : std::nullopt;
+        if (!linkEntry) {
             m_log->debug("Link {} not configured", linkName);
             networkConfigFiles[linkName] = std::nullopt;
             continue;
         }
 
-        auto linkEntry = *data->findPath("/ietf-interfaces:interfaces/interface[name='" + linkName + "']");
-
-        if (auto node = utils::getUniqueSubtree(linkEntry, "enabled"); !node || utils::asString(node.value()) != "true"s) {
+        if (leafValue(*linkEntry, "enabled") != "true"s) {
             m_log->debug("Link {} disabled", linkName);
             networkConfigFiles[linkName] = std::nullopt;
             continue;
         }
 
         NetworkConfiguration configValues;
-        addNetworkConfig(configValues, linkName, linkEntry);
-        addRoutingConfig(m_log, configValues, linkName, linkEntry, routingEntry);
-        addAutoconfConfig(configValues, linkEntry);
+        addNetworkConfig(configValues, linkName, *linkEntry);
+        addRoutingConfig(m_log, configValues, linkName, *linkEntry, routesVia(m_staticRoutes, linkName));
+        addAutoconfConfig(configValues, *linkEntry);
 
         networkConfigFiles[linkName] = generateNetworkConfigFile(linkName, configValues);
     }
 
-    auto changedLinks = updateNetworkFiles(networkConfigFiles, m_configDirectory);
-    m_reloadCb(changedLinks);
-    return sysrepo::ErrorCode::Ok;
+    return networkConfigFiles;
 }
 
 std::string disabledConfiguration(const std::string& linkName)
@@ -273,30 +360,51 @@ IPv6AcceptRA=no
 )";
 }
 
-IETFInterfacesConfig::ChangedUnits IETFInterfacesConfig::updateNetworkFiles(const std::map<std::string, std::optional<std::string>>& networkConfig, const std::filesystem::path& configDir) const
+/** @brief Writes the configuration files of the given links, skipping those whose content is the same as before */
+IETFInterfacesConfig::ChangedUnits IETFInterfacesConfig::updateNetworkFiles(const std::map<std::string, std::optional<std::string>>& networkConfig, const std::filesystem::path& configDir)
 {
     ChangedUnits ret;
+    velia::utils::FileTransaction transaction;
+    std::map<std::string, std::string> written;
 
     for (const auto& link : m_managedLinks) {
+        auto it = networkConfig.find(link);
+        if (it == networkConfig.end()) {
+            continue;
+        }
+
         const auto targetFile = configDir / ("10-"s + link + ".network");
-        const bool fileExists = std::filesystem::exists(targetFile);
-        const auto& configuration = networkConfig.at(link);
+        const auto& configuration = it->second;
+        const auto contents = configuration.value_or(disabledConfiguration(link));
+
+        // the files are only written by us, so it is enough to check what is on the disk the first time
+        if (!m_networkFiles.contains(link) && std::filesystem::exists(targetFile)) {
+            m_networkFiles[link] = velia::utils::readFileToString(targetFile);
+        }
 
         // If the file exists and the content is the same as configuration, no need to change anything
-        if (fileExists && velia::utils::readFileToString(targetFile) == networkConfig.at(link).value_or(disabledConfiguration(link))) {
+        if (auto cached = m_networkFiles.find(link); cached != m_networkFiles.end() && cached->second == contents) {
             continue;
         }
 
+        // configuration removed: write a file which replaces the default configuration, effectively disabling the link
+        transaction.write(targetFile, contents);
+        written[link] = contents;
+
         if (configuration) {
-            velia::utils::safeWriteFile(targetFile, *configuration);
             ret.changedOrNew.push_back(link);
         } else {
-            // configuration removed: write empty file which replaces the default configuration, effectively disabling the link
-            velia::utils::safeWriteFile(targetFile, disabledConfiguration(link));
             ret.deleted.push_back(link);
         }
     }
 
+    if (!transaction.empty()) {
+        auto bytes = transaction.commit();
+        m_log->debug("Wrote {} bytes of systemd-networkd configuration for {} link(s)", bytes, written.size());
+        written.merge(m_networkFiles);
+        m_networkFiles = std::move(written);
+    }
+
     return ret;
 }
 
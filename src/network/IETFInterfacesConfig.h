@@ -8,6 +8,11 @@
 
 #include <filesystem>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
 #include <sysrepo-cpp/Subscription.hpp>
 #include "utils/log-fwd.h"
 
@@ -23,18 +28,31 @@ public:
         Vector changedOrNew;
         bool operator==(const ChangedUnits& other) const noexcept = default;
     };
+    /** @brief A static route from ietf-routing, as it is rendered into the config file of its outgoing interface */
+    struct StaticRoute {
+        std::string protocol;
+        std::string destination;
+        std::string gateway;
+        std::string metric;
+        bool operator==(const StaticRoute& other) const noexcept = default;
+    };
     using reload_cb_t = std::function<void(const ChangedUnits&)>;
     explicit IETFInterfacesConfig(::sysrepo::Session srSess, std::filesystem::path configDirectory, std::vector<std::string> managedLinks, reload_cb_t reloadCallback);
+    void setManagedLinks(const std::vector<std::string>& managedLinks);
 
 private:
     velia::Log m_log;
     reload_cb_t m_reloadCb;
     std::filesystem::path m_configDirectory;
+    std::mutex m_mtx; ///< serializes the datastore changes and the changes of the managed links
     std::vector<std::string> m_managedLinks;
     ::sysrepo::Session m_srSession;
+    std::map<std::string, std::string> m_networkFiles; ///< link name -> contents of its config file as last written
+    std::map<std::string, std::vector<StaticRoute>> m_staticRoutes; ///< link name -> static routes going through the link
     std::optional<::sysrepo::Subscription> m_srSubscribe;
 
-    sysrepo::ErrorCode moduleChange(::sysrepo::Session session) const;
-    ChangedUnits updateNetworkFiles(const std::map<std::string, std::optional<std::string>>& networkConfig, const std::filesystem::path& configDir) const;
+    sysrepo::ErrorCode moduleChange(::sysrepo::Session session);
+    std::map<std::string, std::optional<std::string>> renderLinks(::sysrepo::Session session, const std::set<std::string>& affectedLinks) const;
+    ChangedUnits updateNetworkFiles(const std::map<std::string, std::optional<std::string>>& networkConfig, const std::filesystem::path& configDir);
 };
 }
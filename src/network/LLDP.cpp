@@ -9,6 +9,8 @@
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 #include "LLDP.h"
+#include "LLDPListener.h"
+#include "NetworkctlUtils.h"
 #include "system_vars.h"
 #include "utils/log.h"
 
@@ -62,11 +64,53 @@ LLDPDataProvider::LLDPDataProvider(std::function<std::string()> dataCallback, co
 {
 }
 
+/** @brief Serves the neighbors which the @p listener has received, straight from its memory */
+LLDPDataProvider::LLDPDataProvider(std::shared_ptr<LLDPListener> listener, const LLDPDataProvider::LocalData& localData)
+    : m_log(spdlog::get("network"))
+    , m_listener(std::move(listener))
+    , m_localData(localData)
+{
+}
+
 std::vector<NeighborEntry> LLDPDataProvider::getNeighbors() const
+{
+    return m_listener ? neighborsFromListener() : neighborsFromJSON();
+}
+
+std::vector<NeighborEntry> LLDPDataProvider::neighborsFromListener() const
+{
+    std::vector<NeighborEntry> res;
+
+    for (const auto& neighbor : m_listener->neighbors()) {
+        NeighborEntry ne;
+        ne.m_portId = neighbor.linkName;
+        ne.m_properties["remoteChassisId"] = neighbor.chassisId;
+        ne.m_properties["remotePortId"] = neighbor.portId;
+        if (neighbor.systemName) {
+            ne.m_properties["remoteSysName"] = *neighbor.systemName;
+        }
+        if (neighbor.enabledCapabilities) {
+            ne.m_properties["systemCapabilitiesEnabled"] = toBitsYANG(*neighbor.enabledCapabilities);
+        }
+
+        m_log->trace("Found LLDP neighbor {}", ne);
+        res.push_back(ne);
+    }
+
+    return res;
+}
+
+/** @brief Parses the output of `networkctl lldp --json=short` */
+std::vector<NeighborEntry> LLDPDataProvider::neighborsFromJSON() const
 {
     std::vector<NeighborEntry> res;
 
-    auto json = nlohmann::json::parse(m_dataCallback());
+    // {"Neighbors": [{"InterfaceName": ..., "Neighbors": [{"ChassisID": ..., ...}]}]}
+    auto json = parseSelectedMembers(m_dataCallback(), {
+        {1, {"Neighbors"}},
+        {3, {"InterfaceName", "Neighbors"}},
+        {5, {"ChassisID", "PortID", "SystemName", "EnabledCapabilities"}},
+    });
 
     for (const auto& interface: json["Neighbors"]) {
         auto linkName = interface["InterfaceName"].get<std::string>();
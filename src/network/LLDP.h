@@ -10,12 +10,15 @@
 #include <fmt/ostream.h>
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "utils/log-fwd.h"
 
 namespace velia::network {
 
+class LLDPListener;
+
 struct NeighborEntry {
     std::string m_portId;
     std::map<std::string, std::string> m_properties;
@@ -34,12 +37,17 @@ public:
     using data_callback_t = std::function<std::string()>;
 
     explicit LLDPDataProvider(data_callback_t dataCallback, const LocalData& localData);
+    LLDPDataProvider(std::shared_ptr<LLDPListener> listener, const LocalData& localData);
     std::vector<NeighborEntry> getNeighbors() const;
     std::map<std::string, std::string> localProperties() const;
 
 private:
+    std::vector<NeighborEntry> neighborsFromJSON() const;
+    std::vector<NeighborEntry> neighborsFromListener() const;
+
     velia::Log m_log;
     data_callback_t m_dataCallback;
+    std::shared_ptr<LLDPListener> m_listener;
     LocalData m_localData;
 };
 
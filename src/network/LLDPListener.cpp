@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fmt/format.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <system_error>
+#include <unistd.h>
+#include "LLDPListener.h"
+#include "utils/log.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+const std::array<uint8_t, ETH_ALEN> LLDP_MULTICAST_ADDRESS{0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e};
+
+/* LLDPDUs are small and rare, a few blocks are plenty. A block is handed over to us when it fills up or when it is this old. */
+constexpr size_t RING_BLOCK_SIZE = 1 << 15;
+constexpr size_t RING_BLOCK_COUNT = 8;
+constexpr size_t RING_FRAME_SIZE = 1 << 11;
+constexpr unsigned RING_BLOCK_TIMEOUT_MS = 100;
+
+/* IEEE 802.1AB TLV types */
+enum TLVType : uint8_t {
+    TLV_END = 0,
+    TLV_CHASSIS_ID = 1,
+    TLV_PORT_ID = 2,
+    TLV_TTL = 3,
+    TLV_SYSTEM_NAME = 5,
+    TLV_SYSTEM_CAPABILITIES = 7,
+};
+
+/* Chassis ID and Port ID subtypes which are known to be MAC addresses or strings */
+constexpr uint8_t CHASSIS_ID_MAC_ADDRESS = 4;
+constexpr std::array<uint8_t, 5> CHASSIS_ID_TEXTUAL{1 /* chassis component */, 2 /* interface alias */, 3 /* port component */, 6 /* interface name */, 7 /* locally assigned */};
+constexpr uint8_t PORT_ID_MAC_ADDRESS = 3;
+constexpr std::array<uint8_t, 4> PORT_ID_TEXTUAL{1 /* interface alias */, 2 /* port component */, 5 /* interface name */, 7 /* locally assigned */};
+
+struct LLDPDU {
+    std::string chassisId;
+    std::string portId;
+    std::chrono::seconds ttl;
+    std::optional<std::string> systemName;
+    std::optional<uint16_t> enabledCapabilities;
+};
+
+packet_mreq lldpMembership(int ifindex)
+{
+    packet_mreq mreq{};
+    mreq.mr_ifindex = ifindex;
+    mreq.mr_type = PACKET_MR_MULTICAST;
+    mreq.mr_alen = ETH_ALEN;
+    std::memcpy(mreq.mr_address, LLDP_MULTICAST_ADDRESS.data(), ETH_ALEN);
+    return mreq;
+}
+
+/** @brief Formats a chassis or port ID similarly to systemd-networkd: MAC addresses and printable strings as they are, hex dump otherwise */
+std::string idToString(std::span<const uint8_t> tlv, uint8_t macSubtype, std::span<const uint8_t> textualSubtypes)
+{
+    const auto subtype = tlv[0];
+    const auto id = tlv.subspan(1);
+
+    if (subtype == macSubtype && id.size() == ETH_ALEN) {
+        return fmt::format("{:02x}:{:02x}:{:02x}:{:02x}:{:02x}:{:02x}", id[0], id[1], id[2], id[3], id[4], id[5]);
+    }
+
+    if (std::ranges::find(textualSubtypes, subtype) != textualSubtypes.end()
+        && std::ranges::all_of(id, [](uint8_t c) { return c >= 0x20 && c < 0x7f; })) {
+        return {id.begin(), id.end()};
+    }
+
+    std::string res;
+    for (auto byte : id) {
+        res += fmt::format("{:02x}", byte);
+    }
+    return res;
+}
+
+uint16_t readUint16(std::span<const uint8_t> data)
+{
+    return (data[0] << 8) | data[1];
+}
+
+/** @brief Parses the LLDPDU from an ethernet frame. Returns nullopt if the LLDPDU is invalid, e.g., when a mandatory TLV is missing. */
+std::optional<LLDPDU> parseLLDPDU(std::span<const uint8_t> frame)
+{
+    constexpr size_t ETH_HEADER_SIZE = 2 * ETH_ALEN + 2;
+    if (frame.size() < ETH_HEADER_SIZE || readUint16(frame.subspan(2 * ETH_ALEN)) != ETH_P_LLDP) {
+        return std::nullopt;
+    }
+
+    std::optional<std::string> chassisId, portId, systemName;
+    std::optional<std::chrono::seconds> ttl;
+    std::optional<uint16_t> enabledCapabilities;
+
+    // the first three TLVs are mandatory and their order is fixed
+    auto data = frame.subspan(ETH_HEADER_SIZE);
+    for (unsigned index = 0; data.size() >= 2; ++index) {
+        const auto header = readUint16(data);
+        const uint8_t type = header >> 9;
+        const size_t length = header & 0x1ff;
+        if (data.size() < 2 + length) {
+            return std::nullopt;
+        }
+
+        const auto value = data.subspan(2, length);
+        data = data.subspan(2 + length);
+
+        if (type == TLV_END) {
+            break;
+        } else if (index == 0) {
+            if (type != TLV_CHASSIS_ID || length < 2) {
+                return std::nullopt;
+            }
+            chassisId = idToString(value, CHASSIS_ID_MAC_ADDRESS, CHASSIS_ID_TEXTUAL);
+        } else if (index == 1) {
+            if (type != TLV_PORT_ID || length < 2) {
+                return std::nullopt;
+            }
+            portId = idToString(value, PORT_ID_MAC_ADDRESS, PORT_ID_TEXTUAL);
+        } else if (index == 2) {
+            if (type != TLV_TTL || length < 2) {
+                return std::nullopt;
+            }
+            ttl = std::chrono::seconds{readUint16(value)};
+        } else if (type == TLV_SYSTEM_NAME) {
+            systemName = std::string{value.begin(), value.end()};
+        } else if (type == TLV_SYSTEM_CAPABILITIES && length == 4) {
+            enabledCapabilities = readUint16(value.subspan(2));
+        }
+    }
+
+    if (!chassisId || !portId || !ttl) {
+        return std::nullopt;
+    }
+
+    return LLDPDU{*chassisId, *portId, *ttl, systemName, enabledCapabilities};
+}
+}
+
+namespace velia::network {
+
+LLDPListener::LLDPListener(const std::vector<std::string>& links)
+    : m_log(spdlog::get("network"))
+    , m_fd(-1)
+    , m_ring(nullptr)
+    , m_blockSize(RING_BLOCK_SIZE)
+    , m_blockCount(RING_BLOCK_COUNT)
+    , m_currentBlock(0)
+    , m_terminateFd(-1)
+{
+    for (const auto& name : links) {
+        if (auto ifindex = if_nametoindex(name.c_str()); ifindex != 0) {
+            m_links.emplace(ifindex, name);
+        } else {
+            m_log->warn("LLDP: link {} does not exist, ignoring it", name);
+        }
+    }
+
+    // no protocol yet, so that nothing is received before the filter and the ring are in place
+    m_fd = socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        throw std::system_error(errno, std::system_category(), "LLDPListener: socket");
+    }
+
+    try {
+        std::array<sock_filter, 4> filter{{
+            BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 2 * ETH_ALEN), // ethertype
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_LLDP, 0, 1),
+            BPF_STMT(BPF_RET | BPF_K, 0xffff),
+            BPF_STMT(BPF_RET | BPF_K, 0),
+        }};
+        sock_fprog program{.len = static_cast<unsigned short>(filter.size()), .filter = filter.data()};
+        if (setsockopt(m_fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0) {
+            throw std::system_error(errno, std::system_category(), "LLDPListener: SO_ATTACH_FILTER");
+        }
+
+        int version = TPACKET_V3;
+        if (setsockopt(m_fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+            throw std::system_error(errno, std::system_category(), "LLDPListener: PACKET_VERSION");
+        }
+
+        tpacket_req3 req{};
+        req.tp_block_size = m_blockSize;
+        req.tp_block_nr = m_blockCount;
+        req.tp_frame_size = RING_FRAME_SIZE;
+        req.tp_frame_nr = m_blockSize * m_blockCount / RING_FRAME_SIZE;
+        req.tp_retire_blk_tov = RING_BLOCK_TIMEOUT_MS;
+        if (setsockopt(m_fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+            throw std::system_error(errno, std::system_category(), "LLDPListener: PACKET_RX_RING");
+        }
+
+        auto ring = mmap(nullptr, m_blockSize * m_blockCount, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, m_fd, 0);
+        if (ring == MAP_FAILED) {
+            // MAP_LOCKED can fail because of RLIMIT_MEMLOCK, and it's only nice to have
+            ring = mmap(nullptr, m_blockSize * m_blockCount, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        }
+        if (ring == MAP_FAILED) {
+            throw std::system_error(errno, std::system_category(), "LLDPListener: mmap");
+        }
+        m_ring = static_cast<uint8_t*>(ring);
+
+        for (const auto& [ifindex, name] : m_links) {
+            joinMulticastGroup(ifindex, name);
+        }
+
+        sockaddr_ll addr{};
+        addr.sll_family = AF_PACKET;
+        addr.sll_protocol = htons(ETH_P_LLDP);
+        addr.sll_ifindex = 0; // all links, the unmanaged ones are skipped later
+        if (bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw std::system_error(errno, std::system_category(), "LLDPListener: bind");
+        }
+
+        m_terminateFd = eventfd(0, EFD_CLOEXEC);
+        if (m_terminateFd < 0) {
+            throw std::system_error(errno, std::system_category(), "LLDPListener: eventfd");
+        }
+    } catch (...) {
+        if (m_ring) {
+            munmap(m_ring, m_blockSize * m_blockCount);
+        }
+        ::close(m_fd);
+        throw;
+    }
+
+    m_thread = std::thread(&LLDPListener::run, this);
+}
+
+LLDPListener::~LLDPListener()
+{
+    uint64_t one = 1;
+    if (::write(m_terminateFd, &one, sizeof(one)) != sizeof(one)) {
+        // there is no way how to recover from this, and a thread which cannot be joined would crash the process anyway
+        std::terminate();
+    }
+    m_thread.join();
+    ::close(m_terminateFd);
+    munmap(m_ring, m_blockSize * m_blockCount);
+    ::close(m_fd);
+}
+
+void LLDPListener::run()
+{
+    std::array<pollfd, 2> fds{{
+        {.fd = m_fd, .events = POLLIN, .revents = 0},
+        {.fd = m_terminateFd, .events = POLLIN, .revents = 0},
+    }};
+
+    while (true) {
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            m_log->error("LLDP: poll failed: {}", std::strerror(errno));
+            return;
+        }
+
+        if (fds[1].revents) {
+            return;
+        }
+
+        while (true) {
+            auto* block = reinterpret_cast<tpacket_block_desc*>(m_ring + m_currentBlock * m_blockSize);
+            if (!(std::atomic_ref(block->hdr.bh1.block_status).load(std::memory_order_acquire) & TP_STATUS_USER)) {
+                break;
+            }
+
+            processBlock(reinterpret_cast<uint8_t*>(block));
+
+            std::atomic_ref(block->hdr.bh1.block_status).store(TP_STATUS_KERNEL, std::memory_order_release);
+            m_currentBlock = (m_currentBlock + 1) % m_blockCount;
+        }
+    }
+}
+
+void LLDPListener::processBlock(uint8_t* block)
+{
+    const auto& desc = reinterpret_cast<tpacket_block_desc*>(block)->hdr.bh1;
+
+    auto* packet = block + desc.offset_to_first_pkt;
+    for (uint32_t i = 0; i < desc.num_pkts; ++i) {
+        const auto* hdr = reinterpret_cast<tpacket3_hdr*>(packet);
+        const auto* sll = reinterpret_cast<sockaddr_ll*>(packet + TPACKET_ALIGN(sizeof(tpacket3_hdr)));
+
+        if (sll->sll_pkttype != PACKET_OUTGOING) {
+            processFrame(sll->sll_ifindex, {packet + hdr->tp_mac, hdr->tp_snaplen});
+        }
+
+        packet += hdr->tp_next_offset;
+    }
+}
+
+void LLDPListener::processFrame(int ifindex, std::span<const uint8_t> frame)
+{
+    std::lock_guard lock(m_mtx);
+
+    auto link = m_links.find(ifindex);
+    if (link == m_links.end()) {
+        return;
+    }
+
+    auto lldpdu = parseLLDPDU(frame);
+    if (!lldpdu) {
+        m_log->debug("LLDP: discarding an invalid LLDPDU received on {}", link->second);
+        return;
+    }
+
+    Key key{ifindex, lldpdu->chassisId, lldpdu->portId};
+
+    if (lldpdu->ttl == std::chrono::seconds::zero()) {
+        m_log->debug("LLDP: neighbor {}/{} on {} is shutting down", lldpdu->chassisId, lldpdu->portId, link->second);
+        m_neighbors.erase(key);
+        return;
+    }
+
+    m_log->trace("LLDP: neighbor {}/{} on {}, TTL {}s", lldpdu->chassisId, lldpdu->portId, link->second, lldpdu->ttl.count());
+    m_neighbors.insert_or_assign(key, Entry{
+        .neighbor = LLDPNeighbor{
+            .linkName = link->second,
+            .chassisId = lldpdu->chassisId,
+            .portId = lldpdu->portId,
+            .systemName = lldpdu->systemName,
+            .enabledCapabilities = lldpdu->enabledCapabilities,
+        },
+        .expiry = std::chrono::steady_clock::now() + lldpdu->ttl,
+    });
+}
+
+/** @brief LLDP uses a link-local multicast address which the NICs drop unless asked not to */
+void LLDPListener::joinMulticastGroup(int ifindex, const std::string& name)
+{
+    auto mreq = lldpMembership(ifindex);
+    if (setsockopt(m_fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        m_log->warn("LLDP: cannot join the LLDP multicast group on {}: {}", name, std::strerror(errno));
+    }
+}
+
+/** @brief Stops receiving the LLDP multicast on a link which is no longer listened to */
+void LLDPListener::leaveMulticastGroup(int ifindex, const std::string& name)
+{
+    auto mreq = lldpMembership(ifindex);
+    if (setsockopt(m_fd, SOL_PACKET, PACKET_DROP_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        // the kernel has already dropped the membership if the link is gone
+        m_log->debug("LLDP: cannot leave the LLDP multicast group on {}: {}", name, std::strerror(errno));
+    }
+}
+
+/** @brief Changes the set of links to listen on. Neighbors on the links which are no longer listened to are forgotten. */
+void LLDPListener::setLinks(const std::vector<std::string>& links)
+{
+    std::map<int, std::string> newLinks;
+    for (const auto& name : links) {
+        if (auto ifindex = if_nametoindex(name.c_str()); ifindex != 0) {
+            newLinks.emplace(ifindex, name);
+        } else {
+            m_log->warn("LLDP: link {} does not exist, ignoring it", name);
+        }
+    }
+
+    std::lock_guard lock(m_mtx);
+    for (const auto& [ifindex, name] : m_links) {
+        if (!newLinks.contains(ifindex)) {
+            leaveMulticastGroup(ifindex, name);
+        }
+    }
+    for (const auto& [ifindex, name] : newLinks) {
+        // the membership is dropped by the kernel when the link disappears, and a renamed link keeps its ifindex
+        if (!m_links.contains(ifindex)) {
+            joinMulticastGroup(ifindex, name);
+        }
+    }
+    std::erase_if(m_neighbors, [&newLinks](const auto& entry) {
+        auto link = newLinks.find(entry.first.ifindex);
+        return link == newLinks.end() || link->second != entry.second.neighbor.linkName;
+    });
+    m_links = std::move(newLinks);
+}
+
+/** @brief All neighbors whose TTL has not expired yet */
+std::vector<LLDPNeighbor> LLDPListener::neighbors() const
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<LLDPNeighbor> res;
+
+    std::lock_guard lock(m_mtx);
+    std::erase_if(m_neighbors, [now](const auto& entry) { return entry.second.expiry <= now; });
+    for (const auto& [key, entry] : m_neighbors) {
+        res.emplace_back(entry.neighbor);
+    }
+    return res;
+}
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/log-fwd.h"
+
+namespace velia::network {
+
+/** @brief What a neighbor announced in its last LLDPDU */
+struct LLDPNeighbor {
+    std::string linkName; ///< the local link on which the LLDPDU arrived
+    std::string chassisId;
+    std::string portId;
+    std::optional<std::string> systemName;
+    std::optional<uint16_t> enabledCapabilities;
+
+    bool operator==(const LLDPNeighbor&) const = default;
+};
+
+/** @brief Receives LLDP frames on the given links and keeps a table of the neighbors
+ *
+ * The frames are captured by an AF_PACKET socket with a BPF filter for the LLDP ethertype, through a TPACKET_V3 ring which is
+ * processed by a background thread. Each neighbor stays in the table until its TTL expires, or until it sends a shutdown LLDPDU.
+ * Links which do not exist when the listener is created are ignored.
+ */
+class LLDPListener {
+public:
+    explicit LLDPListener(const std::vector<std::string>& links);
+    ~LLDPListener();
+    LLDPListener(const LLDPListener&) = delete;
+    LLDPListener& operator=(const LLDPListener&) = delete;
+
+    std::vector<LLDPNeighbor> neighbors() const;
+    void setLinks(const std::vector<std::string>& links);
+
+private:
+    void run();
+    void processBlock(uint8_t* block);
+    void processFrame(int ifindex, std::span<const uint8_t> frame);
+    void joinMulticastGroup(int ifindex, const std::string& name);
+    void leaveMulticastGroup(int ifindex, const std::string& name);
+
+    /** @brief MSAP identifier, i.e., what identifies a neighbor in IEEE 802.1AB */
+    struct Key {
+        int ifindex;
+        std::string chassisId;
+        std::string portId;
+
+        auto operator<=>(const Key&) const = default;
+    };
+
+    struct Entry {
+        LLDPNeighbor neighbor;
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    velia::Log m_log;
+    int m_fd;
+    uint8_t* m_ring;
+    size_t m_blockSize;
+    size_t m_blockCount;
+    size_t m_currentBlock;
+    int m_terminateFd;
+
+    mutable std::mutex m_mtx; ///< protects m_links and m_neighbors
+    std::map<int, std::string> m_links; ///< ifindex -> name
+    mutable std::map<Key, Entry> m_neighbors;
+
+    std::thread m_thread;
+};
+}
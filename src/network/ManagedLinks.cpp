@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <algorithm>
+#include <fmt/ranges.h>
+#include <sdbus-c++/sdbus-c++.h>
+#include "ManagedLinks.h"
+#include "NetworkctlUtils.h"
+#include "utils/log.h"
+
+namespace {
+const auto NETWORK1_OBJECT_PATH = "/org/freedesktop/network1";
+const auto NETWORK1_MANAGER_INTERFACE = "org.freedesktop.network1.Manager";
+}
+
+namespace velia::network {
+
+ManagedLinksMonitor::ManagedLinksMonitor(sdbus::IConnection& connection, const std::string& busName, const std::vector<std::string>& managedLinks, std::chrono::milliseconds quietPeriod, std::chrono::milliseconds maxDelay)
+    : m_log(spdlog::get("network"))
+    , m_proxy(sdbus::createProxy(connection, busName, NETWORK1_OBJECT_PATH))
+    , m_managedLinks(managedLinks)
+    , m_debouncer([this]() { refresh(); }, quietPeriod, maxDelay)
+{
+    std::ranges::sort(m_managedLinks);
+}
+
+ManagedLinksMonitor::~ManagedLinksMonitor() = default;
+
+/** @brief Schedules a check of the managed links. The check happens once the notifications stop coming for a while. */
+void ManagedLinksMonitor::linksChanged()
+{
+    m_debouncer.trigger();
+}
+
+/** @brief Registers a callback to be invoked when the set of the managed links changes. Pass an empty callback to unregister. */
+void ManagedLinksMonitor::onChange(change_cb_t callback)
+{
+    std::lock_guard lock(m_mtx);
+    m_callback = std::move(callback);
+}
+
+std::vector<std::string> ManagedLinksMonitor::managedLinks() const
+{
+    std::lock_guard lock(m_mtx);
+    return m_managedLinks;
+}
+
+void ManagedLinksMonitor::refresh()
+{
+    try {
+        // this is what `networkctl list --json=short` prints
+        std::string statusJson;
+        m_proxy->callMethod("Describe").onInterface(NETWORK1_MANAGER_INTERFACE).storeResultsTo(statusJson);
+        auto states = linkAdministrativeStates(statusJson);
+
+        std::lock_guard lock(m_mtx);
+
+        std::vector<std::string> managedLinks;
+        bool undecided = false;
+        for (const auto& [name, state] : states) {
+            if (state == "pending" || state == "initialized") {
+                // systemd-networkd has not decided whether it manages this link yet, so let's keep what we know and ask again later
+                undecided = true;
+                if (std::ranges::binary_search(m_managedLinks, name)) {
+                    managedLinks.emplace_back(name);
+                }
+            } else if (state != "unmanaged") {
+                managedLinks.emplace_back(name);
+            }
+        }
+
+        if (undecided) {
+            m_debouncer.trigger();
+        }
+
+        if (managedLinks == m_managedLinks || !m_callback) {
+            return;
+        }
+
+        m_log->info("Links managed by systemd-networkd changed to {}", managedLinks);
+        m_managedLinks = std::move(managedLinks);
+        m_callback(m_managedLinks);
+    } catch (const std::exception& e) {
+        m_log->error("Cannot determine the links managed by systemd-networkd: {}", e.what());
+    }
+}
+}
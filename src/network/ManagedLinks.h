@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "utils/debounce.h"
+#include "utils/log-fwd.h"
+
+namespace sdbus {
+class IConnection;
+class IProxy;
+}
+
+namespace velia::network {
+
+/** @brief Keeps track of the links which are managed by systemd-networkd
+ *
+ * Whenever a link appears, disappears or gets renamed, call linksChanged(). The current state is then fetched via the
+ * org.freedesktop.network1.Manager D-Bus interface, once the burst of the notifications settles down. A link which
+ * systemd-networkd has not finished setting up yet keeps its previous status, and the state is fetched again later.
+ * The callback registered via onChange() is invoked with the new list of the managed links whenever that list changes.
+ */
+class ManagedLinksMonitor {
+public:
+    using change_cb_t = std::function<void(const std::vector<std::string>& managedLinks)>;
+    ManagedLinksMonitor(sdbus::IConnection& connection, const std::string& busName, const std::vector<std::string>& managedLinks, std::chrono::milliseconds quietPeriod = std::chrono::milliseconds{500}, std::chrono::milliseconds maxDelay = std::chrono::seconds{5});
+    ~ManagedLinksMonitor();
+
+    void linksChanged();
+    void onChange(change_cb_t callback);
+    std::vector<std::string> managedLinks() const;
+
+private:
+    void refresh();
+
+    velia::Log m_log;
+    std::unique_ptr<sdbus::IProxy> m_proxy;
+    mutable std::mutex m_mtx; ///< protects m_managedLinks and m_callback
+    std::vector<std::string> m_managedLinks;
+    change_cb_t m_callback;
+    utils::Debouncer m_debouncer; ///< first to destroy, its thread uses everything above
+};
+}
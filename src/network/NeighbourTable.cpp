@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "NeighbourTable.h"
+
+namespace velia::network {
+
+void NeighbourTable::set(int ifindex, int family, const std::string& ip, const std::string& linkLayerAddress)
+{
+    m_neighbours.insert_or_assign(Key{ifindex, family, ip}, linkLayerAddress);
+}
+
+void NeighbourTable::remove(int ifindex, int family, const std::string& ip)
+{
+    m_neighbours.erase(Key{ifindex, family, ip});
+}
+
+void NeighbourTable::removeLink(int ifindex)
+{
+    // the keys are ordered by ifindex first, and no family is smaller than AF_UNSPEC
+    auto it = m_neighbours.lower_bound(Key{ifindex, 0, {}});
+    while (it != m_neighbours.end() && it->first.ifindex == ifindex) {
+        it = m_neighbours.erase(it);
+    }
+}
+
+/** @brief Neighbours of the given address family on the given link */
+std::vector<NeighbourTable::Neighbour> NeighbourTable::neighbours(int ifindex, int family) const
+{
+    std::vector<Neighbour> res;
+    for (auto it = m_neighbours.lower_bound(Key{ifindex, family, {}}); it != m_neighbours.end() && it->first.ifindex == ifindex && it->first.family == family; ++it) {
+        res.push_back({it->first.ip, it->second});
+    }
+    return res;
+}
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace velia::network {
+
+/** @brief In-memory copy of the IP neighbours (ARP and NDP caches) of all links
+ *
+ * The table is maintained from the individual netlink neighbour events, so that reading it does not require any netlink dumps.
+ */
+class NeighbourTable {
+public:
+    struct Neighbour {
+        std::string ip;
+        std::string linkLayerAddress;
+
+        bool operator==(const Neighbour&) const = default;
+    };
+
+    void set(int ifindex, int family, const std::string& ip, const std::string& linkLayerAddress);
+    void remove(int ifindex, int family, const std::string& ip);
+    void removeLink(int ifindex);
+    std::vector<Neighbour> neighbours(int ifindex, int family) const;
+
+private:
+    struct Key {
+        int ifindex;
+        int family;
+        std::string ip;
+
+        auto operator<=>(const Key&) const = default;
+    };
+
+    std::map<Key, std::string> m_neighbours; ///< the link-layer addresses
+};
+}
@@ -3,13 +3,39 @@
 #include "network/NetworkctlUtils.h"
 #include "utils/log.h"
 
+namespace {
+
+/* The members of `networkctl list --json` which we use: {"Interfaces": [{"Name": ..., "AdministrativeState": ..., "LLDP": {"ChassisID": ...}}]} */
+const std::map<int, std::set<std::string>> INTERFACES_ADMINISTRATIVE_STATE{{1, {"Interfaces"}}, {3, {"Name", "AdministrativeState"}}};
+const std::map<int, std::set<std::string>> INTERFACES_NETWORK_FILES{{1, {"Interfaces"}}, {3, {"Name", "NetworkFile", "NetworkFileDropins"}}};
+const std::map<int, std::set<std::string>> INTERFACES_LLDP_CHASSIS_ID{{1, {"Interfaces"}}, {3, {"LLDP"}}, {4, {"ChassisID"}}};
+}
+
 namespace velia::network {
 
+/** @brief Parses JSON, keeping only those object members whose names are listed for their nesting depth
+ *
+ * The output of networkctl has dozens of members for each link, and we only ever need a few of them. Everything else is just scanned
+ * through, without being stored in the resulting DOM. The depth of a member is the number of objects and arrays that enclose it, i.e.,
+ * the members of the top-level object are at depth 1. Members at depths which are not listed in @p keysByDepth are all kept.
+ */
+nlohmann::json parseSelectedMembers(const std::string& jsonData, const std::map<int, std::set<std::string>>& keysByDepth)
+{
+    return nlohmann::json::parse(jsonData, [&keysByDepth](int depth, nlohmann::json::parse_event_t event, nlohmann::json& parsed) {
+        if (event != nlohmann::json::parse_event_t::key) {
+            return true;
+        }
+
+        auto it = keysByDepth.find(depth);
+        return it == keysByDepth.end() || it->second.contains(parsed.get_ref<const std::string&>());
+    });
+}
+
 /** @brief Expects JSON produced by `networkctl list --json=pretty|short` and returns a list of managed links by systemd-networkd. */
 std::vector<std::string> systemdNetworkdManagedLinks(const std::string& jsonData)
 {
     auto log = spdlog::get("network");
-    auto json = nlohmann::json::parse(jsonData);
+    auto json = parseSelectedMembers(jsonData, INTERFACES_ADMINISTRATIVE_STATE);
     std::vector<std::string> managedInterfaces;
 
     for (const auto& link : json["Interfaces"]) {
@@ -27,12 +53,25 @@ std::vector<std::string> systemdNetworkdManagedLinks(const std::string& jsonData
     return managedInterfaces;
 }
 
+/** @brief Expects JSON produced by `networkctl list --json=pretty|short` and returns the administrative state of each link. */
+std::map<std::string, std::string> linkAdministrativeStates(const std::string& jsonData)
+{
+    auto json = parseSelectedMembers(jsonData, INTERFACES_ADMINISTRATIVE_STATE);
+    std::map<std::string, std::string> states;
+
+    for (const auto& link : json["Interfaces"]) {
+        states[link.at("Name").get<std::string>()] = link.at("AdministrativeState").get<std::string>();
+    }
+
+    return states;
+}
+
 /** @brief Returns a map of link names to their configuration files for the set links.
  */
 std::map<std::string, NetworkConfFiles> linkConfigurationFiles(const std::string& jsonData, std::set<std::string> managedInterfaces)
 {
     auto log = spdlog::get("network");
-    auto json = nlohmann::json::parse(jsonData);
+    auto json = parseSelectedMembers(jsonData, INTERFACES_NETWORK_FILES);
     std::map<std::string, NetworkConfFiles> result;
 
     for (const auto& link : json["Interfaces"]) {
@@ -67,7 +106,7 @@ std::map<std::string, NetworkConfFiles> linkConfigurationFiles(const std::string
 /** @brief Expects JSON produced by `networkctl list --json=pretty|short` and returns the chassis ID of the local machine as seen by LLDP. */
 std::string getLocalChassisId(const std::string& jsonData)
 {
-    nlohmann::json data = nlohmann::json::parse(jsonData);
+    nlohmann::json data = parseSelectedMembers(jsonData, INTERFACES_LLDP_CHASSIS_ID);
 
     // As of systemd 258, the LLDP chassis ID is included in the "LLDP" section of each LLDP-enabled interface
     for (const auto& interface: data["Interfaces"]) {
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <map>
+#include <nlohmann/json_fwd.hpp>
 #include <optional>
 #include <set>
 #include <string>
@@ -9,7 +10,10 @@
 
 namespace velia::network {
 
+nlohmann::json parseSelectedMembers(const std::string& jsonData, const std::map<int, std::set<std::string>>& keysByDepth);
+
 std::vector<std::string> systemdNetworkdManagedLinks(const std::string& jsonData);
+std::map<std::string, std::string> linkAdministrativeStates(const std::string& jsonData);
 
 struct NetworkConfFiles {
     std::optional<std::filesystem::path> networkFile;
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <algorithm>
+#include <sdbus-c++/sdbus-c++.h>
+#include "NetworkdReload.h"
+#include "NetworkctlUtils.h"
+#include "utils/log.h"
+
+using namespace std::string_literals;
+
+namespace {
+const auto NETWORK1_OBJECT_PATH = "/org/freedesktop/network1";
+const auto NETWORK1_MANAGER_INTERFACE = "org.freedesktop.network1.Manager";
+}
+
+namespace velia::network {
+
+NetworkdReload::NetworkdReload(sdbus::IConnection& connection, const std::string& busName, const std::set<std::string>& managedLinks, const std::vector<std::filesystem::path>& configDirectories, std::chrono::milliseconds quietPeriod, std::chrono::milliseconds maxDelay)
+    : m_log(spdlog::get("network"))
+    , m_proxy(sdbus::createProxy(connection, busName, NETWORK1_OBJECT_PATH))
+    , m_managedLinks(managedLinks)
+    , m_configDirectories(configDirectories)
+    , m_debouncer([this]() { reload(); }, quietPeriod, maxDelay)
+{
+}
+
+NetworkdReload::~NetworkdReload() = default;
+
+/** @brief Schedules a reload. The reload happens once the requests stop coming for a while. */
+void NetworkdReload::request()
+{
+    m_debouncer.trigger();
+}
+
+void NetworkdReload::setManagedLinks(const std::set<std::string>& managedLinks)
+{
+    std::lock_guard lock(m_mtx);
+    m_managedLinks = managedLinks;
+}
+
+void NetworkdReload::reload()
+{
+    std::set<std::string> managedLinks;
+    {
+        std::lock_guard lock(m_mtx);
+        managedLinks = m_managedLinks;
+    }
+
+    try {
+        /* In 2021, executing 'networkctl reload' was not enough. For bridge interfaces, we had to also bring the interface down and up.
+         * As of 5/2025, it seems that bare 'networkctl reload' is sufficient.
+         * Manpage of networkctl says that reload should be enough except for few cases (like changing VLANs etc.), but they said that in 2021 too.
+         * */
+        m_log->debug("Reloading systemd-networkd configuration");
+        m_proxy->callMethod("Reload").onInterface(NETWORK1_MANAGER_INTERFACE);
+
+        // this is what `networkctl status --json=short` prints
+        std::string statusJson;
+        m_proxy->callMethod("Describe").onInterface(NETWORK1_MANAGER_INTERFACE).storeResultsTo(statusJson);
+
+        for (const auto& [linkName, confFiles] : linkConfigurationFiles(statusJson, managedLinks)) {
+            const std::string confFilename = "10-"s + linkName + ".network";
+
+            if (!confFiles.networkFile) {
+                m_log->error("Did not find a configuration file for systemd-networkd managed link {}", linkName);
+            } else if (std::ranges::none_of(m_configDirectories, [&](const auto& dir) { return *confFiles.networkFile == dir / confFilename; })) {
+                m_log->error("Unexpected configuration file for link {}: {}", linkName, confFiles.networkFile->string());
+            }
+
+            if (!confFiles.dropinFiles.empty()) {
+                m_log->error("Unexpected drop-in configuration files for link {}", linkName);
+            }
+        }
+    } catch (const std::exception& e) {
+        m_log->error("Cannot reload systemd-networkd configuration: {}", e.what());
+    }
+}
+}
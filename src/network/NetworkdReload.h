@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "utils/debounce.h"
+#include "utils/log-fwd.h"
+
+namespace sdbus {
+class IConnection;
+class IProxy;
+}
+
+namespace velia::network {
+
+/** @brief Asks systemd-networkd to reload its configuration, coalescing bursts of requests into a single reload
+ *
+ * The reload is requested via the org.freedesktop.network1.Manager D-Bus interface. Once it finishes, the configuration files
+ * which systemd-networkd uses for each of the managed links are checked. Those should be our 10-<link>.network files from one of
+ * the @p configDirectories, without any drop-ins.
+ */
+class NetworkdReload {
+public:
+    NetworkdReload(sdbus::IConnection& connection, const std::string& busName, const std::set<std::string>& managedLinks, const std::vector<std::filesystem::path>& configDirectories, std::chrono::milliseconds quietPeriod = std::chrono::milliseconds{200}, std::chrono::milliseconds maxDelay = std::chrono::seconds{2});
+    ~NetworkdReload();
+
+    void request();
+    void setManagedLinks(const std::set<std::string>& managedLinks);
+
+private:
+    void reload();
+
+    velia::Log m_log;
+    std::unique_ptr<sdbus::IProxy> m_proxy;
+    std::mutex m_mtx; ///< protects m_managedLinks
+    std::set<std::string> m_managedLinks;
+    std::vector<std::filesystem::path> m_configDirectories;
+    utils::Debouncer m_debouncer; ///< first to destroy, its thread uses everything above
+};
+}
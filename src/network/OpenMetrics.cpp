@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "OpenMetrics.h"
+#include "utils/io.h"
+#include "utils/log.h"
+#include "utils/openmetrics.h"
+
+namespace {
+
+using velia::network::LinkCounters;
+
+struct Counter {
+    std::string name;
+    rtnl_link_stat_id_t stat;
+    uint64_t LinkCounters::*member;
+    std::string help;
+};
+
+const std::vector<Counter> COUNTERS{
+    {"velia_interface_in_octets_total", RTNL_LINK_RX_BYTES, &LinkCounters::inOctets, "Total number of octets received on the interface."},
+    {"velia_interface_out_octets_total", RTNL_LINK_TX_BYTES, &LinkCounters::outOctets, "Total number of octets transmitted out of the interface."},
+    {"velia_interface_in_packets_total", RTNL_LINK_RX_PACKETS, &LinkCounters::inPackets, "Total number of packets received on the interface."},
+    {"velia_interface_out_packets_total", RTNL_LINK_TX_PACKETS, &LinkCounters::outPackets, "Total number of packets transmitted out of the interface."},
+    {"velia_interface_in_discards_total", RTNL_LINK_RX_DROPPED, &LinkCounters::inDiscards, "Number of inbound packets which were discarded."},
+    {"velia_interface_out_discards_total", RTNL_LINK_TX_DROPPED, &LinkCounters::outDiscards, "Number of outbound packets which were discarded."},
+    {"velia_interface_in_errors_total", RTNL_LINK_RX_ERRORS, &LinkCounters::inErrors, "Number of inbound packets that contained errors."},
+    {"velia_interface_out_errors_total", RTNL_LINK_TX_ERRORS, &LinkCounters::outErrors, "Number of outbound packets that could not be transmitted because of errors."},
+};
+}
+
+namespace velia::network {
+
+/** @short Reads the counters of all links from the link cache */
+std::vector<LinkCounters> collectLinkCounters(Rtnetlink& rtnetlink)
+{
+    std::vector<LinkCounters> links;
+    rtnetlink.forEachLink([&links](rtnl_link* link) {
+        auto& counters = links.emplace_back(LinkCounters{.name = rtnl_link_get_name(link)});
+        for (const auto& counter : COUNTERS) {
+            counters.*counter.member = rtnl_link_get_stat(link, counter.stat);
+        }
+    });
+    return links;
+}
+
+/** @short Renders the counters of all @p links as a Prometheus text format document, grouped by the counter */
+std::string renderOpenMetrics(const std::vector<LinkCounters>& links)
+{
+    utils::openmetrics::Builder builder;
+
+    for (const auto& counter : COUNTERS) {
+        builder.family(counter.name, "counter", counter.help);
+        for (const auto& link : links) {
+            builder.sample(counter.name, {{"interface", link.name}}, link.*counter.member);
+        }
+    }
+
+    return builder.str();
+}
+
+OpenMetricsExporter::OpenMetricsExporter(std::shared_ptr<Rtnetlink> rtnetlink, std::filesystem::path filename, std::chrono::milliseconds interval)
+    : m_log(spdlog::get("network"))
+    , m_rtnetlink(std::move(rtnetlink))
+    , m_filename(std::move(filename))
+    , m_task([this]() { exportOnce(); }, interval)
+{
+}
+
+void OpenMetricsExporter::exportOnce()
+{
+    try {
+        utils::replaceFile(m_filename, renderOpenMetrics(collectLinkCounters(*m_rtnetlink)));
+    } catch (const std::exception& e) {
+        m_log->warn("Cannot write OpenMetrics export to {}: {}", m_filename.string(), e.what());
+    }
+}
+}
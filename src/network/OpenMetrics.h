@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include "network/Rtnetlink.h"
+#include "utils/log-fwd.h"
+#include "utils/periodic.h"
+
+namespace velia::network {
+
+/** @short Traffic counters of a single link */
+struct LinkCounters {
+    std::string name;
+    uint64_t inOctets, outOctets;
+    uint64_t inPackets, outPackets;
+    uint64_t inDiscards, outDiscards;
+    uint64_t inErrors, outErrors;
+};
+
+std::vector<LinkCounters> collectLinkCounters(Rtnetlink& rtnetlink);
+std::string renderOpenMetrics(const std::vector<LinkCounters>& links);
+
+/** @short Periodically exports interface statistics into a file in the Prometheus text format
+ *
+ * The statistics are the same ones which IETFInterfaces publishes under /ietf-interfaces:interfaces/interface/statistics.
+ * The file is meant to be picked up by the textfile collector of the Prometheus node_exporter. It is replaced atomically, but it
+ * is not synced to the disk because it is rewritten all the time.
+ */
+class OpenMetricsExporter {
+public:
+    OpenMetricsExporter(std::shared_ptr<Rtnetlink> rtnetlink, std::filesystem::path filename, std::chrono::milliseconds interval);
+
+private:
+    void exportOnce();
+
+    velia::Log m_log;
+    std::shared_ptr<Rtnetlink> m_rtnetlink;
+    std::filesystem::path m_filename;
+    utils::PeriodicTask m_task; // last, so that the background export stops before the rest is destroyed
+};
+}
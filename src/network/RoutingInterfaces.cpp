@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <arpa/inet.h>
+#include <array>
+#include "RoutingInterfaces.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+const auto IETF_ROUTING = "/ietf-routing:routing"s;
+
+std::string interfaceXPath(const std::string& name)
+{
+    return IETF_ROUTING + "/interfaces/interface[.='" + name + "']";
+}
+
+bool isPublished(const std::optional<std::string>& name, const std::set<std::pair<int, std::string>>& addresses)
+{
+    return name && !addresses.empty();
+}
+}
+
+namespace velia::network {
+
+RoutingInterfaces::RoutingInterfaces(bool publishRouterId)
+    : m_publishRouterId(publishRouterId)
+{
+}
+
+/** @brief Tracks the name of a link. Pass std::nullopt as a name when the link disappears. */
+RoutingInterfaces::Changes RoutingInterfaces::updateLink(int ifindex, const std::optional<std::string>& name)
+{
+    Changes res;
+    auto it = m_links.find(ifindex);
+
+    if (!name) {
+        if (it == m_links.end()) {
+            return res;
+        }
+
+        // the kernel removes the addresses as well, but the order of these notifications is not guaranteed
+        if (isPublished(it->second.name, it->second.addresses)) {
+            res.removals.emplace_back(interfaceXPath(*it->second.name));
+        }
+        for (const auto& address : it->second.addresses) {
+            routerIdCandidate(address, false);
+        }
+        m_links.erase(it);
+        updateRouterId(res);
+        return res;
+    }
+
+    auto& link = it == m_links.end() ? m_links[ifindex] : it->second;
+    if (link.name == name) {
+        return res;
+    }
+
+    if (isPublished(link.name, link.addresses)) {
+        res.removals.emplace_back(interfaceXPath(*link.name));
+    }
+    link.name = name;
+    if (isPublished(link.name, link.addresses)) {
+        res.values.emplace_back(interfaceXPath(*link.name), *link.name);
+    }
+    return res;
+}
+
+/** @brief Tracks an IP address of a link, in its textual form. The link might not have been announced via updateLink() yet. */
+RoutingInterfaces::Changes RoutingInterfaces::updateAddress(int ifindex, int family, const std::string& address, bool present)
+{
+    Changes res;
+    auto& link = m_links[ifindex];
+    const auto wasPublished = isPublished(link.name, link.addresses);
+    const auto key = std::pair{family, address};
+
+    if (present) {
+        if (!link.addresses.insert(key).second) {
+            return res;
+        }
+    } else if (link.addresses.erase(key) == 0) {
+        if (!link.name && link.addresses.empty()) {
+            m_links.erase(ifindex);
+        }
+        return res;
+    }
+
+    routerIdCandidate(key, present);
+
+    if (const auto published = isPublished(link.name, link.addresses); published && !wasPublished) {
+        res.values.emplace_back(interfaceXPath(*link.name), *link.name);
+    } else if (!published && wasPublished) {
+        res.removals.emplace_back(interfaceXPath(*link.name));
+    }
+
+    updateRouterId(res);
+    return res;
+}
+
+void RoutingInterfaces::routerIdCandidate(const std::pair<int, std::string>& address, bool add)
+{
+    in_addr addr;
+    if (address.first != AF_INET || inet_pton(AF_INET, address.second.c_str(), &addr) != 1) {
+        return;
+    }
+
+    const auto hostOrder = ntohl(addr.s_addr);
+    if ((hostOrder >> 24) == IN_LOOPBACKNET || hostOrder == INADDR_ANY) {
+        return;
+    }
+
+    if (add) {
+        ++m_routerIdCandidates[hostOrder];
+    } else if (auto it = m_routerIdCandidates.find(hostOrder); it != m_routerIdCandidates.end() && --it->second == 0) {
+        m_routerIdCandidates.erase(it);
+    }
+}
+
+void RoutingInterfaces::updateRouterId(Changes& changes)
+{
+    if (!m_publishRouterId) {
+        return;
+    }
+
+    std::optional<std::string> routerId;
+    if (!m_routerIdCandidates.empty()) {
+        in_addr addr{.s_addr = htonl(m_routerIdCandidates.rbegin()->first)};
+        std::array<char, INET_ADDRSTRLEN> buf;
+        routerId = inet_ntop(AF_INET, &addr, buf.data(), buf.size());
+    }
+
+    if (routerId == m_routerId) {
+        return;
+    }
+
+    if (routerId) {
+        changes.values.emplace_back(IETF_ROUTING + "/router-id", *routerId);
+    } else {
+        changes.removals.emplace_back(IETF_ROUTING + "/router-id");
+    }
+    m_routerId = std::move(routerId);
+}
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include "utils/sysrepo.h"
+
+namespace velia::network {
+
+/** @brief The network-layer interfaces and the router ID, as published in /ietf-routing:routing
+ *
+ * A link is a network-layer interface for as long as it has at least one IP address. The router ID is chosen algorithmically, the same
+ * way as most routing daemons do that: it is the highest IPv4 address of all links, except for the ones from 127.0.0.0/8.
+ *
+ * Both are maintained from the individual link and address events. Each update returns just the edit of the operational datastore
+ * which reflects that update.
+ */
+class RoutingInterfaces {
+public:
+    /** @brief Edit of the operational datastore */
+    struct Changes {
+        std::vector<std::string> removals;
+        utils::YANGData values;
+    };
+
+    explicit RoutingInterfaces(bool publishRouterId);
+    Changes updateLink(int ifindex, const std::optional<std::string>& name);
+    Changes updateAddress(int ifindex, int family, const std::string& address, bool present);
+
+private:
+    struct Link {
+        std::optional<std::string> name;
+        std::set<std::pair<int, std::string>> addresses; ///< (family, address)
+    };
+
+    void routerIdCandidate(const std::pair<int, std::string>& address, bool add);
+    void updateRouterId(Changes& changes);
+
+    bool m_publishRouterId;
+    std::map<int, Link> m_links;
+    std::map<uint32_t, size_t> m_routerIdCandidates; ///< IPv4 address in the host byte order -> how many links have it
+    std::optional<std::string> m_routerId; ///< as published the last time
+};
+}
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <arpa/inet.h>
+#include <array>
+#include <iterator>
+#include <netlink/route/route.h>
+#include "RoutingTable.h"
+#include "utils/log.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+const auto IPV6ADDRSTRLEN_WITH_PREFIX = INET6_ADDRSTRLEN + 1 + 3 /* plus slash and max three-digits prefix */;
+constexpr auto ROUTE_PROTO_BUF_SIZE = sizeof("redirect"); /* "redirect" is the longest value (libnl/lib/route/route_utils.c, init_proto_names) */
+
+std::string ribName(int family, const std::string& source)
+{
+    return (family == AF_INET ? "ipv4-"s : "ipv6-"s) + source;
+}
+
+std::string familyYangPrefix(int family)
+{
+    return family == AF_INET ? "ietf-ipv4-unicast-routing"s : "ietf-ipv6-unicast-routing"s;
+}
+
+std::string ribXPath(const std::string& rib)
+{
+    return "/ietf-routing:routing/ribs/rib[name='" + rib + "']";
+}
+
+std::string routeXPath(const std::string& rib, size_t position)
+{
+    return ribXPath(rib) + "/routes/route[" + std::to_string(position) + "]";
+}
+
+std::string destinationPrefix(rtnl_route* route)
+{
+    auto* addr = rtnl_route_get_dst(route);
+    if (!addr) {
+        return {};
+    }
+
+    if (nl_addr_iszero(addr)) {
+        return rtnl_route_get_family(route) == AF_INET ? "0.0.0.0/0" : "::/0";
+    }
+
+    std::array<char, IPV6ADDRSTRLEN_WITH_PREFIX> data;
+    std::string res = nl_addr2str(addr, data.data(), data.size());
+
+    // append prefix len if nl_addr2str fails to do that (when prefix length is 32 in ipv4 or 128 in ipv6)
+    if (res.find_first_of('/') == std::string::npos) {
+        res += "/" + std::to_string(nl_addr_get_prefixlen(addr));
+    }
+    return res;
+}
+
+std::optional<std::string> sourceProtocol(uint8_t proto, uint8_t scope)
+{
+    switch (proto) {
+    case RTPROT_KERNEL:
+        return scope == RT_SCOPE_LINK ? "direct" : "static";
+    case RTPROT_STATIC:
+    case RTPROT_BOOT:
+        return "static";
+    case RTPROT_DHCP:
+        return "czechlight-network:dhcp";
+    case RTPROT_RA:
+        return "czechlight-network:ra";
+    default:
+        return std::nullopt;
+    }
+}
+}
+
+namespace velia::network {
+
+RoutingTable::RoutingTable(velia::Log log, const std::vector<RibSource>& sources)
+    : m_log(std::move(log))
+{
+    for (const auto& source : sources) {
+        if (const auto* table = std::get_if<uint32_t>(&source.table)) {
+            m_tableSources[*table] = source.name;
+        } else {
+            m_vrfSources[std::get<std::string>(source.table)] = source.name;
+        }
+    }
+}
+
+/** @brief Applies a single route change (NL_ACT_*) from the netlink cache manager. Returns true if any published data changed. */
+bool RoutingTable::updateRoute(rtnl_route* route, int action)
+{
+    const auto family = rtnl_route_get_family(route);
+    if (family != AF_INET && family != AF_INET6) {
+        return false;
+    }
+
+    const Key key{
+        .family = family,
+        .table = rtnl_route_get_table(route),
+        .destination = destinationPrefix(route),
+        .priority = rtnl_route_get_priority(route),
+        .tos = rtnl_route_get_tos(route),
+    };
+
+    auto remove = [&]() {
+        if (!m_routes.contains(key)) {
+            return false;
+        }
+        removeRoute(key);
+        return true;
+    };
+
+    if (action == NL_ACT_DEL) {
+        return remove();
+    }
+
+    auto source = m_tableSources.find(key.table);
+    if (source == m_tableSources.end() || rtnl_route_get_type(route) != RTN_UNICAST) {
+        return remove();
+    }
+    const auto rib = ribName(family, source->second);
+
+    const auto proto = rtnl_route_get_protocol(route);
+    auto protoStr = sourceProtocol(proto, rtnl_route_get_scope(route));
+    if (!protoStr) {
+        std::array<char, ROUTE_PROTO_BUF_SIZE> buf;
+        m_log->warn("Unimplemented routing protocol {} '{}'", proto, rtnl_route_proto2str(proto, buf.data(), buf.size()));
+        return remove();
+    }
+
+    Route newRoute{.sourceProtocol = *protoStr, .nextHops = {}};
+    for (auto i = 0; i < rtnl_route_get_nnexthops(route); i++) {
+        rtnl_nexthop* nh = rtnl_route_nexthop_n(route, i);
+
+        NextHop nextHop{.gateway = std::nullopt, .ifindex = rtnl_route_nh_get_ifindex(nh)};
+        if (nl_addr* addr = rtnl_route_nh_get_gateway(nh); addr) {
+            std::array<char, IPV6ADDRSTRLEN_WITH_PREFIX> buf;
+            nextHop.gateway = nl_addr2str(addr, buf.data(), buf.size());
+        }
+        newRoute.nextHops.emplace_back(std::move(nextHop));
+    }
+
+    if (auto it = m_routes.find(key); it != m_routes.end()) {
+        if (it->second.route == newRoute) {
+            return false;
+        }
+
+        indexLinks(key, it->second.route, false);
+        indexLinks(key, newRoute, true);
+        it->second.route = std::move(newRoute);
+        m_dirtySlots[it->second.rib].insert(it->second.slot);
+        return true;
+    }
+
+    addRoute(key, rib, std::move(newRoute));
+    return true;
+}
+
+/** @brief Tracks names of the outgoing interfaces and the tables of the VRFs. Returns true if any published data changed.
+ *
+ * Pass std::nullopt as a name when the link disappears. For a VRF device, @p vrfTable is its routing table.
+ */
+bool RoutingTable::updateLink(int ifindex, const std::optional<std::string>& name, std::optional<uint32_t> vrfTable)
+{
+    bool changed = false;
+
+    std::optional<std::pair<uint32_t, std::string>> vrfSource;
+    if (name && vrfTable) {
+        if (auto it = m_vrfSources.find(*name); it != m_vrfSources.end()) {
+            vrfSource = {*vrfTable, it->second};
+        }
+    }
+
+    if (auto it = m_vrfTables.find(ifindex); it != m_vrfTables.end() && (!vrfSource || *vrfSource != std::pair{it->second, m_tableSources.at(it->second)})) {
+        // a VRF which is gone, or which was renamed, or which now uses another table
+        m_log->debug("VRF table {} is no longer published", it->second);
+        changed = removeTable(it->second);
+        for (auto family : {AF_INET, AF_INET6}) {
+            changed = removeRib(ribName(family, m_tableSources.at(it->second))) || changed;
+        }
+        m_tableSources.erase(it->second);
+        m_vrfTables.erase(it);
+    }
+
+    if (vrfSource && !m_vrfTables.contains(ifindex)) {
+        m_log->debug("Publishing VRF {} (table {}) as RIBs {} and {}", *name, vrfSource->first, ribName(AF_INET, vrfSource->second), ribName(AF_INET6, vrfSource->second));
+        m_vrfTables[ifindex] = vrfSource->first;
+        m_tableSources[vrfSource->first] = vrfSource->second;
+    }
+
+    if (auto it = m_linkNames.find(ifindex); it != m_linkNames.end() && name == it->second) {
+        return changed;
+    } else if (it == m_linkNames.end() && !name) {
+        return changed;
+    }
+
+    if (name) {
+        m_linkNames[ifindex] = *name;
+    } else {
+        m_linkNames.erase(ifindex);
+    }
+
+    auto it = m_routesByLink.find(ifindex);
+    if (it == m_routesByLink.end()) {
+        return changed;
+    }
+
+    for (const auto& key : it->second) {
+        const auto& entry = m_routes.at(key);
+        m_dirtySlots[entry.rib].insert(entry.slot);
+    }
+    return true;
+}
+
+/** @brief Returns the edit which brings the previously published RIBs up to date, and marks everything as published */
+RoutingTable::Changes RoutingTable::changes()
+{
+    Changes res;
+
+    for (const auto& rib : m_removedRibs) {
+        res.removals.emplace_back(ribXPath(rib));
+    }
+    m_removedRibs.clear();
+
+    for (auto& [rib, slots] : m_slots) {
+        auto& published = m_published[rib];
+        auto& dirty = m_dirtySlots[rib];
+
+        // routes which moved into the freed slots are published again below, the entries at the end of the list are gone
+        for (auto position = published; position > slots.size(); --position) {
+            res.removals.emplace_back(routeXPath(rib, position));
+        }
+
+        for (auto slot : dirty) {
+            if (slot >= slots.size()) {
+                continue;
+            }
+
+            if (slot < published) {
+                // the other leaves are overwritten, but the next hops might have changed their structure
+                res.removals.emplace_back(routeXPath(rib, slot + 1) + "/next-hop");
+            }
+
+            const auto& key = slots[slot];
+            auto values = routeToYang(key, m_routes.at(key), slot + 1);
+            std::move(values.begin(), values.end(), std::back_inserter(res.values));
+        }
+
+        published = slots.size();
+        dirty.clear();
+    }
+
+    return res;
+}
+
+void RoutingTable::addRoute(const Key& key, const std::string& rib, Route&& route)
+{
+    auto& slots = m_slots[rib];
+    indexLinks(key, route, true);
+    m_routes.emplace(key, Entry{.route = std::move(route), .rib = rib, .slot = slots.size()});
+    m_dirtySlots[rib].insert(slots.size());
+    slots.push_back(key);
+}
+
+void RoutingTable::removeRoute(const Key& key)
+{
+    auto it = m_routes.find(key);
+    const auto rib = it->second.rib;
+    auto& slots = m_slots[rib];
+    const auto slot = it->second.slot;
+
+    indexLinks(key, it->second.route, false);
+    m_routes.erase(it);
+
+    if (slot != slots.size() - 1) {
+        slots[slot] = slots.back();
+        m_routes.at(slots[slot]).slot = slot;
+        m_dirtySlots[rib].insert(slot);
+    }
+    slots.pop_back();
+}
+
+/** @brief Removes all routes from the given table. Returns true if there were any. */
+bool RoutingTable::removeTable(uint32_t table)
+{
+    std::vector<Key> keys;
+    for (const auto& [key, entry] : m_routes) {
+        if (key.table == table) {
+            keys.push_back(key);
+        }
+    }
+
+    for (const auto& key : keys) {
+        removeRoute(key);
+    }
+    return !keys.empty();
+}
+
+/** @brief Forgets the (already emptied) RIB, and removes its list entry on the next publishing. Returns true if it was ever published. */
+bool RoutingTable::removeRib(const std::string& rib)
+{
+    m_slots.erase(rib);
+    m_dirtySlots.erase(rib);
+    if (!m_published.erase(rib)) {
+        return false;
+    }
+    m_removedRibs.insert(rib);
+    return true;
+}
+
+void RoutingTable::indexLinks(const Key& key, const Route& route, bool add)
+{
+    for (const auto& nextHop : route.nextHops) {
+        if (add) {
+            m_routesByLink[nextHop.ifindex].insert(key);
+        } else if (auto it = m_routesByLink.find(nextHop.ifindex); it != m_routesByLink.end()) {
+            it->second.erase(key);
+            if (it->second.empty()) {
+                m_routesByLink.erase(it);
+            }
+        }
+    }
+}
+
+utils::YANGData RoutingTable::routeToYang(const Key& key, const Entry& entry, size_t position) const
+{
+    const auto& route = entry.route;
+    utils::YANGData values;
+    const auto yangPrefix = routeXPath(entry.rib, position) + "/";
+    const auto familyPrefix = familyYangPrefix(key.family);
+
+    values.emplace_back(yangPrefix + familyPrefix + ":destination-prefix", key.destination);
+    values.emplace_back(yangPrefix + "source-protocol", route.sourceProtocol);
+    values.emplace_back(yangPrefix + "route-preference", std::to_string(key.priority));
+
+    const bool multihop = route.nextHops.size() > 1;
+    for (size_t i = 0; i < route.nextHops.size(); i++) {
+        const auto& nextHop = route.nextHops[i];
+        const auto nextHopPrefix = multihop ? yangPrefix + "next-hop/next-hop-list/next-hop[" + std::to_string(i + 1) + "]/" : yangPrefix + "next-hop/";
+
+        if (nextHop.gateway) {
+            values.emplace_back(nextHopPrefix + familyPrefix + (multihop ? ":address" : ":next-hop-address"), *nextHop.gateway);
+        }
+
+        if (auto it = m_linkNames.find(nextHop.ifindex); it != m_linkNames.end()) {
+            values.emplace_back(nextHopPrefix + "outgoing-interface", it->second);
+        }
+    }
+
+    return values;
+}
+}
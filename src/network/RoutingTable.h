@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <linux/rtnetlink.h>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "utils/log-fwd.h"
+#include "utils/sysrepo.h"
+
+struct rtnl_route;
+
+namespace velia::network {
+
+/** @brief A kernel routing table which is published as the ipv4-<name> and ipv6-<name> RIBs */
+struct RibSource {
+    std::string name;
+    std::variant<uint32_t, std::string> table; ///< a routing table ID, or the name of a VRF device whose table is published
+    bool operator==(const RibSource&) const = default;
+};
+
+/** @brief The main routing table, published as ipv4-master and ipv6-master */
+inline const RibSource MAIN_RIB{.name = "master", .table = uint32_t{RT_TABLE_MAIN}};
+
+/** @brief In-memory copy of the selected routing tables which are published as the ietf-routing RIBs
+ *
+ * Each of the RibSources is published as a separate pair of RIBs. The routes from the other tables are ignored. A table of a VRF is
+ * only known while the VRF device exists, see updateLink().
+ *
+ * The table is updated from individual netlink route events. It remembers which routes changed since the last call to changes(),
+ * so that only the affected list entries are republished.
+ *
+ * The ietf-routing routes are a keyless list, i.e., the list entries are addressed by their position. Each route therefore keeps
+ * a stable slot in that list for its whole lifetime. New routes are appended. When a route is removed, the last route moves into
+ * its slot, so that no other entries are renumbered.
+ */
+class RoutingTable {
+public:
+    /** @brief Edit of the operational datastore. The removals must be applied before the new values. */
+    struct Changes {
+        std::vector<std::string> removals;
+        utils::YANGData values;
+    };
+
+    explicit RoutingTable(velia::Log log, const std::vector<RibSource>& sources = {MAIN_RIB});
+    bool updateRoute(rtnl_route* route, int action);
+    bool updateLink(int ifindex, const std::optional<std::string>& name, std::optional<uint32_t> vrfTable = std::nullopt);
+    Changes changes();
+
+private:
+    struct Key {
+        int family;
+        uint32_t table;
+        std::string destination;
+        uint32_t priority;
+        uint8_t tos;
+
+        auto operator<=>(const Key&) const = default;
+    };
+
+    struct NextHop {
+        std::optional<std::string> gateway;
+        int ifindex;
+
+        bool operator==(const NextHop&) const = default;
+    };
+
+    struct Route {
+        std::string sourceProtocol;
+        std::vector<NextHop> nextHops;
+
+        bool operator==(const Route&) const = default;
+    };
+
+    struct Entry {
+        Route route;
+        std::string rib;
+        size_t slot;
+    };
+
+    void addRoute(const Key& key, const std::string& rib, Route&& route);
+    void removeRoute(const Key& key);
+    bool removeTable(uint32_t table);
+    bool removeRib(const std::string& rib);
+    void indexLinks(const Key& key, const Route& route, bool add);
+    utils::YANGData routeToYang(const Key& key, const Entry& entry, size_t position) const;
+
+    velia::Log m_log;
+    std::map<uint32_t, std::string> m_tableSources; ///< table ID -> name of the RibSource, including the tables of the existing VRFs
+    std::map<std::string, std::string> m_vrfSources; ///< VRF device name -> name of the RibSource
+    std::map<int, uint32_t> m_vrfTables; ///< ifindex of a VRF from m_vrfSources -> its table
+    std::map<Key, Entry> m_routes;
+    std::map<std::string, std::vector<Key>> m_slots; ///< per RIB, the routes in the order of their list entries
+    std::map<std::string, std::set<size_t>> m_dirtySlots; ///< per RIB, the slots which have changed since the last publishing
+    std::map<std::string, size_t> m_published; ///< per RIB, the number of routes which were published the last time
+    std::set<std::string> m_removedRibs; ///< RIBs of the removed VRFs whose list entries are still published
+    std::unordered_map<int, std::string> m_linkNames;
+    std::unordered_map<int, std::set<Key>> m_routesByLink; ///< routes which have a next hop via the given ifindex
+};
+}
@@ -5,27 +5,46 @@
  *
  */
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <linux/ethtool.h>
+#include <linux/ethtool_netlink.h>
+#include <linux/genetlink.h>
+#include <linux/rtnetlink.h>
+#include <netlink/msg.h>
 #include <netlink/route/link.h>
+#include <netlink/route/link/vrf.h>
 #include <netlink/route/neighbour.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
 #include <utility>
+#include <vector>
 #include "Rtnetlink.h"
+#include "utils/UniqueResource.h"
 #include "utils/log.h"
 
-using namespace std::chrono_literals;
 using namespace std::string_literals;
 
 namespace {
 
+/* Route and neighbour tables of a busy router can change faster than we process the notifications */
+const int NETLINK_RCVBUF_SIZE = 8 * 1024 * 1024;
+
 template <class T>
-void nlCacheForeachWrapper(nl_cache* cache, std::function<void(T*)> cb)
+void nlCacheForeachWrapper(nl_cache* cache, const std::function<void(T*)>& cb)
 {
     nl_cache_foreach(
         cache, [](nl_object* obj, void* data) {
-            auto& cb = *static_cast<std::function<void(T*)>*>(data);
+            const auto& cb = *static_cast<const std::function<void(T*)>*>(data);
             auto link = reinterpret_cast<T*>(obj);
             cb(link);
         },
-        &cb);
+        const_cast<std::function<void(T*)>*>(&cb));
 }
 
 void nlCacheMngrCallbackWrapper(struct nl_cache*, struct nl_object* obj, int action, void* data)
@@ -41,6 +60,9 @@ void nlCacheMngrCallbackWrapper(struct nl_cache*, struct nl_object* obj, int act
     } else if (objType == "route/route"s) {
         auto* cb = static_cast<velia::network::Rtnetlink::RouteCB*>(data);
         (*cb)(reinterpret_cast<rtnl_route*>(obj), action);
+    } else if (objType == "route/neigh"s) {
+        auto* cb = static_cast<velia::network::Rtnetlink::NeighCB*>(data);
+        (*cb)(reinterpret_cast<rtnl_neigh*>(obj), action);
     } else {
         throw velia::network::RtnetlinkException("Unknown netlink object type in cache: '"s + objType + "'");
     }
@@ -59,44 +81,270 @@ T* nlObjectClone(T* obj)
     return reinterpret_cast<T*>(nl_object_clone(OBJ_CAST(obj)));
 }
 
+/** @brief Passes the valid messages which are received on @p sock to @p parser until the returned guard goes out of scope
+ *
+ * The @p data usually lives on the caller's stack, so the socket must not keep pointing to it once the replies have been read.
+ */
+auto scopedParser(nl_sock* sock, nl_recvmsg_msg_cb_t parser, void* data)
+{
+    return velia::utils::make_unique_resource(
+        [=]() { nl_socket_modify_cb(sock, NL_CB_VALID, NL_CB_CUSTOM, parser, data); },
+        [=]() { nl_socket_modify_cb(sock, NL_CB_VALID, NL_CB_DEFAULT, nullptr, nullptr); });
+}
+
+/** @brief Parses one RTM_NEWSTATS message of a dump requested by Rtnetlink::getLinkStatistics */
+int parseLinkStatistics(nl_msg* msg, void* data)
+{
+    auto& res = *static_cast<std::vector<velia::network::Rtnetlink::LinkStatistics>*>(data);
+    auto* hdr = nlmsg_hdr(msg);
+
+    if (hdr->nlmsg_type != RTM_NEWSTATS || !nlmsg_valid_hdr(hdr, sizeof(if_stats_msg))) {
+        return NL_SKIP;
+    }
+
+    const auto* ifsm = static_cast<const if_stats_msg*>(nlmsg_data(hdr));
+    if (auto* attr = nlmsg_find_attr(hdr, sizeof(if_stats_msg), IFLA_STATS_LINK_64)) {
+        velia::network::Rtnetlink::LinkStatistics stats{.ifindex = static_cast<int>(ifsm->ifindex), .counters = {}};
+        // older kernels send a shorter struct, the newer ones might send a longer one
+        std::memcpy(&stats.counters, nla_data(attr), std::min<size_t>(nla_len(attr), sizeof(stats.counters)));
+        res.emplace_back(stats);
+    }
+
+    return NL_OK;
+}
+
+/** @brief Where to pass the routes from the replies to a route dump, or from the route notifications */
+struct RouteParser {
+    const std::set<uint32_t>& tables; ///< routes from other tables are skipped
+    const std::function<void(nl_object*, bool)>& cb; ///< the flag is set for a route which replaces the previous one (NLM_F_REPLACE)
+};
+
+struct RouteMessage {
+    const RouteParser& parser;
+    bool replace;
+};
+
+/** @brief Parses one RTM_NEWROUTE or RTM_DELROUTE message into a libnl object */
+int parseRoute(nl_msg* msg, void* data)
+{
+    RouteMessage message{.parser = *static_cast<const RouteParser*>(data), .replace = (nlmsg_hdr(msg)->nlmsg_flags & NLM_F_REPLACE) != 0};
+    auto err = nl_msg_parse(
+        msg, [](nl_object* obj, void* data) {
+            const auto& message = *static_cast<const RouteMessage*>(data);
+            if (message.parser.tables.contains(rtnl_route_get_table(reinterpret_cast<rtnl_route*>(obj)))) {
+                message.parser.cb(obj, message.replace);
+            }
+        },
+        &message);
+
+    return err < 0 ? NL_SKIP : NL_OK;
+}
+
+/** @brief The counters from ETHTOOL_MSG_STATS_GET which we export: (group, attribute) -> YANG leaf name */
+const std::map<std::pair<unsigned, unsigned>, std::string> ETHTOOL_COUNTERS{
+    {{ETHTOOL_STATS_ETH_PHY, ETHTOOL_A_STATS_ETH_PHY_5_SYM_ERR}, "symbol-errors"},
+    {{ETHTOOL_STATS_ETH_MAC, ETHTOOL_A_STATS_ETH_MAC_6_FCS_ERR}, "fcs-errors"},
+    {{ETHTOOL_STATS_ETH_MAC, ETHTOOL_A_STATS_ETH_MAC_7_ALIGN_ERR}, "alignment-errors"},
+    {{ETHTOOL_STATS_ETH_MAC, ETHTOOL_A_STATS_ETH_MAC_12_TX_INT_ERR}, "mac-internal-transmit-errors"},
+    {{ETHTOOL_STATS_ETH_MAC, ETHTOOL_A_STATS_ETH_MAC_13_CS_ERR}, "carrier-sense-errors"},
+    {{ETHTOOL_STATS_ETH_MAC, ETHTOOL_A_STATS_ETH_MAC_15_RX_INT_ERR}, "mac-internal-receive-errors"},
+    {{ETHTOOL_STATS_ETH_MAC, ETHTOOL_A_STATS_ETH_MAC_23_IR_LEN_ERR}, "in-range-length-errors"},
+    {{ETHTOOL_STATS_ETH_MAC, ETHTOOL_A_STATS_ETH_MAC_25_TOO_LONG_ERR}, "frame-too-long-errors"},
+    {{ETHTOOL_STATS_RMON, ETHTOOL_A_STATS_RMON_UNDERSIZE}, "undersize-frames"},
+    {{ETHTOOL_STATS_RMON, ETHTOOL_A_STATS_RMON_OVERSIZE}, "oversize-frames"},
+    {{ETHTOOL_STATS_RMON, ETHTOOL_A_STATS_RMON_FRAG}, "fragments"},
+    {{ETHTOOL_STATS_RMON, ETHTOOL_A_STATS_RMON_JABBER}, "jabbers"},
+};
+
+/** @brief Parses the reply to CTRL_CMD_GETFAMILY */
+int parseGenlFamilyId(nl_msg* msg, void* data)
+{
+    auto* hdr = nlmsg_hdr(msg);
+    if (auto* attr = nlmsg_find_attr(hdr, GENL_HDRLEN, CTRL_ATTR_FAMILY_ID)) {
+        *static_cast<int*>(data) = nla_get_u16(attr);
+    }
+    return NL_OK;
+}
+
+/** @brief Looks up the ID of a generic netlink family, or returns -1 when there's no such family */
+int resolveGenlFamily(nl_sock* sock, const char* name)
+{
+    std::unique_ptr<nl_msg, decltype(&nlmsg_free)> msg(nlmsg_alloc_simple(GENL_ID_CTRL, 0), nlmsg_free);
+    if (!msg) {
+        throw velia::network::RtnetlinkException("nlmsg_alloc_simple failed");
+    }
+
+    genlmsghdr genlHdr{.cmd = CTRL_CMD_GETFAMILY, .version = 1, .reserved = 0};
+    if (auto err = nlmsg_append(msg.get(), &genlHdr, sizeof(genlHdr), NLMSG_ALIGNTO); err < 0) {
+        throw velia::network::RtnetlinkException("nlmsg_append", err);
+    }
+    nla_put_string(msg.get(), CTRL_ATTR_FAMILY_NAME, name);
+
+    if (auto err = nl_send_auto(sock, msg.get()); err < 0) {
+        throw velia::network::RtnetlinkException("nl_send_auto", err);
+    }
+
+    int family = -1;
+    auto parser = scopedParser(sock, parseGenlFamilyId, &family);
+    if (auto err = nl_recvmsgs_default(sock); err < 0 && err != -NLE_OBJ_NOTFOUND) {
+        throw velia::network::RtnetlinkException("nl_recvmsgs_default", err);
+    }
+    return family;
+}
+
+/** @brief Device index from the ETHTOOL_A_*_HEADER nest of an ethtool-netlink reply */
+std::optional<int> ethtoolDevIndex(nlmsghdr* hdr, int headerAttr)
+{
+    if (auto* header = nlmsg_find_attr(hdr, GENL_HDRLEN, headerAttr)) {
+        if (auto* ifindex = nla_find(static_cast<nlattr*>(nla_data(header)), nla_len(header), ETHTOOL_A_HEADER_DEV_INDEX)) {
+            return nla_get_u32(ifindex);
+        }
+    }
+    return std::nullopt;
+}
+
+/** @brief Parses one ETHTOOL_MSG_LINKMODES_GET_REPLY message of a dump requested by Rtnetlink::getEthtoolLinkInfo */
+int parseEthtoolLinkModes(nl_msg* msg, void* data)
+{
+    auto& res = *static_cast<std::map<int, velia::network::Rtnetlink::EthtoolLinkInfo>*>(data);
+    auto* hdr = nlmsg_hdr(msg);
+
+    auto ifindex = ethtoolDevIndex(hdr, ETHTOOL_A_LINKMODES_HEADER);
+    if (!ifindex) {
+        return NL_SKIP;
+    }
+
+    auto& info = res[*ifindex];
+    if (auto* attr = nlmsg_find_attr(hdr, GENL_HDRLEN, ETHTOOL_A_LINKMODES_SPEED); attr && nla_get_u32(attr) != static_cast<uint32_t>(SPEED_UNKNOWN)) {
+        info.speed = uint64_t{nla_get_u32(attr)} * 1'000'000;
+    }
+    if (auto* attr = nlmsg_find_attr(hdr, GENL_HDRLEN, ETHTOOL_A_LINKMODES_DUPLEX); attr && nla_get_u8(attr) != DUPLEX_UNKNOWN) {
+        info.fullDuplex = nla_get_u8(attr) == DUPLEX_FULL;
+    }
+
+    return NL_OK;
+}
+
+/** @brief Parses one ETHTOOL_MSG_STATS_GET_REPLY message of a dump requested by Rtnetlink::getEthtoolLinkInfo */
+int parseEthtoolStats(nl_msg* msg, void* data)
+{
+    auto& res = *static_cast<std::map<int, velia::network::Rtnetlink::EthtoolLinkInfo>*>(data);
+    auto* hdr = nlmsg_hdr(msg);
+
+    auto ifindex = ethtoolDevIndex(hdr, ETHTOOL_A_STATS_HEADER);
+    if (!ifindex) {
+        return NL_SKIP;
+    }
+
+    auto& info = res[*ifindex];
+    nlattr* group;
+    int remaining;
+    nlmsg_for_each_attr(group, hdr, GENL_HDRLEN, remaining)
+    {
+        if (nla_type(group) != ETHTOOL_A_STATS_GRP) {
+            continue;
+        }
+
+        auto* groupId = nla_find(static_cast<nlattr*>(nla_data(group)), nla_len(group), ETHTOOL_A_STATS_GRP_ID);
+        if (!groupId) {
+            continue;
+        }
+
+        // each counter is a single u64 attribute, typed by the counter ID, in its own ETHTOOL_A_STATS_GRP_STAT nest
+        nlattr* stat;
+        int statRemaining;
+        nla_for_each_nested(stat, group, statRemaining)
+        {
+            if (nla_type(stat) != ETHTOOL_A_STATS_GRP_STAT || nla_len(stat) < static_cast<int>(NLA_HDRLEN + sizeof(uint64_t))) {
+                continue;
+            }
+
+            auto* value = static_cast<nlattr*>(nla_data(stat));
+            if (auto it = ETHTOOL_COUNTERS.find({nla_get_u32(groupId), nla_type(value)}); it != ETHTOOL_COUNTERS.end()) {
+                info.counters[it->second] = nla_get_u64(value);
+            }
+        }
+    }
+
+    return NL_OK;
+}
+
 }
 
 namespace velia::network {
 
 namespace impl {
 
-/** @brief Background thread watching for changes in netlink cache. Executes change callback from nl_cache_mngr_add. */
+/** @brief Background thread dispatching changes from the netlink cache manager and the route notifications.
+ *
+ * The thread sleeps in poll(2) until either of the notification sockets has some data, or until it is asked to terminate via an eventfd.
+ */
 class nlCacheMngrWatcher {
-    std::atomic<bool> m_terminate;
+    velia::network::Rtnetlink& m_rtnetlink;
+    int m_terminateFd;
     std::thread m_thr;
-    static constexpr auto FD_POLL_INTERVAL = 500ms;
 
-    void run(velia::network::Rtnetlink::nlCacheManager manager);
+    void run();
 
 public:
-    nlCacheMngrWatcher(velia::network::Rtnetlink::nlCacheManager manager);
+    nlCacheMngrWatcher(velia::network::Rtnetlink& rtnetlink);
     ~nlCacheMngrWatcher();
 };
 
-nlCacheMngrWatcher::nlCacheMngrWatcher(velia::network::Rtnetlink::nlCacheManager manager)
-    : m_terminate(false)
-    , m_thr(&nlCacheMngrWatcher::run, this, manager)
+nlCacheMngrWatcher::nlCacheMngrWatcher(velia::network::Rtnetlink& rtnetlink)
+    : m_rtnetlink(rtnetlink)
+    , m_terminateFd(eventfd(0, EFD_CLOEXEC))
 {
+    if (m_terminateFd < 0) {
+        throw std::system_error(errno, std::system_category(), "nlCacheMngrWatcher: eventfd");
+    }
+    m_thr = std::thread(&nlCacheMngrWatcher::run, this);
 }
 
-void nlCacheMngrWatcher::run(velia::network::Rtnetlink::nlCacheManager manager)
+void nlCacheMngrWatcher::run()
 {
-    while (!m_terminate) {
-        if (auto err = nl_cache_mngr_poll(manager.get(), std::chrono::duration_cast<std::chrono::milliseconds>(FD_POLL_INTERVAL).count()); err < 0) {
-            throw velia::network::RtnetlinkException("nl_cache_mngr_poll", err);
+    std::array<pollfd, 3> fds{{
+        {.fd = m_rtnetlink.fd(), .events = POLLIN, .revents = 0},
+        {.fd = m_rtnetlink.routeFd(), .events = POLLIN, .revents = 0},
+        {.fd = m_terminateFd, .events = POLLIN, .revents = 0},
+    }};
+
+    while (true) {
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category(), "nlCacheMngrWatcher: poll");
+        }
+
+        if (fds[2].revents) {
+            return;
+        }
+
+        if ((fds[0].revents | fds[1].revents) & (POLLHUP | POLLNVAL)) {
+            throw velia::network::RtnetlinkException("Netlink notification socket failed");
+        }
+
+        // POLLERR is how an overrun of the socket buffer is reported, processEvents() recovers from that
+        if ((fds[0].revents | fds[1].revents) & (POLLIN | POLLERR)) {
+            try {
+                m_rtnetlink.processEvents();
+            } catch (const std::exception& e) {
+                spdlog::get("network")->error("Cannot process netlink notifications: {}", e.what());
+            }
         }
     }
 }
 
 nlCacheMngrWatcher::~nlCacheMngrWatcher()
 {
-    m_terminate = true;
+    uint64_t one = 1;
+    if (::write(m_terminateFd, &one, sizeof(one)) != sizeof(one)) {
+        // there is no way how to recover from this, and a thread which cannot be joined would crash the process anyway
+        std::terminate();
+    }
     m_thr.join();
+    ::close(m_terminateFd);
 }
 
 }
@@ -111,12 +359,15 @@ RtnetlinkException::RtnetlinkException(const std::string& funcName, int error)
 {
 }
 
-Rtnetlink::Rtnetlink(LinkCB cbLink, AddrCB cbAddr, RouteCB cbRoute)
+Rtnetlink::Rtnetlink(LinkCB cbLink, AddrCB cbAddr, RouteCB cbRoute, NeighCB cbNeigh, EventLoop eventLoop, RouteTables routeTables)
     : m_log(spdlog::get("network"))
     , m_nlSocket(nl_socket_alloc(), nl_socket_free)
+    , m_routeTablesConfig(std::move(routeTables))
     , m_cbLink(std::move(cbLink))
     , m_cbAddr(std::move(cbAddr))
     , m_cbRoute(std::move(cbRoute))
+    , m_cbNeigh(std::move(cbNeigh))
+    , m_overruns(0)
 {
     if (!m_nlSocket) {
         throw RtnetlinkException("nl_socket_alloc failed");
@@ -126,6 +377,39 @@ Rtnetlink::Rtnetlink(LinkCB cbLink, AddrCB cbAddr, RouteCB cbRoute)
         throw RtnetlinkException("nl_connect", err);
     }
 
+    m_nlStatsSocket = {nl_socket_alloc(), nl_socket_free};
+    if (!m_nlStatsSocket) {
+        throw RtnetlinkException("nl_socket_alloc failed");
+    }
+
+    if (auto err = nl_connect(m_nlStatsSocket.get(), NETLINK_ROUTE); err < 0) {
+        throw RtnetlinkException("nl_connect", err);
+    }
+
+    // dumps do not send any ACKs, the reply ends with NLMSG_DONE
+    nl_socket_disable_auto_ack(m_nlStatsSocket.get());
+
+    // Ask the kernel to validate the request header and to honour the filter in it. That's not available on kernels older than 4.20,
+    // but RTM_GETSTATS respects the filter_mask even without that.
+    if (int one = 1; setsockopt(nl_socket_get_fd(m_nlStatsSocket.get()), SOL_NETLINK, NETLINK_GET_STRICT_CHK, &one, sizeof(one)) < 0) {
+        m_log->debug("Netlink strict checking is not available: {}", std::strerror(errno));
+    }
+
+    m_nlEthtoolSocket = {nl_socket_alloc(), nl_socket_free};
+    if (!m_nlEthtoolSocket) {
+        throw RtnetlinkException("nl_socket_alloc failed");
+    }
+
+    if (auto err = nl_connect(m_nlEthtoolSocket.get(), NETLINK_GENERIC); err < 0) {
+        throw RtnetlinkException("nl_connect", err);
+    }
+
+    nl_socket_disable_auto_ack(m_nlEthtoolSocket.get());
+    m_ethtoolFamily = resolveGenlFamily(m_nlEthtoolSocket.get(), ETHTOOL_GENL_NAME);
+    if (m_ethtoolFamily < 0) {
+        m_log->info("The kernel does not support ethtool-netlink, link speed and Ethernet error counters are not available");
+    }
+
     {
         nl_cache_mngr* tmpManager;
         if (auto err = nl_cache_mngr_alloc(nullptr /* alloc and manage new netlink socket */, NETLINK_ROUTE, NL_AUTO_PROVIDE, &tmpManager); err < 0) {
@@ -134,9 +418,11 @@ Rtnetlink::Rtnetlink(LinkCB cbLink, AddrCB cbAddr, RouteCB cbRoute)
         m_nlCacheManager = nlCacheManager(tmpManager, nl_cache_mngr_free);
     }
 
-    // start listening for changes in cache manager in background thread
-    // FIXME: implement event loop instead of nlCacheMngrWatcher, maybe with https://www.freedesktop.org/software/systemd/man/sd-event.html
-    m_nlCacheMngrWatcher = std::make_unique<impl::nlCacheMngrWatcher>(m_nlCacheManager);
+    // SO_RCVBUFFORCE can exceed net.core.rmem_max, but it needs CAP_NET_ADMIN
+    if (setsockopt(fd(), SOL_SOCKET, SO_RCVBUFFORCE, &NETLINK_RCVBUF_SIZE, sizeof(NETLINK_RCVBUF_SIZE)) < 0
+        && setsockopt(fd(), SOL_SOCKET, SO_RCVBUF, &NETLINK_RCVBUF_SIZE, sizeof(NETLINK_RCVBUF_SIZE)) < 0) {
+        m_log->warn("Cannot enlarge the receive buffer of the netlink socket: {}", std::strerror(errno));
+    }
 
     if (auto err = nl_cache_mngr_add(m_nlCacheManager.get(), "route/link", nlCacheMngrCallbackWrapper, &m_cbLink, &m_nlManagedCacheLink); err < 0) {
         throw RtnetlinkException("nl_cache_mngr_add", err);
@@ -146,8 +432,18 @@ Rtnetlink::Rtnetlink(LinkCB cbLink, AddrCB cbAddr, RouteCB cbRoute)
         throw RtnetlinkException("nl_cache_mngr_add", err);
     }
 
-    if (auto err = nl_cache_mngr_add(m_nlCacheManager.get(), "route/route", nlCacheMngrCallbackWrapper, &m_cbRoute, &m_nlManagedCacheRoute); err < 0) {
-        throw RtnetlinkException("nl_cache_mngr_add", err);
+    {
+        // The cache manager can only hold a single cache of each type. The IP neighbours and the bridge FDB (which are both RTM_*NEIGH)
+        // therefore share one cache, which is dumped (and resynced) for AF_UNSPEC and then for AF_BRIDGE.
+        if (auto err = nl_cache_alloc_name("route/neigh", &m_nlManagedCacheNeigh); err < 0) {
+            throw RtnetlinkException("nl_cache_alloc_name", err);
+        }
+        nl_cache_set_flags(m_nlManagedCacheNeigh, NL_CACHE_AF_ITER);
+
+        if (auto err = nl_cache_mngr_add_cache(m_nlCacheManager.get(), m_nlManagedCacheNeigh, nlCacheMngrCallbackWrapper, &m_cbNeigh); err < 0) {
+            nl_cache_free(m_nlManagedCacheNeigh);
+            throw RtnetlinkException("nl_cache_mngr_add_cache", err);
+        }
     }
 
     {
@@ -160,29 +456,176 @@ Rtnetlink::Rtnetlink(LinkCB cbLink, AddrCB cbAddr, RouteCB cbRoute)
         m_nlCacheLink = nlCache(tmpCache, nl_cache_free);
     }
 
-    {
-        nl_cache* tmpCache;
+    m_nlRouteSocket = {nl_socket_alloc(), nl_socket_free};
+    if (!m_nlRouteSocket) {
+        throw RtnetlinkException("nl_socket_alloc failed");
+    }
 
-        if (auto err = rtnl_neigh_alloc_cache(m_nlSocket.get(), &tmpCache); err < 0) {
-            throw RtnetlinkException("rtnl_neigh_alloc_cache", err);
-        }
+    // the notifications are not replies to anything we sent
+    nl_socket_disable_seq_check(m_nlRouteSocket.get());
+
+    if (auto err = nl_connect(m_nlRouteSocket.get(), NETLINK_ROUTE); err < 0) {
+        throw RtnetlinkException("nl_connect", err);
+    }
+
+    // subscribe before the initial dump, so that no change gets lost in between
+    if (auto err = nl_socket_add_memberships(m_nlRouteSocket.get(), RTNLGRP_IPV4_ROUTE, RTNLGRP_IPV6_ROUTE, 0); err < 0) {
+        throw RtnetlinkException("nl_socket_add_memberships", err);
+    }
+
+    if (auto err = nl_socket_set_nonblocking(m_nlRouteSocket.get()); err < 0) {
+        throw RtnetlinkException("nl_socket_set_nonblocking", err);
+    }
 
-        m_nlCacheNeighbour = nlCache(tmpCache, nl_cache_free);
+    if (setsockopt(routeFd(), SOL_SOCKET, SO_RCVBUFFORCE, &NETLINK_RCVBUF_SIZE, sizeof(NETLINK_RCVBUF_SIZE)) < 0
+        && setsockopt(routeFd(), SOL_SOCKET, SO_RCVBUF, &NETLINK_RCVBUF_SIZE, sizeof(NETLINK_RCVBUF_SIZE)) < 0) {
+        m_log->warn("Cannot enlarge the receive buffer of the netlink socket: {}", std::strerror(errno));
+    }
+
+    m_nlRouteDumpSocket = {nl_socket_alloc(), nl_socket_free};
+    if (!m_nlRouteDumpSocket) {
+        throw RtnetlinkException("nl_socket_alloc failed");
+    }
+
+    if (auto err = nl_connect(m_nlRouteDumpSocket.get(), NETLINK_ROUTE); err < 0) {
+        throw RtnetlinkException("nl_connect", err);
+    }
+
+    nl_socket_disable_auto_ack(m_nlRouteDumpSocket.get());
+
+    // Without strict checking (kernels older than 4.20), the table filter is ignored and the routes from other tables are skipped in here
+    if (int one = 1; setsockopt(nl_socket_get_fd(m_nlRouteDumpSocket.get()), SOL_NETLINK, NETLINK_GET_STRICT_CHK, &one, sizeof(one)) < 0) {
+        m_log->debug("Netlink strict checking is not available, route dumps will contain all routing tables: {}", std::strerror(errno));
     }
 
     {
         nl_cache* tmpCache;
 
-        if (auto err = rtnl_route_alloc_cache(m_nlSocket.get(), AF_UNSPEC, ROUTE_CACHE_CONTENT, &tmpCache); err < 0) {
-            throw RtnetlinkException("rtnl_route_alloc_cache", err);
+        if (auto err = nl_cache_alloc_name("route/route", &tmpCache); err < 0) {
+            throw RtnetlinkException("nl_cache_alloc_name", err);
         }
 
-        m_nlCacheRoute = nlCache(tmpCache, nl_cache_free);
+        m_nlTrackedCacheRoute = nlCache(tmpCache, nl_cache_free);
+    }
+
+    updateRouteTables(false);
+
+    // start listening for changes only when all the managed caches are in place, so that the watcher never races with nl_cache_mngr_add
+    if (eventLoop == EventLoop::Internal) {
+        m_nlCacheMngrWatcher = std::make_unique<impl::nlCacheMngrWatcher>(*this);
     }
 }
 
 Rtnetlink::~Rtnetlink() = default;
 
+/** @brief File descriptor of the netlink socket which receives the change notifications. It becomes readable when there are changes to process. */
+int Rtnetlink::fd() const
+{
+    return nl_cache_mngr_get_fd(m_nlCacheManager.get());
+}
+
+/** @brief File descriptor of the netlink socket which receives the route change notifications. It becomes readable when there are changes to process. */
+int Rtnetlink::routeFd() const
+{
+    return nl_socket_get_fd(m_nlRouteSocket.get());
+}
+
+/** @brief Reads all pending change notifications from fd() and routeFd() and fires the change callbacks. Does not block when there is nothing to read.
+ *
+ * If some notifications were lost, the caches are resynchronized, see resync().
+ */
+void Rtnetlink::processEvents()
+{
+    std::string funcName = "nl_cache_mngr_data_ready";
+    auto err = nl_cache_mngr_data_ready(m_nlCacheManager.get());
+
+    if (err >= 0) {
+        // a VRF might have come or gone, so the queued route notifications have to be matched against its table
+        updateRouteTables(true);
+
+        std::lock_guard lock(m_routeMtx);
+        funcName = "nl_recvmsgs_report";
+        err = processRouteEvents();
+    }
+
+    // libnl reports ENOBUFS from recvmsg(2) as NLE_NOMEM
+    if (err == -NLE_NOMEM || err == -NLE_DUMP_INTR) {
+        auto overruns = ++m_overruns;
+        m_log->warn("Some netlink notifications were lost ({}), resynchronizing (overrun #{})", nl_geterror(err), overruns);
+        resync();
+    } else if (err < 0) {
+        throw RtnetlinkException(funcName, err);
+    }
+}
+
+/** @brief Applies all pending route notifications to the tracked routes. The caller must hold m_routeMtx. */
+int Rtnetlink::processRouteEvents()
+{
+    const std::function<void(nl_object*, bool)> include = [this](nl_object* obj, bool replace) {
+        if (replace) {
+            replaceRoute(obj, true);
+        } else {
+            nl_cache_include(m_nlTrackedCacheRoute.get(), obj, nlCacheMngrCallbackWrapper, &m_cbRoute);
+        }
+    };
+    RouteParser parser{.tables = m_routeTables, .cb = include};
+
+    std::unique_ptr<nl_cb, decltype(&nl_cb_put)> cb(nl_socket_get_cb(m_nlRouteSocket.get()), nl_cb_put);
+    nl_cb_set(cb.get(), NL_CB_VALID, NL_CB_CUSTOM, parseRoute, &parser);
+
+    int err;
+    while ((err = nl_recvmsgs_report(m_nlRouteSocket.get(), cb.get())) > 0) {
+    }
+    return err == -NLE_AGAIN ? 0 : err;
+}
+
+/** @brief Brings the managed caches up to date with the kernel, firing the change callbacks for any differences
+ *
+ * The callbacks are fired from the calling thread. Therefore, this can only be called directly with EventLoop::External, and from
+ * the same thread which calls processEvents().
+ */
+void Rtnetlink::resync()
+{
+    // a separate socket, so that the callbacks can still use the getters which lock m_cacheMtx
+    std::unique_ptr<nl_sock, std::function<void(nl_sock*)>> sock(nl_socket_alloc(), nl_socket_free);
+    if (!sock) {
+        throw RtnetlinkException("nl_socket_alloc failed");
+    }
+
+    if (auto err = nl_connect(sock.get(), NETLINK_ROUTE); err < 0) {
+        throw RtnetlinkException("nl_connect", err);
+    }
+
+    for (const auto& [cache, cb] : std::initializer_list<std::pair<nl_cache*, void*>>{
+             {m_nlManagedCacheLink, &m_cbLink},
+             {m_nlManagedCacheAddr, &m_cbAddr},
+             {m_nlManagedCacheNeigh, &m_cbNeigh},
+         }) {
+        if (auto err = nl_cache_resync(sock.get(), cache, nlCacheMngrCallbackWrapper, cb); err < 0) {
+            throw RtnetlinkException("nl_cache_resync", err);
+        }
+    }
+
+    {
+        // the same as nl_cache_resync, but with a separate dump of each table
+        std::lock_guard lock(m_routeMtx);
+        nl_cache_mark_all(m_nlTrackedCacheRoute.get());
+        for (auto table : m_routeTables) {
+            // the replaced routes are not marked anymore
+            dumpRoutes(table, [this](nl_object* obj) { replaceRoute(obj, true); });
+        }
+        dropRoutes([](rtnl_route* route) { return nl_object_is_marked(OBJ_CAST(route)); }, true);
+    }
+
+    updateRouteTables(true);
+}
+
+/** @brief How many times were some netlink notifications lost */
+uint64_t Rtnetlink::overruns() const
+{
+    return m_overruns;
+}
+
 /* @brief Fire callbacks after getting the initial data into the cache; populating the cache with nl_cache_mngr_add doesn't fire any cache change events
  *
  * This code can't be in constructor because the callbacks can invoke other Rtnetlink methods while the instance is not yet constructed.
@@ -197,58 +640,272 @@ void Rtnetlink::invokeInitialCallbacks()
         m_cbAddr(addr, NL_ACT_NEW);
     });
 
-    m_cbRoute(nullptr, NL_ACT_NEW); // when a single route is changed, we fetch all anyway, so no need to call update on all routes (as of now)
+    {
+        std::lock_guard lock(m_routeMtx);
+        nlCacheForeachWrapper<rtnl_route>(m_nlTrackedCacheRoute.get(), [this](rtnl_route* route) {
+            m_cbRoute(route, NL_ACT_NEW);
+        });
+    }
+
+    nlCacheForeachWrapper<rtnl_neigh>(m_nlManagedCacheNeigh, [this](rtnl_neigh* neigh) {
+        m_cbNeigh(neigh, NL_ACT_NEW);
+    });
 }
 
+/** @brief Returns copies of all links. Prefer forEachLink() which does not copy anything. */
 std::vector<Rtnetlink::nlLink> Rtnetlink::getLinks()
 {
-    resyncCache(m_nlCacheLink);
-
     std::vector<Rtnetlink::nlLink> res;
-    nlCacheForeachWrapper<rtnl_link>(m_nlCacheLink.get(), [&res](rtnl_link* link) {
+    forEachLink([&res](rtnl_link* link) {
         res.emplace_back(nlObjectWrap(nlObjectClone(link)));
     });
-
     return res;
 }
 
-std::vector<std::pair<Rtnetlink::nlNeigh, Rtnetlink::nlLink>> Rtnetlink::getNeighbours()
+/** @brief Invokes @p visitor on each link, right in the cache
+ *
+ * The cache is locked for the whole time, so the visitor must not call any other getters of this instance. The object is only
+ * valid during the visitor call.
+ */
+void Rtnetlink::forEachLink(const std::function<void(rtnl_link*)>& visitor)
 {
+    std::lock_guard lock(m_cacheMtx);
     resyncCache(m_nlCacheLink);
-    resyncCache(m_nlCacheNeighbour);
+    nlCacheForeachWrapper<rtnl_link>(m_nlCacheLink.get(), visitor);
+}
+
+/** @brief Dumps just the 64-bit link counters of all links
+ *
+ * Unlike getLinks(), this asks the kernel only for the IFLA_STATS_LINK_64 attribute, so the replies are small and are parsed
+ * directly, without creating any libnl objects.
+ */
+std::vector<Rtnetlink::LinkStatistics> Rtnetlink::getLinkStatistics()
+{
+    std::lock_guard lock(m_statsMtx);
 
-    std::vector<std::pair<Rtnetlink::nlNeigh, Rtnetlink::nlLink>> res;
-    nlCacheForeachWrapper<rtnl_neigh>(m_nlCacheNeighbour.get(), [this, &res](rtnl_neigh* neigh) {
-        auto link = rtnl_link_get(m_nlCacheLink.get(), rtnl_neigh_get_ifindex(neigh));
+    std::unique_ptr<nl_msg, decltype(&nlmsg_free)> msg(nlmsg_alloc_simple(RTM_GETSTATS, NLM_F_DUMP), nlmsg_free);
+    if (!msg) {
+        throw RtnetlinkException("nlmsg_alloc_simple failed");
+    }
 
-        res.emplace_back(nlObjectWrap(nlObjectClone(neigh)), nlObjectWrap(link));
-    });
+    if_stats_msg ifsm{};
+    ifsm.family = AF_UNSPEC;
+    ifsm.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+    if (auto err = nlmsg_append(msg.get(), &ifsm, sizeof(ifsm), NLMSG_ALIGNTO); err < 0) {
+        throw RtnetlinkException("nlmsg_append", err);
+    }
+
+    if (auto err = nl_send_auto(m_nlStatsSocket.get(), msg.get()); err < 0) {
+        throw RtnetlinkException("nl_send_auto", err);
+    }
+
+    std::vector<LinkStatistics> res;
+    auto parser = scopedParser(m_nlStatsSocket.get(), parseLinkStatistics, &res);
+    if (auto err = nl_recvmsgs_default(m_nlStatsSocket.get()); err < 0) {
+        throw RtnetlinkException("nl_recvmsgs_default", err);
+    }
 
     return res;
 }
 
-std::vector<Rtnetlink::nlRoute> Rtnetlink::getRoutes()
+/** @brief Queries the speed, duplex and the IEEE 802.3 error counters of all links which support that, keyed by the ifindex
+ *
+ * This is a single dump of ETHTOOL_MSG_LINKMODES_GET and a single dump of ETHTOOL_MSG_STATS_GET for all links at once, so the cost
+ * does not grow with the number of round trips per link. Ask the drivers sparingly anyway, some of them read the counters from the hardware.
+ */
+std::map<int, Rtnetlink::EthtoolLinkInfo> Rtnetlink::getEthtoolLinkInfo()
 {
-#if 0
-    resyncCache(m_nlCacheRoute); // first resync lowers the number of routes. It doesn't seem to recognize one particular route in ipv6. Possibly related to https://github.com/thom311/libnl/issues/224?
-#else
-    nl_cache* tmpCache;
-
-    if (auto err = rtnl_route_alloc_cache(m_nlSocket.get(), AF_UNSPEC, 0, &tmpCache); err < 0) {
-        throw RtnetlinkException("rtnl_route_alloc_cache", err);
+    std::map<int, EthtoolLinkInfo> res;
+    if (m_ethtoolFamily < 0) {
+        return res;
     }
 
-    m_nlCacheRoute = nlCache(tmpCache, nl_cache_free);
-#endif
+    std::lock_guard lock(m_ethtoolMtx);
+
+    auto dump = [&](uint8_t cmd, int headerAttr, const std::function<void(nl_msg*)>& addAttributes, nl_recvmsg_msg_cb_t parser) {
+        std::unique_ptr<nl_msg, decltype(&nlmsg_free)> msg(nlmsg_alloc_simple(m_ethtoolFamily, NLM_F_DUMP), nlmsg_free);
+        if (!msg) {
+            throw RtnetlinkException("nlmsg_alloc_simple failed");
+        }
+
+        genlmsghdr genlHdr{.cmd = cmd, .version = ETHTOOL_GENL_VERSION, .reserved = 0};
+        if (auto err = nlmsg_append(msg.get(), &genlHdr, sizeof(genlHdr), NLMSG_ALIGNTO); err < 0) {
+            throw RtnetlinkException("nlmsg_append", err);
+        }
+
+        // the kernel validates ethtool requests strictly, the nests have to be marked as such
+        auto* header = nla_nest_start(msg.get(), headerAttr | NLA_F_NESTED);
+        nla_put_u32(msg.get(), ETHTOOL_A_HEADER_FLAGS, ETHTOOL_FLAG_COMPACT_BITSETS);
+        nla_nest_end(msg.get(), header);
+        if (addAttributes) {
+            addAttributes(msg.get());
+        }
+
+        if (auto err = nl_send_auto(m_nlEthtoolSocket.get(), msg.get()); err < 0) {
+            throw RtnetlinkException("nl_send_auto", err);
+        }
+
+        auto guard = scopedParser(m_nlEthtoolSocket.get(), parser, &res);
+        if (auto err = nl_recvmsgs_default(m_nlEthtoolSocket.get()); err < 0) {
+            throw RtnetlinkException("nl_recvmsgs_default", err);
+        }
+    };
+
+    dump(ETHTOOL_MSG_LINKMODES_GET, ETHTOOL_A_LINKMODES_HEADER, {}, parseEthtoolLinkModes);
+
+    dump(ETHTOOL_MSG_STATS_GET, ETHTOOL_A_STATS_HEADER, [](nl_msg* msg) {
+        const uint32_t groups = (1 << ETHTOOL_STATS_ETH_PHY) | (1 << ETHTOOL_STATS_ETH_MAC) | (1 << ETHTOOL_STATS_RMON);
+        auto* bitset = nla_nest_start(msg, ETHTOOL_A_STATS_GROUPS | NLA_F_NESTED);
+        nla_put_flag(msg, ETHTOOL_A_BITSET_NOMASK);
+        nla_put_u32(msg, ETHTOOL_A_BITSET_SIZE, __ETHTOOL_STATS_CNT);
+        nla_put(msg, ETHTOOL_A_BITSET_VALUE, sizeof(groups), &groups);
+        nla_nest_end(msg, bitset);
+    }, parseEthtoolStats);
+
+    return res;
+}
 
+/** @brief Returns copies of all routes from the tracked routing tables. Prefer forEachRoute() which does not copy anything. */
+std::vector<Rtnetlink::nlRoute> Rtnetlink::getRoutes()
+{
     std::vector<Rtnetlink::nlRoute> res;
-    nlCacheForeachWrapper<rtnl_route>(m_nlCacheRoute.get(), [&res](rtnl_route* route) {
+    forEachRoute([&res](rtnl_route* route) {
         res.emplace_back(nlObjectWrap(nlObjectClone(route)));
     });
-
     return res;
 }
 
+/** @brief Invokes @p visitor on each route from the tracked routing tables, right in the cache. The same restrictions as for forEachLink() apply.
+ *
+ * The routes are not dumped again, these are the ones which the route notifications have been applied to so far.
+ */
+void Rtnetlink::forEachRoute(const std::function<void(rtnl_route*)>& visitor)
+{
+    std::lock_guard lock(m_routeMtx);
+    nlCacheForeachWrapper<rtnl_route>(m_nlTrackedCacheRoute.get(), visitor);
+}
+
+/** @brief Dumps the IPv4 and IPv6 routes of a single routing table and passes them to @p cb. The caller must hold m_routeMtx.
+ *
+ * The table is requested via RTA_TABLE, so with strict checking the kernel only sends the routes from that table. Older kernels
+ * ignore the filter and dump everything, which is why the routes from the other tables are also skipped when parsing the replies.
+ */
+void Rtnetlink::dumpRoutes(uint32_t table, const std::function<void(nl_object*)>& cb)
+{
+    const std::set<uint32_t> tables{table};
+    const std::function<void(nl_object*, bool)> dumped = [&cb](nl_object* obj, bool) { cb(obj); };
+    RouteParser parser{.tables = tables, .cb = dumped};
+    auto guard = scopedParser(m_nlRouteDumpSocket.get(), parseRoute, &parser);
+
+    // a single AF_UNSPEC dump would also go through the families which do not support the table filter (e.g., MPLS), and fail
+    for (auto family : {AF_INET, AF_INET6}) {
+        int err;
+        do {
+            std::unique_ptr<nl_msg, decltype(&nlmsg_free)> msg(nlmsg_alloc_simple(RTM_GETROUTE, NLM_F_DUMP), nlmsg_free);
+            if (!msg) {
+                throw RtnetlinkException("nlmsg_alloc_simple failed");
+            }
+
+            rtmsg rtm{};
+            rtm.rtm_family = family;
+            if (err = nlmsg_append(msg.get(), &rtm, sizeof(rtm), NLMSG_ALIGNTO); err < 0) {
+                throw RtnetlinkException("nlmsg_append", err);
+            }
+            nla_put_u32(msg.get(), RTA_TABLE, table);
+
+            if (err = nl_send_auto(m_nlRouteDumpSocket.get(), msg.get()); err < 0) {
+                throw RtnetlinkException("nl_send_auto", err);
+            }
+
+            // the dump is simply repeated when it gets interrupted by a change, the routes which were already seen are just updated
+            err = nl_recvmsgs_default(m_nlRouteDumpSocket.get());
+        } while (err == -NLE_DUMP_INTR);
+
+        // the kernel creates the tables lazily, and refuses to dump a table which does not exist (yet)
+        if (err < 0 && err != -NLE_OBJ_NOTFOUND) {
+            throw RtnetlinkException("nl_recvmsgs_default", err);
+        }
+    }
+}
+
+/** @brief Starts tracking the tables of the VRFs which have appeared, and drops the routes from the tables which are no longer tracked
+ *
+ * When @p notify is set, the route callbacks are fired for the routes which were added or dropped.
+ */
+void Rtnetlink::updateRouteTables(bool notify)
+{
+    auto tables = m_routeTablesConfig.ids;
+    if (!m_routeTablesConfig.vrfs.empty()) {
+        nlCacheForeachWrapper<rtnl_link>(m_nlManagedCacheLink, [&](rtnl_link* link) {
+            uint32_t table;
+            if (rtnl_link_is_vrf(link) && m_routeTablesConfig.vrfs.contains(rtnl_link_get_name(link)) && rtnl_link_vrf_get_tableid(link, &table) == 0) {
+                tables.insert(table);
+            }
+        });
+    }
+
+    std::lock_guard lock(m_routeMtx);
+    if (tables == m_routeTables) {
+        return;
+    }
+
+    dropRoutes([&tables](rtnl_route* route) { return !tables.contains(rtnl_route_get_table(route)); }, notify);
+
+    for (auto table : tables) {
+        if (m_routeTables.contains(table)) {
+            continue;
+        }
+
+        m_log->debug("Tracking routes from table {}", table);
+        dumpRoutes(table, [this, notify](nl_object* obj) { replaceRoute(obj, notify); });
+    }
+
+    m_routeTables = std::move(tables);
+}
+
+/** @brief Puts @p obj into the tracked routes instead of the route with the same key, and optionally fires the route callback. The caller must hold m_routeMtx.
+ *
+ * This is for the dumped routes, and for the notifications with NLM_F_REPLACE, which carry the whole route. nl_cache_include() would
+ * merge a single-nexthop IPv6 route into the cached one instead (libnl's route_update expects that the kernel announces the next hops
+ * of a multipath route one by one), so after `ip -6 route replace ... via B` both the old and the new gateway would be published.
+ */
+void Rtnetlink::replaceRoute(nl_object* obj, bool notify)
+{
+    auto action = NL_ACT_NEW;
+    if (auto* old = nl_cache_search(m_nlTrackedCacheRoute.get(), obj)) {
+        action = nl_object_diff(old, obj) ? NL_ACT_CHANGE : NL_ACT_UNSPEC;
+        nl_cache_remove(old);
+        nl_object_put(old);
+    }
+
+    if (auto err = nl_cache_add(m_nlTrackedCacheRoute.get(), obj); err < 0) {
+        throw RtnetlinkException("nl_cache_add", err);
+    }
+
+    if (notify && action != NL_ACT_UNSPEC) {
+        m_cbRoute(reinterpret_cast<rtnl_route*>(obj), action);
+    }
+}
+
+/** @brief Removes the matching routes from the tracked routes, and optionally fires the route callbacks. The caller must hold m_routeMtx. */
+void Rtnetlink::dropRoutes(const std::function<bool(rtnl_route*)>& predicate, bool notify)
+{
+    std::vector<nlRoute> dropped;
+    nlCacheForeachWrapper<rtnl_route>(m_nlTrackedCacheRoute.get(), [&](rtnl_route* route) {
+        if (predicate(route)) {
+            nl_object_get(OBJ_CAST(route));
+            dropped.emplace_back(nlObjectWrap(route));
+        }
+    });
+
+    for (const auto& route : dropped) {
+        nl_cache_remove(OBJ_CAST(route.get()));
+        if (notify) {
+            m_cbRoute(route.get(), NL_ACT_DEL);
+        }
+    }
+}
+
 void Rtnetlink::resyncCache(const nlCache& cache)
 {
     nl_cache_resync(m_nlSocket.get(), cache.get(), [](nl_cache*, nl_object*, int, void*){}, nullptr);
@@ -7,15 +7,20 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <linux/if_link.h>
+#include <map>
 #include <mutex>
 #include <netlink/netlink.h>
 #include <netlink/route/addr.h>
 #include <netlink/route/link.h>
 #include <netlink/route/neighbour.h>
 #include <netlink/route/route.h>
+#include <optional>
+#include <set>
 #include <stdexcept>
-#include <thread>
+#include <string>
 #include "utils/log-fwd.h"
 
 namespace velia::network {
@@ -24,43 +29,104 @@ namespace impl {
 class nlCacheMngrWatcher;
 }
 
-/** @brief Wrapper for monitoring changes in NETLINK_ROUTE */
+/** @brief Wrapper for monitoring changes in NETLINK_ROUTE
+ *
+ * Change notifications are delivered through a nonblocking netlink socket (see fd()). By default, a background thread waits
+ * for data on that socket and dispatches the change callbacks. With EventLoop::External, no thread is started and the caller
+ * is responsible for calling processEvents() whenever fd() becomes readable (e.g., from an epoll or sd-event reactor).
+ *
+ * Routes are only tracked for the selected routing tables (see RouteTables). They are not kept by the cache manager, which would dump
+ * all tables of all VRFs. The initial dump and the resynchronizations are strictly checked RTM_GETROUTE requests filtered by the table,
+ * so the kernel doesn't even send routes from the other tables. The route notifications arrive through another socket, see routeFd().
+ *
+ * When the kernel drops some notifications because the socket buffer overflows, the managed caches are resynchronized with the kernel
+ * and the change callbacks are fired for everything that changed in the meantime.
+ */
 class Rtnetlink {
 public:
+    enum class EventLoop {
+        Internal, ///< Dispatch the change callbacks from a background thread
+        External, ///< The caller watches fd() and routeFd() and invokes processEvents()
+    };
+
+    /** @brief Which routing tables are tracked */
+    struct RouteTables {
+        std::set<uint32_t> ids;
+        std::set<std::string> vrfs; ///< names of VRF devices, their tables are tracked for as long as the device exists
+    };
+
     using nlCacheManager = std::shared_ptr<nl_cache_mngr>;
     using nlCache = std::unique_ptr<nl_cache, std::function<void(nl_cache*)>>;
     using nlLink = std::unique_ptr<rtnl_link, std::function<void(rtnl_link*)>>;
-    using nlNeigh = std::unique_ptr<rtnl_neigh, std::function<void(rtnl_neigh*)>>;
     using nlRoute = std::unique_ptr<rtnl_route, std::function<void(rtnl_route*)>>;
 
     using LinkCB = std::function<void(rtnl_link* link, int cacheAction)>; /// cacheAction: NL_ACT_*
     using AddrCB = std::function<void(rtnl_addr* addr, int cacheAction)>; /// cacheAction: NL_ACT_*
     using RouteCB = std::function<void(rtnl_route* route, int cacheAction)>; /// cacheAction: NL_ACT_*
+    using NeighCB = std::function<void(rtnl_neigh* neigh, int cacheAction)>; /// cacheAction: NL_ACT_*
+
+    /** @brief The 64-bit traffic counters of a single link, as reported by the kernel in IFLA_STATS_LINK_64 */
+    struct LinkStatistics {
+        int ifindex;
+        rtnl_link_stats64 counters;
+    };
+
+    /** @brief Link properties and IEEE 802.3 error counters of a single link, as reported by the driver via ethtool-netlink */
+    struct EthtoolLinkInfo {
+        std::optional<uint64_t> speed; ///< bits per second
+        std::optional<bool> fullDuplex;
+        std::map<std::string, uint64_t> counters; ///< only those which the driver supports, named after the leafs in velia-interfaces
+    };
 
-    Rtnetlink(LinkCB cbLink, AddrCB cbAddr, RouteCB cbRoute);
+    Rtnetlink(LinkCB cbLink, AddrCB cbAddr, RouteCB cbRoute, NeighCB cbNeigh, EventLoop eventLoop = EventLoop::Internal, RouteTables routeTables = {.ids = {RT_TABLE_MAIN}, .vrfs = {}});
     ~Rtnetlink();
+    int fd() const;
+    int routeFd() const;
+    void processEvents();
+    void resync();
+    uint64_t overruns() const;
     std::vector<nlLink> getLinks();
     std::vector<nlRoute> getRoutes();
-    std::vector<std::pair<nlNeigh, nlLink>> getNeighbours();
+    void forEachLink(const std::function<void(rtnl_link*)>& visitor);
+    void forEachRoute(const std::function<void(rtnl_route*)>& visitor);
+    std::vector<LinkStatistics> getLinkStatistics();
+    std::map<int, EthtoolLinkInfo> getEthtoolLinkInfo();
 
     void invokeInitialCallbacks();
 
 private:
     void resyncCache(const nlCache& cache);
+    int processRouteEvents();
+    void dumpRoutes(uint32_t table, const std::function<void(nl_object*)>& cb);
+    void updateRouteTables(bool notify);
+    void replaceRoute(nl_object* obj, bool notify);
+    void dropRoutes(const std::function<bool(rtnl_route*)>& predicate, bool notify);
 
     velia::Log m_log;
     std::unique_ptr<nl_sock, std::function<void(nl_sock*)>> m_nlSocket;
     nlCacheManager m_nlCacheManager; // for updates
     nl_cache* m_nlManagedCacheLink;
     nl_cache* m_nlManagedCacheAddr;
-    nl_cache* m_nlManagedCacheRoute;
-    nlCache m_nlCacheLink; // for getLinks, getNeighbours
-    nlCache m_nlCacheNeighbour; // for getNeighbours
-    nlCache m_nlCacheRoute; // for getRoutes
+    nl_cache* m_nlManagedCacheNeigh;
+    nlCache m_nlCacheLink; // for getLinks
+    std::mutex m_cacheMtx; // getters can be invoked from multiple threads, protects the unmanaged caches above and m_nlSocket
+    RouteTables m_routeTablesConfig;
+    std::set<uint32_t> m_routeTables; // the table IDs which are currently tracked, including those of the VRFs
+    nlCache m_nlTrackedCacheRoute; // routes from m_routeTables, kept up to date by the notifications from m_nlRouteSocket
+    std::unique_ptr<nl_sock, std::function<void(nl_sock*)>> m_nlRouteSocket; // subscribed to the route notifications
+    std::unique_ptr<nl_sock, std::function<void(nl_sock*)>> m_nlRouteDumpSocket; // for the per-table route dumps, with strict checking
+    std::mutex m_routeMtx; // protects m_routeTables, m_nlTrackedCacheRoute and both route sockets
+    std::unique_ptr<nl_sock, std::function<void(nl_sock*)>> m_nlStatsSocket; // for getLinkStatistics, with strict checking of the dump requests
+    std::mutex m_statsMtx; // protects m_nlStatsSocket
+    std::unique_ptr<nl_sock, std::function<void(nl_sock*)>> m_nlEthtoolSocket; // for getEthtoolLinkInfo, NETLINK_GENERIC
+    int m_ethtoolFamily; // generic netlink family ID of ethtool, or -1 when the kernel does not support ethtool-netlink
+    std::mutex m_ethtoolMtx; // protects m_nlEthtoolSocket
     LinkCB m_cbLink;
     AddrCB m_cbAddr;
     RouteCB m_cbRoute;
-    std::unique_ptr<impl::nlCacheMngrWatcher> m_nlCacheMngrWatcher; // first to destroy, because the thread uses m_nlCacheManager and m_log
+    NeighCB m_cbNeigh;
+    std::atomic<uint64_t> m_overruns;
+    std::unique_ptr<impl::nlCacheMngrWatcher> m_nlCacheMngrWatcher; // first to destroy, because the thread dispatches the callbacks through this instance
 };
 
 class RtnetlinkException : public std::runtime_error {
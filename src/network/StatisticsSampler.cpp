@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <cmath>
+#include "StatisticsSampler.h"
+#include "utils/log.h"
+
+namespace {
+
+bool wentBackwards(const velia::network::InterfaceCounters& older, const velia::network::InterfaceCounters& newer)
+{
+    return newer.inOctets < older.inOctets || newer.inPackets < older.inPackets || newer.inMulticastPackets < older.inMulticastPackets
+        || newer.inDiscards < older.inDiscards || newer.inErrors < older.inErrors || newer.inUnknownProtos < older.inUnknownProtos
+        || newer.outOctets < older.outOctets || newer.outPackets < older.outPackets || newer.outDiscards < older.outDiscards || newer.outErrors < older.outErrors;
+}
+
+uint64_t perSecond(uint64_t older, uint64_t newer, double seconds, unsigned multiplier = 1)
+{
+    return std::llround(static_cast<double>(newer - older) * multiplier / seconds);
+}
+}
+
+namespace velia::network {
+
+/** @brief Takes the first sample right away and then keeps sampling every @p interval in a background thread */
+StatisticsSampler::StatisticsSampler(Source source, std::chrono::milliseconds interval, std::chrono::milliseconds window)
+    : m_log(spdlog::get("network"))
+    , m_source(std::move(source))
+    , m_window(window)
+    , m_task([this]() { sample(); }, interval)
+{
+}
+
+void StatisticsSampler::sample(std::chrono::steady_clock::time_point now)
+{
+    std::map<std::string, InterfaceCounters> current;
+    try {
+        current = m_source();
+    } catch (const std::exception& e) {
+        m_log->warn("Cannot sample interface statistics: {}", e.what());
+        return;
+    }
+
+    std::lock_guard lock(m_dataMtx);
+    std::erase_if(m_history, [&current](const auto& entry) { return !current.contains(entry.first); });
+    m_snapshot.clear();
+
+    for (const auto& [name, counters] : current) {
+        auto& history = m_history[name];
+        if (!history.empty() && wentBackwards(history.back().second, counters)) {
+            history.clear();
+        }
+        history.emplace_back(now, counters);
+
+        // keep the newest sample which is at least as old as the window, drop the rest of the older ones
+        while (history.size() > 2 && now - history[1].first >= m_window) {
+            history.pop_front();
+        }
+
+        InterfaceStatistics stats{.counters = counters, .rates = std::nullopt};
+        if (history.size() >= 2) {
+            const auto& [then, oldCounters] = history.front();
+            const auto seconds = std::chrono::duration<double>(now - then).count();
+            if (seconds > 0) {
+                stats.rates = InterfaceRates{
+                    .inBitsPerSecond = perSecond(oldCounters.inOctets, counters.inOctets, seconds, 8),
+                    .outBitsPerSecond = perSecond(oldCounters.outOctets, counters.outOctets, seconds, 8),
+                    .inPacketsPerSecond = perSecond(oldCounters.inPackets, counters.inPackets, seconds),
+                    .outPacketsPerSecond = perSecond(oldCounters.outPackets, counters.outPackets, seconds),
+                };
+            }
+        }
+        m_snapshot.emplace(name, stats);
+    }
+}
+
+std::map<std::string, InterfaceStatistics> StatisticsSampler::snapshot() const
+{
+    std::lock_guard lock(m_dataMtx);
+    return m_snapshot;
+}
+}
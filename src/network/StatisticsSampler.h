@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include "utils/log-fwd.h"
+#include "utils/periodic.h"
+
+namespace velia::network {
+
+struct InterfaceCounters {
+    uint64_t inOctets;
+    uint64_t inPackets;
+    uint64_t inMulticastPackets;
+    uint64_t inDiscards;
+    uint64_t inErrors;
+    uint64_t inUnknownProtos;
+    uint64_t outOctets;
+    uint64_t outPackets;
+    uint64_t outDiscards;
+    uint64_t outErrors;
+
+    bool operator==(const InterfaceCounters&) const = default;
+};
+
+struct InterfaceRates {
+    uint64_t inBitsPerSecond;
+    uint64_t outBitsPerSecond;
+    uint64_t inPacketsPerSecond;
+    uint64_t outPacketsPerSecond;
+
+    bool operator==(const InterfaceRates&) const = default;
+};
+
+struct InterfaceStatistics {
+    InterfaceCounters counters;
+    std::optional<InterfaceRates> rates;
+
+    bool operator==(const InterfaceStatistics&) const = default;
+};
+
+/** @brief Periodically samples interface counters, so that the readers are served from a snapshot instead of querying the kernel each time
+ *
+ * Besides the counters, average rates are computed over a sliding window of the recent samples. The window covers at least
+ * the requested duration (or as much as is available), and always at least two samples. The history of an interface starts
+ * over when its counters go backwards, e.g., when the interface is recreated.
+ */
+class StatisticsSampler {
+public:
+    using Source = std::function<std::map<std::string, InterfaceCounters>()>;
+
+    StatisticsSampler(Source source, std::chrono::milliseconds interval, std::chrono::milliseconds window);
+    void sample(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+    std::map<std::string, InterfaceStatistics> snapshot() const;
+
+private:
+    using Sample = std::pair<std::chrono::steady_clock::time_point, InterfaceCounters>;
+
+    velia::Log m_log;
+    Source m_source;
+    std::chrono::milliseconds m_window;
+
+    mutable std::mutex m_dataMtx; ///< protects m_history and m_snapshot
+    std::map<std::string, std::deque<Sample>> m_history;
+    std::map<std::string, InterfaceStatistics> m_snapshot;
+
+    utils::PeriodicTask m_task; // last, so that the background sampling stops before the rest is destroyed
+};
+}
@@ -7,7 +7,6 @@
 
 #include <filesystem>
 #include <fmt/format.h>
-#include <fstream>
 #include <regex>
 #include "JournalUpload.h"
 #include "utils/io.h"
@@ -50,8 +49,7 @@ sysrepo::ErrorCode configureJournalUpload(velia::Log log, const std::optional<st
 
     if (oldContent != newContent) {
         if (newContent) {
-            std::ofstream ofs(envFile);
-            ofs << *newContent;
+            velia::utils::safeWriteFile(envFile, *newContent);
 
             newContent->pop_back(); // remove the \n
             log->trace("systemd-journal-upload.service environment file {} set to {}", std::string(envFile), *newContent);
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "debounce.h"
+
+namespace velia::utils {
+
+Debouncer::Debouncer(std::function<void()> callback, std::chrono::milliseconds quietPeriod, std::chrono::milliseconds maxDelay)
+    : m_callback(std::move(callback))
+    , m_quietPeriod(quietPeriod)
+    , m_maxDelay(maxDelay)
+    , m_immediate(false)
+    , m_terminate(false)
+    , m_thread(&Debouncer::run, this)
+{
+}
+
+Debouncer::~Debouncer()
+{
+    {
+        std::lock_guard lock(m_mtx);
+        m_terminate = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void Debouncer::trigger()
+{
+    {
+        std::lock_guard lock(m_mtx);
+        m_lastTrigger = std::chrono::steady_clock::now();
+        if (!m_firstTrigger) {
+            m_firstTrigger = m_lastTrigger;
+        }
+    }
+    m_cv.notify_all();
+}
+
+/** @brief Like trigger(), but the callback is invoked right away, without waiting for the quiet period */
+void Debouncer::triggerNow()
+{
+    {
+        std::lock_guard lock(m_mtx);
+        m_lastTrigger = std::chrono::steady_clock::now();
+        if (!m_firstTrigger) {
+            m_firstTrigger = m_lastTrigger;
+        }
+        m_immediate = true;
+    }
+    m_cv.notify_all();
+}
+
+void Debouncer::run()
+{
+    std::unique_lock lock(m_mtx);
+    while (!m_terminate) {
+        if (!m_firstTrigger) {
+            m_cv.wait(lock, [this] { return m_terminate || m_firstTrigger; });
+            continue;
+        }
+
+        auto deadline = std::min(m_lastTrigger + m_quietPeriod, *m_firstTrigger + m_maxDelay);
+        if (!m_immediate && std::chrono::steady_clock::now() < deadline) {
+            m_cv.wait_until(lock, deadline);
+            continue;
+        }
+
+        m_firstTrigger.reset();
+        m_immediate = false;
+        lock.unlock();
+        m_callback();
+        lock.lock();
+    }
+}
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace velia::utils {
+
+/** @short Coalesces bursts of trigger() calls into a single invocation of a callback
+ *
+ * The callback is invoked from a background thread once there have been no further triggers for the quiet period.
+ * When the triggers keep coming, the callback is invoked anyway when the maximal delay since the first unhandled trigger elapses.
+ * Triggers which arrive while the callback runs schedule another invocation. Pending invocations are dropped on destruction.
+ * Use triggerNow() when the caller knows that there is no point in waiting any longer, e.g., when it has accumulated enough work.
+ */
+class Debouncer {
+public:
+    Debouncer(std::function<void()> callback, std::chrono::milliseconds quietPeriod, std::chrono::milliseconds maxDelay);
+    ~Debouncer();
+    Debouncer(const Debouncer&) = delete;
+    Debouncer& operator=(const Debouncer&) = delete;
+
+    void trigger();
+    void triggerNow();
+
+private:
+    void run();
+
+    std::function<void()> m_callback;
+    std::chrono::milliseconds m_quietPeriod;
+    std::chrono::milliseconds m_maxDelay;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::optional<std::chrono::steady_clock::time_point> m_firstTrigger;
+    std::chrono::steady_clock::time_point m_lastTrigger;
+    bool m_immediate;
+    bool m_terminate;
+    std::thread m_thread;
+};
+}
@@ -5,73 +5,322 @@
  *
 */
 
+#include <array>
 #include <boost/algorithm/string/join.hpp>
-#include <boost/version.hpp>
-#if BOOST_VERSION < 108800
-#include <boost/process.hpp>
-#include <boost/process/extend.hpp>
-#else
-#define BOOST_PROCESS_VERSION 1
-#include <boost/process/v1/args.hpp>
-#include <boost/process/v1/child.hpp>
-#include <boost/process/v1/extend.hpp>
-#include <boost/process/v1/io.hpp>
-#include <boost/process/v1/pipe.hpp>
-#endif
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <utility>
 
+#include "UniqueResource.h"
 #include "exec.h"
 #include "log.h"
 #include "system_vars.h"
 
-std::string velia::utils::execAndWait(
-        velia::Log logger,
-        const std::string& absolutePath,
-        std::initializer_list<std::string> args,
-        std::string_view std_in,
-        const std::set<ExecOptions> opts)
+namespace {
+
+/** @brief Closes a file descriptor when it goes out of scope */
+class FD {
+public:
+    explicit FD(int fd = -1)
+        : m_fd(fd)
+    {
+    }
+    ~FD()
+    {
+        reset();
+    }
+    FD(const FD&) = delete;
+    FD& operator=(const FD&) = delete;
+    FD& operator=(FD&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            m_fd = std::exchange(other.m_fd, -1);
+        }
+        return *this;
+    }
+
+    int get() const
+    {
+        return m_fd;
+    }
+    void reset()
+    {
+        if (m_fd != -1) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+private:
+    int m_fd;
+};
+
+struct Pipe {
+    FD read, write;
+
+    Pipe()
+    {
+        std::array<int, 2> fds;
+        if (pipe2(fds.data(), O_CLOEXEC) == -1) {
+            throw std::system_error(errno, std::system_category(), "pipe2");
+        }
+        read = FD{fds[0]};
+        write = FD{fds[1]};
+    }
+};
+
+void setNonBlocking(int fd)
 {
-    namespace bp = boost::process;
-    bp::pipe stdinPipe;
-    bp::ipstream stdoutStream;
-    bp::ipstream stderrStream;
-
-    auto onExecSetup = [opts] (const auto&) {
-        if (opts.count(ExecOptions::DropRoot) == 1) {
-            if (getuid() == 0) {
-                if (setgid(NOBODY_GID) == -1) {
-                    perror("couldn't drop root privileges");
-                    exit(1);
-                }
-
-                if (setuid(NOBODY_UID) == -1) {
-                    perror("couldn't drop root privileges");
-                    exit(1);
-                }
-            }
+    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == -1) {
+        throw std::system_error(errno, std::system_category(), "fcntl(O_NONBLOCK)");
+    }
+}
+
+/** @brief write() which reports EPIPE instead of raising SIGPIPE when the reader has gone away */
+ssize_t writeNoSigpipe(int fd, const char* data, size_t size)
+{
+    sigset_t sigpipe, oldMask;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe, &oldMask);
+
+    auto len = ::write(fd, data, size);
+    auto err = errno;
+    if (len == -1 && err == EPIPE) {
+        // consume the SIGPIPE which is now pending for this thread
+        timespec noWait{};
+        sigtimedwait(&sigpipe, nullptr, &noWait);
+    }
+
+    pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+    errno = err;
+    return len;
+}
+
+/** @brief Reads whatever is available in a non-blocking @p fd. Returns false on EOF. */
+bool drain(int fd, std::string& buffer)
+{
+    std::array<char, 16384> chunk;
+    while (true) {
+        auto len = ::read(fd, chunk.data(), chunk.size());
+        if (len > 0) {
+            buffer.append(chunk.data(), len);
+        } else if (len == 0) {
+            return false;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN) {
+            return true;
+        } else {
+            throw std::system_error(errno, std::system_category(), "read");
         }
-    };
+    }
+}
+
+/** @brief Runs the child process and supervises it until it exits, times out or a stop is requested
+ *
+ * The stdin is fed, and the stdout and stderr are drained, concurrently, so that a chatty child cannot block on a full pipe.
+ */
+std::string run(velia::Log logger, const std::string& absolutePath, const std::vector<std::string>& args, std::string_view std_in, const std::set<velia::utils::ExecOptions>& opts, std::optional<std::chrono::milliseconds> timeout, std::stop_token stopToken)
+{
+    const auto deadline = timeout ? std::optional{std::chrono::steady_clock::now() + *timeout} : std::nullopt;
+
+    Pipe stdinPipe, stdoutPipe, stderrPipe;
+
+    // everything the child needs is prepared in advance, a vfork()-ed child must not allocate
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(absolutePath.c_str()));
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    const bool dropRoot = opts.contains(velia::utils::ExecOptions::DropRoot) && getuid() == 0;
 
     logger->trace("exec: {} {}", absolutePath, boost::algorithm::join(args, " "));
-    bp::child c(
-            absolutePath,
-            boost::process::args=args,
-            bp::std_in < stdinPipe, bp::std_out > stdoutStream, bp::std_err > stderrStream,
-            bp::extend::on_exec_setup=onExecSetup);
+    auto pid = vfork();
+    if (pid == -1) {
+        throw std::system_error(errno, std::system_category(), "vfork");
+    }
+
+    if (pid == 0) {
+        // dup2() clears O_CLOEXEC on the target fd, everything else gets closed by execv()
+        if (dup2(stdinPipe.read.get(), STDIN_FILENO) == -1 || dup2(stdoutPipe.write.get(), STDOUT_FILENO) == -1 || dup2(stderrPipe.write.get(), STDERR_FILENO) == -1) {
+            _exit(127);
+        }
+        // not the libc wrappers, these would synchronize the credentials with the other threads of the parent
+        if (dropRoot && (syscall(SYS_setgid, NOBODY_GID) == -1 || syscall(SYS_setuid, NOBODY_UID) == -1)) {
+            constexpr std::string_view msg = "couldn't drop root privileges\n";
+            [[maybe_unused]] auto ignored = ::write(STDERR_FILENO, msg.data(), msg.size());
+            _exit(1);
+        }
+        execv(absolutePath.c_str(), argv.data());
+        _exit(127);
+    }
+
+    // whatever fails from now on, the child must not outlive this function
+    bool reaped = false;
+    auto reaper = velia::utils::make_unique_resource([] {}, [pid, &reaped] {
+        if (!reaped) {
+            kill(pid, SIGKILL);
+            while (waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {
+            }
+        }
+    });
+
+    stdinPipe.read.reset();
+    stdoutPipe.write.reset();
+    stderrPipe.write.reset();
 
-    stdinPipe.write(std_in.data(), std_in.size());
-    stdinPipe.close();
+    FD pidFd{static_cast<int>(syscall(SYS_pidfd_open, pid, 0))};
+    if (pidFd.get() == -1) {
+        throw std::system_error(errno, std::system_category(), "pidfd_open");
+    }
+
+    FD stopFd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+    std::stop_callback onStop(stopToken, [&stopFd]() {
+        uint64_t one = 1;
+        [[maybe_unused]] auto ignored = ::write(stopFd.get(), &one, sizeof(one));
+    });
+
+    for (int fd : {stdinPipe.write.get(), stdoutPipe.read.get(), stderrPipe.read.get()}) {
+        setNonBlocking(fd);
+    }
+
+    std::string stdoutOutput, stderrOutput;
+    size_t stdinOffset = 0;
+    bool stdoutOpen = true, stderrOpen = true;
+    std::optional<std::string> killReason;
+
+    if (std_in.empty()) {
+        stdinPipe.write.reset();
+    }
+
+    while (true) {
+        std::array<pollfd, 5> fds{{
+            {.fd = pidFd.get(), .events = POLLIN, .revents = 0},
+            {.fd = stopFd.get(), .events = POLLIN, .revents = 0},
+            {.fd = stdoutOpen ? stdoutPipe.read.get() : -1, .events = POLLIN, .revents = 0},
+            {.fd = stderrOpen ? stderrPipe.read.get() : -1, .events = POLLIN, .revents = 0},
+            {.fd = stdinPipe.write.get(), .events = POLLOUT, .revents = 0},
+        }};
+
+        int pollTimeout = -1;
+        if (deadline) {
+            pollTimeout = std::max<int>(0, std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now()).count());
+        }
+
+        if (::poll(fds.data(), fds.size(), pollTimeout) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category(), "poll");
+        }
+
+        if (fds[2].revents) {
+            stdoutOpen = drain(stdoutPipe.read.get(), stdoutOutput);
+        }
+        if (fds[3].revents) {
+            stderrOpen = drain(stderrPipe.read.get(), stderrOutput);
+        }
+        if (fds[4].revents & (POLLERR | POLLHUP)) {
+            // the child does not want any more input
+            stdinPipe.write.reset();
+        } else if (fds[4].revents) {
+            auto len = writeNoSigpipe(stdinPipe.write.get(), std_in.data() + stdinOffset, std_in.size() - stdinOffset);
+            if (len == -1 && errno != EAGAIN && errno != EINTR) {
+                stdinPipe.write.reset();
+            } else if (len > 0 && (stdinOffset += len) == std_in.size()) {
+                stdinPipe.write.reset();
+            }
+        }
+
+        if (fds[0].revents) {
+            // all that the child wrote is in the pipes by now; grandchildren which inherited the pipes are not waited for
+            if (stdoutOpen) {
+                drain(stdoutPipe.read.get(), stdoutOutput);
+            }
+            if (stderrOpen) {
+                drain(stderrPipe.read.get(), stderrOutput);
+            }
+            break;
+        }
+
+        if (fds[1].revents) {
+            killReason = "cancelled";
+        } else if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+            killReason = "timed out";
+        }
 
-    c.wait();
+        if (killReason) {
+            syscall(SYS_pidfd_send_signal, pidFd.get(), SIGKILL, nullptr, 0);
+            break;
+        }
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::system_category(), "waitpid");
+        }
+    }
+    reaped = true;
     logger->trace("{} exited", absolutePath);
 
-    if (c.exit_code()) {
-        std::istreambuf_iterator<char> begin(stderrStream), end;
-        std::string stderrOutput(begin, end);
+    if (killReason) {
+        logger->critical("{} {}, killed. stderr: {}", absolutePath, *killReason, stderrOutput);
+        throw std::runtime_error(absolutePath + " " + *killReason);
+    }
+
+    int exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    if (exitCode) {
         logger->critical("{} ended with a non-zero exit code. stderr: {}", absolutePath, stderrOutput);
 
-        throw std::runtime_error(absolutePath + " returned non-zero exit code " + std::to_string(c.exit_code()));
+        throw std::runtime_error(absolutePath + " returned non-zero exit code " + std::to_string(exitCode));
     }
 
-    std::istreambuf_iterator<char> begin(stdoutStream), end;
-    return {begin, end};
+    return stdoutOutput;
+}
+}
+
+std::string velia::utils::execAndWait(
+        velia::Log logger,
+        const std::string& absolutePath,
+        std::initializer_list<std::string> args,
+        std::string_view std_in,
+        const std::set<ExecOptions> opts,
+        std::chrono::milliseconds timeout)
+{
+    return run(logger, absolutePath, args, std_in, opts, timeout, {});
+}
+
+std::future<std::string> velia::utils::execAsync(
+        velia::Log logger,
+        const std::string& absolutePath,
+        std::vector<std::string> args,
+        std::string std_in,
+        const std::set<ExecOptions> opts,
+        std::optional<std::chrono::milliseconds> timeout,
+        std::stop_token stopToken)
+{
+    std::promise<std::string> promise;
+    auto future = promise.get_future();
+
+    std::thread([=, promise = std::move(promise)]() mutable {
+        try {
+            promise.set_value(run(logger, absolutePath, args, std_in, opts, timeout, stopToken));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }).detach();
+
+    return future;
 }
@@ -6,15 +6,27 @@
 */
 
 #pragma once
+#include <chrono>
+#include <future>
+#include <optional>
 #include <set>
+#include <stop_token>
 #include <string>
+#include <vector>
 #include "log-fwd.h"
 
 namespace velia::utils {
+enum class ExecOptions {
+    DropRoot
+};
+
+/** @brief How long execAndWait() lets the child process run before killing it */
+constexpr auto EXEC_DEFAULT_TIMEOUT = std::chrono::minutes{2};
+
 /**
  * Spawns a new process with an executable specified by `absolutePath` and waits until it returns. The return value is
  * the stdout of the process. Throws if the program has a non-zero exit code with a message containing the stderr of the
- * process.
+ * process. The process is killed (and this throws) when it does not finish within the @p timeout.
  *
  * @param logger Logger to use.
  * @param absolutePath Full path to the excutable.
@@ -22,8 +34,12 @@ namespace velia::utils {
  * @param std_in stdin input fo the program.
  * @return stdout of the command
  */
-enum class ExecOptions {
-    DropRoot
-};
-std::string execAndWait(velia::Log logger, const std::string& absolutePath, std::initializer_list<std::string> args, std::string_view std_in, const std::set<ExecOptions> opts = {});
+std::string execAndWait(velia::Log logger, const std::string& absolutePath, std::initializer_list<std::string> args, std::string_view std_in, const std::set<ExecOptions> opts = {}, std::chrono::milliseconds timeout = EXEC_DEFAULT_TIMEOUT);
+
+/**
+ * Like execAndWait(), but the process is supervised by a background thread and the result is delivered through a future.
+ * The process is killed when the @p timeout elapses or when a stop is requested through the @p stopToken; the future then
+ * holds an exception.
+ */
+std::future<std::string> execAsync(velia::Log logger, const std::string& absolutePath, std::vector<std::string> args, std::string std_in, const std::set<ExecOptions> opts = {}, std::optional<std::chrono::milliseconds> timeout = std::nullopt, std::stop_token stopToken = {});
 }
@@ -5,9 +5,12 @@
  *
 */
 
+#include <algorithm>
 #include <cstring>
+#include <fcntl.h>
 #include <fmt/format.h>
 #include <fstream>
+#include <set>
 #include <unistd.h>
 #include "io.h"
 
@@ -97,41 +100,108 @@ void writeFile(const std::string& path, const std::string_view& contents)
 
 void safeWriteFile(const std::string& filename, const std::string_view& contents)
 {
-    auto throwErr = [&filename] (const auto& what) {
-        throw std::runtime_error(fmt::format("Couldn't write file '{}' ({}) ({})", filename, what, std::strerror(errno)));
-    };
-    // FIXME: not sure if just the tilde is fine...
-    auto tempFileName = (filename + "~");
-    auto f = std::fopen(tempFileName.c_str(), "w");
-    if (!f) {
-        throwErr("fopen");
-    }
-    if (contents.size() > 0 && std::fwrite(contents.data(), contents.size(), 1, f) != 1) {
-        throwErr("fwrite");
-    }
-    if (fsync(fileno(f)) == -1) {
-        throwErr("fsync");
-    }
-    if (std::fclose(f) == -1) {
-        throwErr("fclose");
-    }
+    FileTransaction transaction;
+    transaction.write(filename, contents);
+    transaction.commit();
+}
 
+/** @brief Atomically replaces @p filename, but without waiting for the data to hit the disk
+ *
+ * Suitable for frequently rewritten files which are only of interest while the system is running.
+ */
+void replaceFile(const std::filesystem::path& filename, std::string_view contents)
+{
+    const auto tempFileName = filename.string() + "~";
+    writeFile(tempFileName, contents);
     try {
-        std::filesystem::rename(tempFileName.c_str(), filename.c_str());
-    } catch (const std::filesystem::filesystem_error&) {
-        throwErr("rename");
+        std::filesystem::rename(tempFileName, filename);
+    } catch (const std::filesystem::filesystem_error& e) {
+        throw std::invalid_argument("File '" + filename.string() + "' could not be replaced (" + e.what() + ")");
     }
+}
 
-    auto dirName = std::filesystem::path(filename).parent_path();
-    auto fdir = std::fopen(dirName.c_str(), "r");
-    if (!fdir) {
-        throwErr("fopen");
+/** @brief Stages new @p contents of @p filename. Writing the same file again in a single transaction replaces the staged contents. */
+void FileTransaction::write(const std::filesystem::path& filename, std::string_view contents)
+{
+    if (auto it = std::find_if(m_files.begin(), m_files.end(), [&filename](const auto& file) { return file.first == filename; }); it != m_files.end()) {
+        it->second = contents;
+    } else {
+        m_files.emplace_back(filename, contents);
     }
-    if (fsync(fileno(fdir)) == -1) {
-        throwErr("fsync");
+}
+
+bool FileTransaction::empty() const
+{
+    return m_files.empty();
+}
+
+/** @brief Writes all the staged files and returns the number of bytes written. The transaction is empty afterwards. */
+size_t FileTransaction::commit()
+{
+    auto throwErr = [](const std::filesystem::path& filename, const auto& what) {
+        throw std::runtime_error(fmt::format("Couldn't write file '{}' ({}) ({})", filename.string(), what, std::strerror(errno)));
+    };
+    auto tempFileName = [](const std::filesystem::path& filename) {
+        // FIXME: not sure if just the tilde is fine...
+        return filename.string() + "~";
+    };
+
+    auto files = std::exchange(m_files, {});
+    size_t bytesWritten = 0;
+
+    for (const auto& [filename, contents] : files) {
+        auto fd = ::open(tempFileName(filename).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (fd == -1) {
+            throwErr(filename, "open");
+        }
+
+        for (size_t offset = 0; offset < contents.size();) {
+            auto written = ::write(fd, contents.data() + offset, contents.size() - offset);
+            if (written == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ::close(fd);
+                throwErr(filename, "write");
+            }
+            offset += written;
+        }
+        bytesWritten += contents.size();
+
+        // a freshly created file has no metadata that fdatasync() would skip
+        if (fdatasync(fd) == -1) {
+            ::close(fd);
+            throwErr(filename, "fdatasync");
+        }
+        if (::close(fd) == -1) {
+            throwErr(filename, "close");
+        }
     }
-    if (std::fclose(fdir) == -1) {
-        throwErr("fclose");
+
+    std::set<std::filesystem::path> directories;
+    for (const auto& [filename, contents] : files) {
+        try {
+            std::filesystem::rename(tempFileName(filename), filename);
+        } catch (const std::filesystem::filesystem_error&) {
+            throwErr(filename, "rename");
+        }
+        directories.insert(filename.parent_path());
     }
+
+    for (const auto& dirName : directories) {
+        auto fd = ::open(dirName.empty() ? "." : dirName.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1) {
+            throwErr(dirName, "open");
+        }
+        if (fsync(fd) == -1) {
+            ::close(fd);
+            throwErr(dirName, "fsync");
+        }
+        if (::close(fd) == -1) {
+            throwErr(dirName, "close");
+        }
+    }
+
+    return bytesWritten;
 }
 }
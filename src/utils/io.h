@@ -9,6 +9,7 @@
 
 #include <filesystem>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace velia::utils {
@@ -21,4 +22,21 @@ std::string readFileToString(const std::filesystem::path& path);
 std::vector<uint8_t> readFileToBytes(const std::filesystem::path& path);
 void writeFile(const std::string& path, const std::string_view& contents);
 void safeWriteFile(const std::string& filename, const std::string_view& contents);
+void replaceFile(const std::filesystem::path& filename, std::string_view contents);
+
+/** @brief Atomically replaces several files at once
+ *
+ * The contents are staged in memory by write(). The commit() writes each file to a temporary one and syncs it, renames all of
+ * them to their final names and then syncs each of the affected directories just once. That saves one directory fsync per
+ * file compared to calling safeWriteFile() for each file separately.
+ */
+class FileTransaction {
+public:
+    void write(const std::filesystem::path& filename, std::string_view contents);
+    size_t commit();
+    bool empty() const;
+
+private:
+    std::vector<std::pair<std::filesystem::path, std::string>> m_files;
+};
 }
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <fmt/format.h>
+#include "openmetrics.h"
+
+namespace velia::utils::openmetrics {
+
+/** @short Escape a string so that it can be used as a label value, i.e., within double quotes */
+std::string escapeLabelValue(const std::string& value)
+{
+    std::string res;
+    res.reserve(value.size());
+
+    for (const auto c : value) {
+        switch (c) {
+        case '\\':
+            res += "\\\\";
+            break;
+        case '"':
+            res += "\\\"";
+            break;
+        case '\n':
+            res += "\\n";
+            break;
+        default:
+            res += c;
+        }
+    }
+
+    return res;
+}
+
+void Builder::family(const std::string& name, const std::string& type, const std::string& help)
+{
+    m_out << "# TYPE " << name << " " << type << "\n";
+    m_out << "# HELP " << name << " " << help << "\n";
+}
+
+void Builder::sample(const std::string& name, const Labels& labels, int64_t value)
+{
+    sampleImpl(name, labels, std::to_string(value));
+}
+
+void Builder::sample(const std::string& name, const Labels& labels, uint64_t value)
+{
+    sampleImpl(name, labels, std::to_string(value));
+}
+
+void Builder::sample(const std::string& name, const Labels& labels, double value)
+{
+    sampleImpl(name, labels, fmt::format("{}", value));
+}
+
+void Builder::sampleImpl(const std::string& name, const Labels& labels, const std::string& value)
+{
+    m_out << name;
+
+    if (!labels.empty()) {
+        m_out << "{";
+        for (auto it = labels.begin(); it != labels.end(); ++it) {
+            if (it != labels.begin()) {
+                m_out << ",";
+            }
+            m_out << it->first << "=\"" << escapeLabelValue(it->second) << "\"";
+        }
+        m_out << "}";
+    }
+
+    m_out << " " << value << "\n";
+}
+
+std::string Builder::str() const
+{
+    return m_out.str();
+}
+}
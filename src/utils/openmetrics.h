@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace velia::utils::openmetrics {
+
+using Labels = std::map<std::string, std::string>;
+
+/** @short Incremental builder of a document in the Prometheus text exposition format
+ *
+ * All samples of one metric family have to be added right after the family() call which introduces them, and their name has to be
+ * the same as the name of the family. The consumer is node_exporter's textfile collector which only knows the Prometheus types,
+ * i.e., none of the OpenMetrics extensions such as `stateset` or the `# EOF` marker can be used.
+ */
+class Builder {
+public:
+    void family(const std::string& name, const std::string& type, const std::string& help);
+    void sample(const std::string& name, const Labels& labels, int64_t value);
+    void sample(const std::string& name, const Labels& labels, uint64_t value);
+    void sample(const std::string& name, const Labels& labels, double value);
+    std::string str() const;
+
+private:
+    void sampleImpl(const std::string& name, const Labels& labels, const std::string& value);
+    std::ostringstream m_out;
+};
+
+std::string escapeLabelValue(const std::string& value);
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "periodic.h"
+
+namespace velia::utils {
+
+PeriodicTask::PeriodicTask(std::function<void()> task, std::chrono::milliseconds interval)
+    : m_task(std::move(task))
+    , m_interval(interval)
+    , m_quit(false)
+{
+    m_task();
+
+    m_thread = std::thread([this]() {
+        std::unique_lock lock(m_mtx);
+        while (!m_cv.wait_for(lock, m_interval, [this] { return m_quit; })) {
+            lock.unlock();
+            m_task();
+            lock.lock();
+        }
+    });
+}
+
+PeriodicTask::~PeriodicTask()
+{
+    {
+        std::lock_guard lock(m_mtx);
+        m_quit = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace velia::utils {
+
+/** @short Runs a task right away, and then periodically in a background thread until destroyed
+ *
+ * The first run happens in the constructor, so that the owner has its data ready as soon as it is constructed. The destructor
+ * waits for the run which is in progress, if any.
+ */
+class PeriodicTask {
+public:
+    PeriodicTask(std::function<void()> task, std::chrono::milliseconds interval);
+    ~PeriodicTask();
+    PeriodicTask(const PeriodicTask&) = delete;
+    PeriodicTask& operator=(const PeriodicTask&) = delete;
+
+private:
+    std::function<void()> m_task;
+    std::chrono::milliseconds m_interval;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    bool m_quit;
+    std::thread m_thread;
+};
+}
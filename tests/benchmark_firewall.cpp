@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include <sysrepo-cpp/Connection.hpp>
+#include "firewall/Firewall.h"
+
+using namespace std::literals;
+
+static void generateNftConfig(benchmark::State& state)
+{
+    auto session = sysrepo::Connection{}.sessionStart();
+    const auto acl = "/ietf-access-control-list:acls/acl[name='acls']"s;
+
+    auto tree = session.getContext().newPath(acl + "/type", "mixed-eth-ipv4-ipv6-acl-type");
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        const auto ace = acl + "/aces/ace[name='rule " + std::to_string(i) + "']";
+        if (i % 2) {
+            tree.newPath(ace + "/matches/ipv6/source-ipv6-network", "2001:db8::" + std::to_string(i % 10'000) + "/128");
+        } else {
+            tree.newPath(ace + "/matches/ipv4/source-ipv4-network", "10." + std::to_string(i / 256 / 256 % 256) + "." + std::to_string(i / 256 % 256) + "." + std::to_string(i % 256) + "/32");
+        }
+        tree.newPath(ace + "/actions/forwarding", i % 3 ? "accept" : "drop");
+    }
+
+    const auto logger = spdlog::get("firewall");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(velia::firewall::generateNftConfig(logger, tree, {}));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(generateNftConfig)->RangeMultiplier(10)->Range(10, 10'000)->Unit(benchmark::kMicrosecond);
+
+static void generateNftUpdate(benchmark::State& state)
+{
+    velia::firewall::InstalledRules installed{.rules = {}, .handles = {}, .anchor = 4};
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        const auto name = "rule " + std::to_string(i);
+        installed.rules.push_back({name, "ip saddr 10.0.0.0/32 drop comment \"" + name + "\""});
+        installed.handles.emplace(name, i + 5);
+    }
+
+    // one ACE is changed, one is moved to the front and one is removed
+    auto rules = installed.rules;
+    rules[rules.size() / 2].statement = "ip saddr 10.0.0.0/32 accept comment \"" + rules[rules.size() / 2].name + "\"";
+    std::rotate(rules.begin(), rules.end() - 1, rules.end());
+    rules.erase(rules.begin() + 1);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(velia::firewall::generateNftUpdate(installed, rules));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(generateNftUpdate)->RangeMultiplier(10)->Range(10, 10'000)->Unit(benchmark::kMicrosecond);
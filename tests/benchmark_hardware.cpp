@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include "fs-helpers/SyntheticSysfs.h"
+#include "ietf-hardware/IETFHardware.h"
+#include "ietf-hardware/sysfs/IpmiFruEEPROM.h"
+#include "ietf-hardware/sysfs/OnieEEPROM.h"
+#include "tests/configure.cmake.h"
+
+using namespace std::literals;
+using namespace velia::ietf_hardware;
+
+namespace {
+
+const auto sysfsPrefix = CMAKE_CURRENT_SOURCE_DIR + "/tests/sysfs/"s;
+const auto fakeSysfsRoot = CMAKE_CURRENT_BINARY_DIR + "/tests/benchmark_hardware/"s;
+
+/** @short IETFHardware of a synthetic chassis with @p lineCards line cards, 16 temperature sensors on each of them */
+std::pair<std::unique_ptr<SyntheticSysfs>, std::shared_ptr<IETFHardware>> createHardware(int lineCards)
+{
+    auto sysfs = std::make_unique<SyntheticSysfs>(fakeSysfsRoot, SyntheticSysfs::Layout{.lineCards = static_cast<unsigned>(lineCards)});
+    auto ietfHardware = std::make_shared<IETFHardware>();
+    sysfs->registerDataReaders(*ietfHardware);
+    return {std::move(sysfs), ietfHardware};
+}
+}
+
+static void ietfHardwareProcess(benchmark::State& state)
+{
+    auto [sysfs, ietfHardware] = createHardware(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        sysfs->tick();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(ietfHardware->process());
+    }
+
+    state.counters["sensors"] = sysfs->sensorCount();
+    state.SetItemsProcessed(state.iterations() * sysfs->sensorCount());
+}
+BENCHMARK(ietfHardwareProcess)->Arg(1)->Arg(8)->Arg(32)->Arg(128)->Unit(benchmark::kMicrosecond);
+
+static void watcherUpdate(benchmark::State& state)
+{
+    Watcher<int64_t> watcher(Thresholds<int64_t>{
+        .criticalLow = OneThreshold<int64_t>{-10'000, 1'000},
+        .warningLow = OneThreshold<int64_t>{0, 1'000},
+        .warningHigh = OneThreshold<int64_t>{90'000, 1'000},
+        .criticalHigh = OneThreshold<int64_t>{100'000, 1'000},
+    });
+
+    // sweep across all the thresholds so that the state changes occasionally
+    int64_t value = -20'000;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(watcher.update(value));
+        value = value > 120'000 ? -20'000 : value + 500;
+    }
+}
+BENCHMARK(watcherUpdate);
+
+static void onieEepromParse(benchmark::State& state)
+{
+    const auto eeprom = sysfsPrefix + "eeprom/188_0-0052_eeprom.bin";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sysfs::onieEeprom(eeprom));
+    }
+}
+BENCHMARK(onieEepromParse);
+
+static void ipmiFruEepromParse(benchmark::State& state)
+{
+    const auto eeprom = sysfsPrefix + "eeprom/YM-2151F.bin";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sysfs::ipmiFruEeprom(eeprom));
+    }
+}
+BENCHMARK(ipmiFruEepromParse);
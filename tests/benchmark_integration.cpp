@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/spdlog.h>
+#include "utils/log-init.h"
+#include "utils/sysrepo.h"
+
+/* Benchmarks measure the code itself, not the logging. The loggers must exist, though, because the code under test looks them up by name. */
+int main(int argc, char** argv)
+{
+    velia::utils::initLogs(std::make_shared<spdlog::sinks::null_sink_mt>());
+    velia::utils::initLogsSysrepo();
+    spdlog::set_level(spdlog::level::off);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
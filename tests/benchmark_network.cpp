@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include "network/LLDP.h"
+#include "network/NetworkctlUtils.h"
+
+namespace {
+
+/** @short Output of `networkctl lldp --json=short` with @p links links, each one having a single neighbor */
+std::string lldpJson(int64_t links)
+{
+    std::string res = R"({"Neighbors": [)";
+
+    for (int64_t i = 0; i < links; ++i) {
+        if (i) {
+            res += ", ";
+        }
+        res += fmt::format(R"({{"InterfaceName": "eth{0}", "InterfaceIndex": {0}, "Neighbors": [{{"SystemName": "switch-{0}", "PortID": "Gi1/0/{0}", "ChassisID": "00:b8:b3:e6:{1:02x}:{2:02x}", "EnabledCapabilities": 4}}]}})",
+                           i, (i / 256) % 256, i % 256);
+    }
+
+    return res + "]}";
+}
+
+/** @short Output of `networkctl list --json=short` with @p links links, with roughly as much data per link as on a real device */
+std::string networkctlListJson(int64_t links)
+{
+    std::string res = R"({"Interfaces": [)";
+
+    for (int64_t i = 0; i < links; ++i) {
+        if (i) {
+            res += ", ";
+        }
+        res += fmt::format(
+            R"({{"Index": {0}, "Name": "eth{0}", "AlternativeNames": ["enp{0}s0"], "Kind": "ether", "Type": "ether", "Driver": "mvneta", )"
+            R"("SetupState": "configured", "OperationalState": "routable", "CarrierState": "carrier", "AddressState": "routable", )"
+            R"("IPv4AddressState": "routable", "IPv6AddressState": "routable", "OnlineState": "online", "AdministrativeState": "configured", )"
+            R"("NetworkFile": "/run/systemd/network/10-eth{0}.network", "NetworkFileDropins": [], "RequiredForOnline": true, )"
+            R"("HardwareAddress": [0, 17, 23, 1, {1}, {2}], "PermanentHardwareAddress": [0, 17, 23, 1, {1}, {2}], "MTU": 1500, "MinimumMTU": 68, "MaximumMTU": 9676, )"
+            R"("Addresses": [{{"Family": 2, "Address": [192, 0, {1}, {2}], "PrefixLength": 24, "Scope": 0, "ScopeString": "global", "Flags": 128, "FlagsString": "permanent", "ConfigSource": "static", "ConfigState": "configured"}}, )"
+            R"({{"Family": 10, "Address": [254, 128, 0, 0, 0, 0, 0, 0, 2, 17, 23, 255, 254, 1, {1}, {2}], "PrefixLength": 64, "Scope": 253, "ScopeString": "link", "Flags": 128, "FlagsString": "permanent", "ConfigSource": "foreign", "ConfigState": "configured"}}], )"
+            R"("Routes": [{{"Family": 2, "Destination": [192, 0, {1}, 0], "DestinationPrefixLength": 24, "Table": 254, "TableString": "main", "Protocol": 2, "ProtocolString": "kernel", "ConfigSource": "foreign", "ConfigState": "configured"}}], )"
+            R"("LLDP": {{"ChassisID": "c1d2e3f4", "PortID": "eth{0}"}}}})",
+            i, (i / 256) % 256, i % 256);
+    }
+
+    return res + "]}";
+}
+}
+
+static void lldpGetNeighbors(benchmark::State& state)
+{
+    const auto json = lldpJson(state.range(0));
+    velia::network::LLDPDataProvider lldp([&json]() { return json; }, {.chassisId = "c1d2e3f4", .chassisSubtype = "local"});
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lldp.getNeighbors());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(lldpGetNeighbors)->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMicrosecond);
+
+static void networkctlFullParse(benchmark::State& state)
+{
+    const auto json = networkctlListJson(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nlohmann::json::parse(json));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(networkctlFullParse)->RangeMultiplier(4)->Range(4, 256)->Unit(benchmark::kMicrosecond);
+
+static void networkctlManagedLinks(benchmark::State& state)
+{
+    const auto json = networkctlListJson(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(velia::network::systemdNetworkdManagedLinks(json));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(networkctlManagedLinks)->RangeMultiplier(4)->Range(4, 256)->Unit(benchmark::kMicrosecond);
+
+static void networkctlLinkConfigurationFiles(benchmark::State& state)
+{
+    const auto json = networkctlListJson(state.range(0));
+    std::set<std::string> links;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        links.insert(fmt::format("eth{}", i));
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(velia::network::linkConfigurationFiles(json, links));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(networkctlLinkConfigurationFiles)->RangeMultiplier(4)->Range(4, 256)->Unit(benchmark::kMicrosecond);
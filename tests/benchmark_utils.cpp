@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <sysrepo-cpp/Connection.hpp>
+#include "utils/sysrepo.h"
+
+namespace {
+
+const std::vector<std::string> statisticsLeaves{
+    "in-octets",
+    "in-unicast-pkts",
+    "in-broadcast-pkts",
+    "in-multicast-pkts",
+    "in-discards",
+    "in-errors",
+    "in-unknown-protos",
+    "out-octets",
+    "out-unicast-pkts",
+    "out-broadcast-pkts",
+};
+
+/** @short Interface statistics, i.e., something similar to what IETFInterfaces produces, with @p leaves leaves in total */
+velia::utils::YANGData interfaceStatistics(int64_t leaves)
+{
+    velia::utils::YANGData res;
+    res.reserve(leaves);
+
+    for (int64_t i = 0; i < leaves; ++i) {
+        const auto prefix = "/ietf-interfaces:interfaces/interface[name='eth" + std::to_string(i / statisticsLeaves.size()) + "']/statistics/";
+        res.emplace_back(prefix + statisticsLeaves[i % statisticsLeaves.size()], std::to_string(i));
+    }
+
+    return res;
+}
+}
+
+static void valuesToYang(benchmark::State& state)
+{
+    auto session = sysrepo::Connection{}.sessionStart(sysrepo::Datastore::Operational);
+    const auto values = interfaceStatistics(state.range(0));
+
+    for (auto _ : state) {
+        std::optional<libyang::DataNode> edit;
+        velia::utils::valuesToYang(values, {}, {}, session, edit);
+        benchmark::DoNotOptimize(edit);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(valuesToYang)->RangeMultiplier(10)->Range(100, 10'000)->Unit(benchmark::kMicrosecond);
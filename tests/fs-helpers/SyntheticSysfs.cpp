@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <fstream>
+#include "SyntheticSysfs.h"
+#include "ietf-hardware/IETFHardware.h"
+#include "utils.h"
+
+using namespace std::literals;
+using namespace velia::ietf_hardware;
+
+namespace {
+
+const auto I2C_EEPROM_ADDRESS = uint8_t{0x50};
+
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream ofs(path, std::ios_base::out | std::ios_base::trunc);
+    if (!ofs.is_open()) {
+        throw std::invalid_argument("SyntheticSysfs: could not open file " + path.string() + " for writing");
+    }
+    ofs << content;
+}
+
+std::string lifeTime(uint32_t level)
+{
+    return fmt::format("0x{:02x} 0x{:02x}", level, level);
+}
+
+const Thresholds<int64_t> temperatureThresholds{
+    .criticalLow = std::nullopt,
+    .warningLow = std::nullopt,
+    .warningHigh = OneThreshold<int64_t>{90'000, 1'000},
+    .criticalHigh = OneThreshold<int64_t>{100'000, 1'000},
+};
+
+const Thresholds<int64_t> voltageThresholds{
+    .criticalLow = OneThreshold<int64_t>{11'000, 100},
+    .warningLow = OneThreshold<int64_t>{11'500, 100},
+    .warningHigh = OneThreshold<int64_t>{12'500, 100},
+    .criticalHigh = OneThreshold<int64_t>{13'000, 100},
+};
+}
+
+/** @short Generates the whole tree under @p root, removing whatever was there before */
+SyntheticSysfs::SyntheticSysfs(std::filesystem::path root, const Layout& layout, std::mt19937::result_type seed)
+    : m_root(std::move(root))
+    , m_layout(layout)
+    , m_random(seed)
+{
+    if (m_layout.lineCards > 256) {
+        throw std::invalid_argument("SyntheticSysfs: each line card has its EEPROM on a separate I2C bus, there can be at most 256 of them");
+    }
+
+    removeDirectoryTreeIfExists(m_root);
+
+    auto randomValue = [this](int64_t min, int64_t max) { return std::uniform_int_distribution<int64_t>(min, max)(m_random); };
+
+    for (unsigned lc = 0; lc < m_layout.lineCards; ++lc) {
+        std::string eeprom(EEPROM_SIZE, '\0');
+        for (auto& byte : eeprom) {
+            byte = static_cast<char>(randomValue(0, 255));
+        }
+        writeFile(m_root / fmt::format("bus/i2c/devices/{}-{:04x}/eeprom", lc, I2C_EEPROM_ADDRESS), eeprom);
+
+        for (unsigned chip = 0; chip < m_layout.chipsPerLineCard; ++chip) {
+            const auto dir = lineCardChip(lc, chip) / "hwmon0";
+            writeFile(dir / "name", "synthetic-temp\n");
+            for (unsigned channel = 1; channel <= m_layout.temperaturesPerChip; ++channel) {
+                m_sensors.push_back({dir / fmt::format("temp{}_input", channel), randomValue(30'000, 60'000), 20'000, 110'000, 2'000});
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < m_layout.psus; ++i) {
+        const auto dir = psu(i) / "hwmon0";
+        writeFile(dir / "name", "synthetic-psu\n");
+        m_sensors.push_back({dir / "in1_input", randomValue(11'800, 12'200), 10'500, 13'500, 100});
+        m_sensors.push_back({dir / "curr1_input", randomValue(1'000, 10'000), 0, 20'000, 500});
+        m_sensors.push_back({dir / "power1_input", randomValue(10'000'000, 100'000'000), 0, 250'000'000, 5'000'000});
+        m_sensors.push_back({dir / "temp1_input", randomValue(30'000, 50'000), 20'000, 110'000, 2'000});
+    }
+
+    for (unsigned i = 0; i < m_layout.emmcs; ++i) {
+        const auto dir = emmc(i);
+        writeFile(dir / "name", "SYNTH" + std::to_string(i) + "\n");
+        writeFile(dir / "serial", fmt::format("0x{:08x}\n", randomValue(0, 0xffff'ffff)));
+        writeFile(dir / "date", "02/2026\n");
+        writeFile(dir / "pre_eol_info", "0x01\n");
+        m_emmcLifeTimes.emplace_back(dir / "life_time", 1);
+        writeFile(m_emmcLifeTimes.back().first, lifeTime(m_emmcLifeTimes.back().second));
+    }
+
+    for (const auto& sensor : m_sensors) {
+        writeSensor(sensor);
+    }
+}
+
+/** @short Changes values of all sensors by a random step. The eMMC wear increases occasionally. */
+void SyntheticSysfs::tick()
+{
+    for (auto& sensor : m_sensors) {
+        sensor.value = std::clamp(sensor.value + std::uniform_int_distribution<int64_t>(-sensor.step, sensor.step)(m_random), sensor.min, sensor.max);
+        writeSensor(sensor);
+    }
+
+    for (auto& [file, level] : m_emmcLifeTimes) {
+        if (level < 0x0b && std::uniform_int_distribution<int>(0, 99)(m_random) == 0) {
+            writeFile(file, lifeTime(++level));
+        }
+    }
+}
+
+/** @short Registers data readers for all components of the generated chassis. The sensors have thresholds set, so that the watchers are exercised, too. */
+void SyntheticSysfs::registerDataReaders(IETFHardware& ietfHardware) const
+{
+    using namespace data_reader;
+
+    ietfHardware.registerDataReader(StaticData("ne", std::nullopt, {{"class", "iana-hardware:chassis"}}));
+
+    for (unsigned lc = 0; lc < m_layout.lineCards; ++lc) {
+        const auto lineCard = "ne:lc" + std::to_string(lc);
+        ietfHardware.registerDataReader(StaticData(lineCard, "ne", {{"class", "iana-hardware:module"}}));
+        ietfHardware.registerDataReader(EepromWithUid(lineCard + ":eeprom", lineCard, m_root.string(), lc, I2C_EEPROM_ADDRESS, EEPROM_SIZE, EEPROM_SIZE - EEPROM_UID_LENGTH, EEPROM_UID_LENGTH));
+
+        for (unsigned chip = 0; chip < m_layout.chipsPerLineCard; ++chip) {
+            auto hwmon = std::make_shared<sysfs::HWMon>(lineCardChip(lc, chip));
+            for (unsigned channel = 1; channel <= m_layout.temperaturesPerChip; ++channel) {
+                ietfHardware.registerDataReader(SysfsValue<SensorType::Temperature>(fmt::format("{}:chip{}:temperature{}", lineCard, chip, channel), lineCard, hwmon, channel, temperatureThresholds));
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < m_layout.psus; ++i) {
+        const auto name = "ne:psu" + std::to_string(i);
+        auto hwmon = std::make_shared<sysfs::HWMon>(psu(i));
+        ietfHardware.registerDataReader(StaticData(name, "ne", {{"class", "iana-hardware:power-supply"}}));
+        ietfHardware.registerDataReader(SysfsValue<SensorType::VoltageDC>(name + ":voltage-out", name, hwmon, 1, voltageThresholds));
+        ietfHardware.registerDataReader(SysfsValue<SensorType::Current>(name + ":current-out", name, hwmon, 1));
+        ietfHardware.registerDataReader(SysfsValue<SensorType::Power>(name + ":power-out", name, hwmon, 1));
+        ietfHardware.registerDataReader(SysfsValue<SensorType::Temperature>(name + ":temperature", name, hwmon, 1, temperatureThresholds));
+    }
+
+    for (unsigned i = 0; i < m_layout.emmcs; ++i) {
+        ietfHardware.registerDataReader(EMMC("ne:emmc" + std::to_string(i), "ne", std::make_shared<sysfs::EMMC>(emmc(i))));
+    }
+}
+
+/** @short Number of sensor components which the data readers from registerDataReaders() report */
+unsigned SyntheticSysfs::sensorCount() const
+{
+    return m_sensors.size() + m_emmcLifeTimes.size();
+}
+
+void SyntheticSysfs::writeSensor(const Sensor& sensor)
+{
+    writeFile(sensor.file, std::to_string(sensor.value) + "\n");
+}
+
+std::filesystem::path SyntheticSysfs::lineCardChip(unsigned lineCard, unsigned chip) const
+{
+    return m_root / fmt::format("devices/line-card{}/chip{}/hwmon", lineCard, chip);
+}
+
+std::filesystem::path SyntheticSysfs::psu(unsigned psu) const
+{
+    return m_root / fmt::format("devices/psu{}/hwmon", psu);
+}
+
+std::filesystem::path SyntheticSysfs::emmc(unsigned emmc) const
+{
+    return m_root / fmt::format("block/mmcblk{}/device", emmc);
+}
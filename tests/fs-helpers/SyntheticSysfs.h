@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace velia::ietf_hardware {
+class IETFHardware;
+}
+
+/** @short Generates a fake sysfs tree of a large modular chassis for scale testing
+ *
+ * The chassis consists of line cards, each one with an EEPROM and several hwmon chips with temperature sensors, of power supplies
+ * with voltage, current, power and temperature sensors, and of eMMC devices. Sensor values change with every call to tick().
+ * Values are pseudo-random, but deterministic for a given seed, so that measurements are repeatable.
+ *
+ * registerDataReaders() configures IETFHardware with data readers which match the generated tree.
+ */
+class SyntheticSysfs {
+public:
+    struct Layout {
+        unsigned lineCards = 16;
+        unsigned chipsPerLineCard = 4;
+        unsigned temperaturesPerChip = 4;
+        unsigned psus = 4;
+        unsigned emmcs = 1;
+    };
+
+    static constexpr uint32_t EEPROM_SIZE = 256;
+    static constexpr uint32_t EEPROM_UID_LENGTH = 6;
+
+    SyntheticSysfs(std::filesystem::path root, const Layout& layout, std::mt19937::result_type seed = 0);
+    void tick();
+    void registerDataReaders(velia::ietf_hardware::IETFHardware& ietfHardware) const;
+    unsigned sensorCount() const;
+
+private:
+    struct Sensor {
+        std::filesystem::path file;
+        int64_t value;
+        int64_t min, max, step;
+    };
+
+    void writeSensor(const Sensor& sensor);
+    std::filesystem::path lineCardChip(unsigned lineCard, unsigned chip) const;
+    std::filesystem::path psu(unsigned psu) const;
+    std::filesystem::path emmc(unsigned emmc) const;
+
+    std::filesystem::path m_root;
+    Layout m_layout;
+    std::mt19937 m_random;
+    std::vector<Sensor> m_sensors;
+    std::vector<std::pair<std::filesystem::path, uint32_t>> m_emmcLifeTimes;
+};
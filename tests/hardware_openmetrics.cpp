@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include "ietf-hardware/OpenMetrics.h"
+#include "prometheus-helpers/text-format.h"
+#include "utils/openmetrics.h"
+
+using namespace std::string_literals;
+using namespace velia::ietf_hardware;
+
+TEST_CASE("OpenMetrics label escaping")
+{
+    REQUIRE(velia::utils::openmetrics::escapeLabelValue("ne:psu") == "ne:psu");
+    REQUIRE(velia::utils::openmetrics::escapeLabelValue(R"(a"b\c)") == R"(a\"b\\c)");
+    REQUIRE(velia::utils::openmetrics::escapeLabelValue("a\nb") == R"(a\nb)");
+}
+
+TEST_CASE("OpenMetrics export of sensor data")
+{
+    const DataTree dataTree{
+        {"/ietf-hardware:hardware/component[name='ne']/class", "iana-hardware:chassis"},
+        {"/ietf-hardware:hardware/component[name='ne:temperature-cpu']/class", "iana-hardware:sensor"},
+        {"/ietf-hardware:hardware/component[name='ne:temperature-cpu']/sensor-data/oper-status", "ok"},
+        {"/ietf-hardware:hardware/component[name='ne:temperature-cpu']/sensor-data/value", "41800"},
+        {"/ietf-hardware:hardware/component[name='ne:temperature-cpu']/sensor-data/value-precision", "0"},
+        {"/ietf-hardware:hardware/component[name='ne:temperature-cpu']/sensor-data/value-scale", "milli"},
+        {"/ietf-hardware:hardware/component[name='ne:temperature-cpu']/sensor-data/value-type", "celsius"},
+        {"/ietf-hardware:hardware/component[name='ne:fans:fan1:rpm']/class", "iana-hardware:sensor"},
+        {"/ietf-hardware:hardware/component[name='ne:fans:fan1:rpm']/sensor-data/oper-status", "nonoperational"},
+        {"/ietf-hardware:hardware/component[name='ne:fans:fan1:rpm']/sensor-data/value", "-1000000000"},
+        {"/ietf-hardware:hardware/component[name='ne:fans:fan1:rpm']/sensor-data/value-precision", "0"},
+        {"/ietf-hardware:hardware/component[name='ne:fans:fan1:rpm']/sensor-data/value-scale", "units"},
+        {"/ietf-hardware:hardware/component[name='ne:fans:fan1:rpm']/sensor-data/value-type", "rpm"},
+    };
+
+    const std::map<std::string, State> thresholdStates{
+        {"/ietf-hardware:hardware/component[name='ne:temperature-cpu']/sensor-data/value", State::WarningHigh},
+    };
+
+    const auto document = renderOpenMetrics(dataTree, thresholdStates);
+    REQUIRE(document == R"(# TYPE velia_hardware_sensor_value gauge
+# HELP velia_hardware_sensor_value Sensor value as reported by ietf-hardware, in units given by value_type and value_scale.
+velia_hardware_sensor_value{component="ne:fans:fan1:rpm",value_scale="units",value_type="rpm"} -1000000000
+velia_hardware_sensor_value{component="ne:temperature-cpu",value_scale="milli",value_type="celsius"} 41800
+# TYPE velia_hardware_sensor_oper_status gauge
+# HELP velia_hardware_sensor_oper_status Operational status of the sensor, 1 for the current one.
+velia_hardware_sensor_oper_status{component="ne:fans:fan1:rpm",velia_hardware_sensor_oper_status="ok"} 0
+velia_hardware_sensor_oper_status{component="ne:fans:fan1:rpm",velia_hardware_sensor_oper_status="unavailable"} 0
+velia_hardware_sensor_oper_status{component="ne:fans:fan1:rpm",velia_hardware_sensor_oper_status="nonoperational"} 1
+velia_hardware_sensor_oper_status{component="ne:temperature-cpu",velia_hardware_sensor_oper_status="ok"} 1
+velia_hardware_sensor_oper_status{component="ne:temperature-cpu",velia_hardware_sensor_oper_status="unavailable"} 0
+velia_hardware_sensor_oper_status{component="ne:temperature-cpu",velia_hardware_sensor_oper_status="nonoperational"} 0
+# TYPE velia_hardware_sensor_threshold_state gauge
+# HELP velia_hardware_sensor_threshold_state Threshold state of the sensor, 1 for the current one.
+velia_hardware_sensor_threshold_state{component="ne:temperature-cpu",velia_hardware_sensor_threshold_state="no-value"} 0
+velia_hardware_sensor_threshold_state{component="ne:temperature-cpu",velia_hardware_sensor_threshold_state="disabled"} 0
+velia_hardware_sensor_threshold_state{component="ne:temperature-cpu",velia_hardware_sensor_threshold_state="critical-low"} 0
+velia_hardware_sensor_threshold_state{component="ne:temperature-cpu",velia_hardware_sensor_threshold_state="warning-low"} 0
+velia_hardware_sensor_threshold_state{component="ne:temperature-cpu",velia_hardware_sensor_threshold_state="normal"} 0
+velia_hardware_sensor_threshold_state{component="ne:temperature-cpu",velia_hardware_sensor_threshold_state="warning-high"} 1
+velia_hardware_sensor_threshold_state{component="ne:temperature-cpu",velia_hardware_sensor_threshold_state="critical-high"} 0
+)"s);
+
+    // node_exporter's textfile collector rejects the whole file when anything is wrong, so make sure that nothing is
+    REQUIRE(parsePrometheusText(document) == std::map<std::string, PrometheusFamily>{
+                {"velia_hardware_sensor_value", {.type = "gauge", .samples = 2}},
+                {"velia_hardware_sensor_oper_status", {.type = "gauge", .samples = 6}},
+                {"velia_hardware_sensor_threshold_state", {.type = "gauge", .samples = 7}},
+            });
+}
+
+TEST_CASE("Prometheus text format check")
+{
+    REQUIRE_THROWS_WITH_AS(parsePrometheusText("# TYPE foo stateset\nfoo{foo=\"a\"} 1\n"), "line 1: unknown metric type: # TYPE foo stateset", std::runtime_error);
+    REQUIRE_THROWS_WITH_AS(parsePrometheusText("# TYPE foo counter\nfoo_total 1\n"), "line 2: sample does not belong to the last counter or gauge family: foo_total 1", std::runtime_error);
+    REQUIRE_THROWS_WITH_AS(parsePrometheusText("# TYPE foo gauge\nfoo 1\n# EOF\n"), "line 3: OpenMetrics EOF marker: # EOF", std::runtime_error);
+    REQUIRE_THROWS_WITH_AS(parsePrometheusText("# TYPE foo gauge\nfoo{a=\"1\"} 1\nfoo{a=\"1\"} 2\n"), "line 3: duplicate series: foo{a=\"1\"} 2", std::runtime_error);
+    REQUIRE_THROWS_WITH_AS(parsePrometheusText("# TYPE foo gauge\nfoo{a=\"1} 1\n"), "line 2: invalid label: foo{a=\"1} 1", std::runtime_error);
+    REQUIRE(parsePrometheusText("# HELP foo Foo.\n# TYPE foo gauge\nfoo{a=\"x\\\"y\",b=\"\"} -1.5e3\n") == std::map<std::string, PrometheusFamily>{{"foo", {.type = "gauge", .samples = 1}}});
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <fstream>
+#include "fs-helpers/SyntheticSysfs.h"
+#include "ietf-hardware/IETFHardware.h"
+#include "ietf-hardware/PollLog.h"
+#include "pretty_printers.h"
+#include "test_log_setup.h"
+#include "tests/configure.cmake.h"
+
+using namespace std::literals;
+using namespace velia::ietf_hardware;
+
+namespace {
+const auto lastChange = "/ietf-hardware:hardware/last-change"s;
+}
+
+TEST_CASE("Hardware poll log")
+{
+    TEST_INIT_LOGS;
+
+    const auto root = CMAKE_CURRENT_BINARY_DIR + "/tests/hardware_poll-log/"s;
+    const auto logFile = root + "poll.log";
+    const SyntheticSysfs::Layout layout{
+        .lineCards = 2,
+        .chipsPerLineCard = 2,
+        .temperaturesPerChip = 2,
+        .psus = 2,
+        .emmcs = 1,
+    };
+    const int polls = 50;
+
+    SyntheticSysfs sysfs(root + "sysfs", layout, 1);
+    IETFHardware recorded;
+    sysfs.registerDataReaders(recorded);
+
+    // exercise the rarely changing parts of the log, too
+    auto pollCounter = std::make_shared<int>(0);
+    recorded.registerDataReader([pollCounter]() {
+        SensorPollData res;
+        if ((*pollCounter)++ % 10 < 5) {
+            res.data["/ietf-hardware:hardware/component[name='ne:fan']/class"] = "iana-hardware:fan";
+            res.data["/ietf-hardware:hardware/component[name='ne:fan']/parent"] = "ne";
+        } else {
+            res.sideLoadedAlarms.insert({"velia-alarms:sensor-missing-alarm", "ne:fan", "critical", "Fan is missing"});
+        }
+        return res;
+    });
+
+    std::vector<HardwareInfo> expected;
+    {
+        PollLogWriter writer(logFile);
+        auto timestamp = std::chrono::system_clock::now();
+        recorded.registerPollDataObserver([&](const SensorPollData& pollData) {
+            writer.record(pollData, timestamp);
+            timestamp += 1500ms;
+        });
+
+        for (int i = 0; i < polls; ++i) {
+            sysfs.tick();
+            expected.push_back(recorded.process());
+        }
+    }
+
+    SECTION("Reader")
+    {
+        PollLogReader reader(logFile);
+        std::optional<std::chrono::system_clock::time_point> lastTimestamp;
+        for (int i = 0; i < polls; ++i) {
+            auto entry = reader.next();
+            REQUIRE(entry);
+            REQUIRE(entry->pollData.sideLoadedAlarms == expected[i].sideLoadedAlarms);
+            if (lastTimestamp) {
+                REQUIRE(entry->timestamp - *lastTimestamp == 1500ms);
+            }
+            lastTimestamp = entry->timestamp;
+        }
+        REQUIRE(!reader.next());
+    }
+
+    SECTION("Replay reproduces the processed data")
+    {
+        IETFHardware replayed;
+        replayed.registerDataReader(data_reader::Replay(logFile, data_reader::ReplaySpeed::AsFastAsPossible));
+
+        for (int i = 0; i < polls; ++i) {
+            auto info = replayed.process();
+            auto expectedTree = expected[i].dataTree;
+            info.dataTree.erase(lastChange);
+            expectedTree.erase(lastChange);
+
+            REQUIRE(info.dataTree == expectedTree);
+            REQUIRE(info.activeSensors == expected[i].activeSensors);
+            REQUIRE(info.sideLoadedAlarms == expected[i].sideLoadedAlarms);
+            REQUIRE(info.updatedTresholdCrossing == expected[i].updatedTresholdCrossing);
+        }
+    }
+
+    SECTION("Truncated log")
+    {
+        const auto truncated = root + "truncated.log";
+        std::filesystem::copy_file(logFile, truncated, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::resize_file(truncated, std::filesystem::file_size(truncated) - 3);
+
+        PollLogReader reader(truncated);
+        for (int i = 0; i < polls - 1; ++i) {
+            REQUIRE(reader.next());
+        }
+        REQUIRE(!reader.next());
+    }
+
+    SECTION("Not a log")
+    {
+        const auto garbage = root + "garbage.log";
+        std::ofstream(garbage) << "definitely not a poll log";
+        REQUIRE_THROWS_WITH_AS(PollLogReader(garbage), ("Hardware poll log: " + garbage + " is not a hardware poll log").c_str(), std::runtime_error);
+    }
+}
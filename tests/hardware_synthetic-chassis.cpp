@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include "fs-helpers/SyntheticSysfs.h"
+#include "ietf-hardware/IETFHardware.h"
+#include "pretty_printers.h"
+#include "test_log_setup.h"
+#include "tests/configure.cmake.h"
+
+using namespace std::literals;
+
+namespace {
+const auto lastChange = "/ietf-hardware:hardware/last-change"s;
+
+std::map<std::string, std::string> sensorValues(const velia::ietf_hardware::DataTree& data)
+{
+    std::map<std::string, std::string> res;
+    for (const auto& [k, v] : data) {
+        if (k.ends_with("/sensor-data/value")) {
+            res.emplace(k, v);
+        }
+    }
+    return res;
+}
+}
+
+TEST_CASE("Synthetic chassis")
+{
+    TEST_INIT_LOGS;
+    spdlog::get("hardware")->set_level(spdlog::level::info);
+
+    const SyntheticSysfs::Layout layout{
+        .lineCards = 3,
+        .chipsPerLineCard = 2,
+        .temperaturesPerChip = 3,
+        .psus = 2,
+        .emmcs = 1,
+    };
+    const auto root = CMAKE_CURRENT_BINARY_DIR + "/tests/synthetic-chassis/"s;
+
+    SyntheticSysfs sysfs(root + "a", layout, 42);
+    REQUIRE(sysfs.sensorCount() == 3 * 2 * 3 + 2 * 4 + 1);
+
+    velia::ietf_hardware::IETFHardware ietfHardware;
+    sysfs.registerDataReaders(ietfHardware);
+
+    auto info = ietfHardware.process();
+    REQUIRE(sensorValues(info.dataTree).size() == sysfs.sensorCount());
+    REQUIRE(info.activeSensors.size() == sysfs.sensorCount());
+    REQUIRE(info.dataTree.at("/ietf-hardware:hardware/component[name='ne:lc2:chip1:temperature3']/parent") == "ne:lc2");
+    REQUIRE(info.dataTree.at("/ietf-hardware:hardware/component[name='ne:lc2:eeprom']/serial-num").size() == SyntheticSysfs::EEPROM_UID_LENGTH * 2);
+    REQUIRE(info.dataTree.at("/ietf-hardware:hardware/component[name='ne:psu1:voltage-out']/sensor-data/value-type") == "volts-DC");
+    REQUIRE(info.dataTree.at("/ietf-hardware:hardware/component[name='ne:emmc0:lifetime']/sensor-data/value") == "0");
+
+    SECTION("Values change over time")
+    {
+        const auto before = sensorValues(info.dataTree);
+        sysfs.tick();
+        REQUIRE(sensorValues(ietfHardware.process().dataTree) != before);
+    }
+
+    SECTION("Same seed generates the same data")
+    {
+        SyntheticSysfs other(root + "b", layout, 42);
+        velia::ietf_hardware::IETFHardware otherHardware;
+        other.registerDataReaders(otherHardware);
+
+        for (int i = 0; i < 10; ++i) {
+            sysfs.tick();
+            other.tick();
+        }
+
+        auto data = ietfHardware.process().dataTree;
+        auto otherData = otherHardware.process().dataTree;
+        data.erase(lastChange);
+        otherData.erase(lastChange);
+        REQUIRE(data == otherData);
+    }
+
+    SECTION("Thresholds are crossed eventually")
+    {
+        using velia::ietf_hardware::State;
+        bool crossed = false;
+        for (int i = 0; i < 500 && !crossed; ++i) {
+            sysfs.tick();
+            for (const auto& [xpath, update] : ietfHardware.process().updatedTresholdCrossing) {
+                crossed |= update.newState == State::WarningLow || update.newState == State::WarningHigh;
+            }
+        }
+
+        REQUIRE(crossed);
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include "network/BridgeFdb.h"
+
+using velia::network::BridgeFdb;
+using Entries = std::vector<BridgeFdb::Entry>;
+
+TEST_CASE("Bridge FDB")
+{
+    BridgeFdb fdb;
+
+    fdb.set(10, 2, "02:00:00:00:00:02", 0, BridgeFdb::Type::Permanent);
+    fdb.set(10, 2, "02:00:00:00:00:01", 1, BridgeFdb::Type::Dynamic);
+    fdb.set(10, 2, "02:00:00:00:00:01", 0, BridgeFdb::Type::Dynamic);
+    fdb.set(10, 3, "02:00:00:00:00:03", 0, BridgeFdb::Type::Static);
+    fdb.set(10, 10, "02:00:00:00:00:10", 0, BridgeFdb::Type::Permanent);
+
+    REQUIRE(fdb.size() == 5);
+    REQUIRE(fdb.entries(2) == Entries{
+                {"02:00:00:00:00:01", 0, BridgeFdb::Type::Dynamic},
+                {"02:00:00:00:00:01", 1, BridgeFdb::Type::Dynamic},
+                {"02:00:00:00:00:02", 0, BridgeFdb::Type::Permanent},
+            });
+    REQUIRE(fdb.entries(3) == Entries{{"02:00:00:00:00:03", 0, BridgeFdb::Type::Static}});
+    REQUIRE(fdb.entries(10) == Entries{{"02:00:00:00:00:10", 0, BridgeFdb::Type::Permanent}});
+    REQUIRE(fdb.entries(4).empty());
+
+    SECTION("An address moves to another port")
+    {
+        fdb.set(10, 3, "02:00:00:00:00:01", 1, BridgeFdb::Type::Dynamic);
+        REQUIRE(fdb.size() == 5);
+        REQUIRE(fdb.entries(2) == Entries{
+                    {"02:00:00:00:00:01", 0, BridgeFdb::Type::Dynamic},
+                    {"02:00:00:00:00:02", 0, BridgeFdb::Type::Permanent},
+                });
+        REQUIRE(fdb.entries(3) == Entries{
+                    {"02:00:00:00:00:01", 1, BridgeFdb::Type::Dynamic},
+                    {"02:00:00:00:00:03", 0, BridgeFdb::Type::Static},
+                });
+    }
+
+    SECTION("Type changes")
+    {
+        fdb.set(10, 3, "02:00:00:00:00:03", 0, BridgeFdb::Type::Dynamic);
+        REQUIRE(fdb.entries(3) == Entries{{"02:00:00:00:00:03", 0, BridgeFdb::Type::Dynamic}});
+    }
+
+    SECTION("Remove an entry")
+    {
+        fdb.remove(10, "02:00:00:00:00:01", 0);
+        fdb.remove(10, "02:00:00:00:00:99", 0);
+        fdb.remove(11, "02:00:00:00:00:02", 0);
+        REQUIRE(fdb.size() == 4);
+        REQUIRE(fdb.entries(2) == Entries{
+                    {"02:00:00:00:00:01", 1, BridgeFdb::Type::Dynamic},
+                    {"02:00:00:00:00:02", 0, BridgeFdb::Type::Permanent},
+                });
+    }
+
+    SECTION("Remove a port")
+    {
+        fdb.removeLink(2);
+        REQUIRE(fdb.size() == 2);
+        REQUIRE(fdb.entries(2).empty());
+        REQUIRE(fdb.entries(3) == Entries{{"02:00:00:00:00:03", 0, BridgeFdb::Type::Static}});
+    }
+
+    SECTION("Remove a bridge")
+    {
+        fdb.set(11, 4, "02:00:00:00:00:04", 0, BridgeFdb::Type::Dynamic);
+        fdb.removeLink(10);
+        REQUIRE(fdb.size() == 1);
+        REQUIRE(fdb.entries(2).empty());
+        REQUIRE(fdb.entries(3).empty());
+        REQUIRE(fdb.entries(10).empty());
+        REQUIRE(fdb.entries(4) == Entries{{"02:00:00:00:00:04", 0, BridgeFdb::Type::Dynamic}});
+    }
+}
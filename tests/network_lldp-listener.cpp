@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <arpa/inet.h>
+#include <fstream>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include "network/LLDPListener.h"
+#include "test_log_setup.h"
+#include "test_vars.h"
+#include "utils/exec.h"
+
+using namespace std::literals;
+using velia::network::LLDPNeighbor;
+
+namespace {
+
+const auto WAIT = 500ms;
+
+template <class... Args>
+void iproute2_exec(const Args... args)
+{
+    velia::utils::execAndWait(spdlog::get("main"), IPROUTE2_EXECUTABLE, {args...}, "");
+}
+
+void appendTLV(std::vector<uint8_t>& frame, uint8_t type, const std::vector<uint8_t>& value)
+{
+    uint16_t header = (type << 9) | value.size();
+    frame.push_back(header >> 8);
+    frame.push_back(header & 0xff);
+    frame.insert(frame.end(), value.begin(), value.end());
+}
+
+std::vector<uint8_t> textual(uint8_t subtype, const std::string& str)
+{
+    std::vector<uint8_t> res{subtype};
+    res.insert(res.end(), str.begin(), str.end());
+    return res;
+}
+
+struct LLDPDU {
+    std::vector<uint8_t> chassisId = {4 /* MAC address */, 0x02, 0x00, 0x00, 0x00, 0x00, 0x42};
+    std::vector<uint8_t> portId = textual(5 /* interface name */, "eth7");
+    uint16_t ttl = 120;
+    std::optional<std::string> systemName = "switch";
+    std::optional<uint16_t> enabledCapabilities = 0x0004;
+};
+
+std::vector<uint8_t> lldpFrame(const LLDPDU& lldpdu)
+{
+    std::vector<uint8_t> frame{
+        0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e, // destination
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x42, // source
+        0x88, 0xcc, // ethertype
+    };
+
+    appendTLV(frame, 1, lldpdu.chassisId);
+    appendTLV(frame, 2, lldpdu.portId);
+    appendTLV(frame, 3, {static_cast<uint8_t>(lldpdu.ttl >> 8), static_cast<uint8_t>(lldpdu.ttl & 0xff)});
+    if (lldpdu.systemName) {
+        appendTLV(frame, 5, {lldpdu.systemName->begin(), lldpdu.systemName->end()});
+    }
+    if (lldpdu.enabledCapabilities) {
+        appendTLV(frame, 7, {0x00, 0xff, static_cast<uint8_t>(*lldpdu.enabledCapabilities >> 8), static_cast<uint8_t>(*lldpdu.enabledCapabilities & 0xff)});
+    }
+    appendTLV(frame, 0, {});
+    return frame;
+}
+
+/** @brief Is the link subscribed to the LLDP multicast address? */
+bool receivesLLDPMulticast(const std::string& link)
+{
+    std::ifstream devMcast("/proc/net/dev_mcast");
+    std::string ifindex, name, users, global, address;
+    while (devMcast >> ifindex >> name >> users >> global >> address) {
+        if (name == link && address == "0180c200000e") {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Transmits raw ethernet frames out of a link */
+class FrameSender {
+public:
+    explicit FrameSender(const std::string& link)
+        : m_fd(socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, 0))
+    {
+        REQUIRE(m_fd >= 0);
+        m_addr.sll_family = AF_PACKET;
+        m_addr.sll_protocol = htons(ETH_P_LLDP);
+        m_addr.sll_ifindex = if_nametoindex(link.c_str());
+        m_addr.sll_halen = ETH_ALEN;
+        REQUIRE(m_addr.sll_ifindex != 0);
+    }
+
+    ~FrameSender()
+    {
+        ::close(m_fd);
+    }
+
+    void send(const std::vector<uint8_t>& frame)
+    {
+        REQUIRE(sendto(m_fd, frame.data(), frame.size(), 0, reinterpret_cast<sockaddr*>(&m_addr), sizeof(m_addr)) == static_cast<ssize_t>(frame.size()));
+    }
+
+private:
+    int m_fd;
+    sockaddr_ll m_addr{};
+};
+}
+
+TEST_CASE("Receiving LLDP neighbors over AF_PACKET")
+{
+    TEST_INIT_LOGS;
+
+    iproute2_exec("link", "add", "lldp0", "type", "veth", "peer", "name", "lldp1");
+    iproute2_exec("link", "add", "other0", "type", "veth", "peer", "name", "other1");
+    for (const auto& link : {"lldp0", "lldp1", "other0", "other1"}) {
+        iproute2_exec("link", "set", link, "up");
+    }
+
+    velia::network::LLDPListener listener({"lldp0", "nonexistent"});
+    FrameSender sender("lldp1");
+
+    REQUIRE(listener.neighbors().empty());
+
+    sender.send(lldpFrame({}));
+    std::this_thread::sleep_for(WAIT);
+
+    const LLDPNeighbor neighbor{
+        .linkName = "lldp0",
+        .chassisId = "02:00:00:00:00:42",
+        .portId = "eth7",
+        .systemName = "switch",
+        .enabledCapabilities = 0x0004,
+    };
+    REQUIRE(listener.neighbors() == std::vector<LLDPNeighbor>{neighbor});
+
+    SECTION("Updates of a known neighbor replace the old data")
+    {
+        sender.send(lldpFrame({.systemName = "renamed", .enabledCapabilities = std::nullopt}));
+        std::this_thread::sleep_for(WAIT);
+
+        auto updated = neighbor;
+        updated.systemName = "renamed";
+        updated.enabledCapabilities = std::nullopt;
+        REQUIRE(listener.neighbors() == std::vector<LLDPNeighbor>{updated});
+    }
+
+    SECTION("More neighbors on a single link")
+    {
+        sender.send(lldpFrame({.chassisId = textual(7 /* locally assigned */, "chassis-2"), .portId = {3 /* MAC address */, 0x02, 0x00, 0x00, 0x00, 0x00, 0x43}, .systemName = std::nullopt}));
+        sender.send(lldpFrame({.chassisId = textual(7 /* locally assigned */, "chassis-3"), .portId = {1 /* interface alias */, 0x00, 0xff}, .systemName = std::nullopt}));
+        std::this_thread::sleep_for(WAIT);
+
+        REQUIRE(listener.neighbors() == std::vector<LLDPNeighbor>{
+                    neighbor,
+                    {.linkName = "lldp0", .chassisId = "chassis-2", .portId = "02:00:00:00:00:43", .systemName = std::nullopt, .enabledCapabilities = 0x0004},
+                    {.linkName = "lldp0", .chassisId = "chassis-3", .portId = "00ff", .systemName = std::nullopt, .enabledCapabilities = 0x0004},
+                });
+    }
+
+    SECTION("Shutdown LLDPDU removes the neighbor")
+    {
+        sender.send(lldpFrame({.ttl = 0}));
+        std::this_thread::sleep_for(WAIT);
+        REQUIRE(listener.neighbors().empty());
+    }
+
+    SECTION("Neighbors expire")
+    {
+        sender.send(lldpFrame({.ttl = 1}));
+        std::this_thread::sleep_for(WAIT);
+        REQUIRE(listener.neighbors() == std::vector<LLDPNeighbor>{neighbor});
+
+        std::this_thread::sleep_for(1s);
+        REQUIRE(listener.neighbors().empty());
+    }
+
+    SECTION("Invalid LLDPDUs are ignored")
+    {
+        auto truncated = lldpFrame({.chassisId = textual(7, "chassis-2")});
+        truncated.resize(truncated.size() - 10);
+        sender.send(truncated);
+
+        // TTL TLV is missing
+        auto noTTL = lldpFrame({});
+        noTTL.resize(14); // just the ethernet header
+        appendTLV(noTTL, 1, textual(7, "chassis-3"));
+        appendTLV(noTTL, 2, textual(7, "port"));
+        appendTLV(noTTL, 0, {});
+        sender.send(noTTL);
+
+        std::this_thread::sleep_for(WAIT);
+        REQUIRE(listener.neighbors() == std::vector<LLDPNeighbor>{neighbor});
+    }
+
+    SECTION("Links which are not listened to are ignored")
+    {
+        FrameSender otherSender("other1");
+        otherSender.send(lldpFrame({.chassisId = textual(7, "chassis-2")}));
+        std::this_thread::sleep_for(WAIT);
+        REQUIRE(listener.neighbors() == std::vector<LLDPNeighbor>{neighbor});
+    }
+
+    SECTION("Changing the links")
+    {
+        REQUIRE(receivesLLDPMulticast("lldp0"));
+        REQUIRE(!receivesLLDPMulticast("other0"));
+
+        listener.setLinks({"other0"});
+        REQUIRE(listener.neighbors().empty());
+        REQUIRE(!receivesLLDPMulticast("lldp0"));
+        REQUIRE(receivesLLDPMulticast("other0"));
+
+        FrameSender otherSender("other1");
+        otherSender.send(lldpFrame({.chassisId = textual(7, "chassis-2")}));
+        sender.send(lldpFrame({}));
+        std::this_thread::sleep_for(WAIT);
+        REQUIRE(listener.neighbors() == std::vector<LLDPNeighbor>{{
+                    .linkName = "other0",
+                    .chassisId = "chassis-2",
+                    .portId = "eth7",
+                    .systemName = "switch",
+                    .enabledCapabilities = 0x0004,
+                }});
+    }
+
+    iproute2_exec("link", "del", "lldp0");
+    iproute2_exec("link", "del", "other0");
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <map>
+#include <mutex>
+#include <sdbus-c++/sdbus-c++.h>
+#include <thread>
+#include "network/ManagedLinks.h"
+#include "test_log_setup.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/** @brief Implements just the bits of org.freedesktop.network1.Manager which are needed for listing the links */
+class FakeNetworkd {
+public:
+    explicit FakeNetworkd(sdbus::IConnection& connection)
+        : m_manager(sdbus::createObject(connection, "/org/freedesktop/network1"))
+    {
+        m_manager->registerMethod("Describe").onInterface("org.freedesktop.network1.Manager").implementedAs([this]() {
+            std::lock_guard lock(m_mtx);
+            std::string res;
+            for (const auto& [name, state] : m_links) {
+                if (!res.empty()) {
+                    res += ", ";
+                }
+                res += R"({"Name": ")" + name + R"(", "AdministrativeState": ")" + state + R"("})";
+            }
+            return std::string{R"({"Interfaces": [)"} + res + "]}";
+        });
+        m_manager->finishRegistration();
+    }
+
+    void setLinks(const std::map<std::string, std::string>& links)
+    {
+        std::lock_guard lock(m_mtx);
+        m_links = links;
+    }
+
+private:
+    std::unique_ptr<sdbus::IObject> m_manager;
+    std::mutex m_mtx;
+    std::map<std::string, std::string> m_links;
+};
+
+struct FakeCallback {
+    MAKE_CONST_MOCK1(changed, void(const std::vector<std::string>&));
+};
+}
+
+TEST_CASE("Tracking links managed by systemd-networkd")
+{
+    TEST_INIT_LOGS;
+    trompeloeil::sequence seq;
+
+    auto clientConnection = sdbus::createSessionBusConnection();
+    auto serverConnection = sdbus::createSessionBusConnection();
+    serverConnection->enterEventLoopAsync();
+
+    FakeNetworkd networkd(*serverConnection);
+    networkd.setLinks({{"eth0", "configured"}, {"lo", "unmanaged"}});
+
+    FakeCallback cb;
+    velia::network::ManagedLinksMonitor monitor(*clientConnection, serverConnection->getUniqueName(), {"eth0"}, 50ms, 500ms);
+    monitor.onChange([&cb](const auto& links) { cb.changed(links); });
+
+    SECTION("Nothing changed")
+    {
+        monitor.linksChanged();
+        std::this_thread::sleep_for(200ms);
+    }
+
+    SECTION("A new link")
+    {
+        networkd.setLinks({{"eth0", "configured"}, {"eth1", "configuring"}, {"lo", "unmanaged"}});
+        REQUIRE_CALL(cb, changed(std::vector<std::string>{"eth0", "eth1"})).IN_SEQUENCE(seq);
+        monitor.linksChanged();
+        std::this_thread::sleep_for(200ms);
+        REQUIRE(monitor.managedLinks() == std::vector<std::string>{"eth0", "eth1"});
+    }
+
+    SECTION("A link disappears")
+    {
+        networkd.setLinks({{"lo", "unmanaged"}});
+        REQUIRE_CALL(cb, changed(std::vector<std::string>{})).IN_SEQUENCE(seq);
+        monitor.linksChanged();
+        std::this_thread::sleep_for(200ms);
+    }
+
+    SECTION("Links which are still being set up are decided later")
+    {
+        networkd.setLinks({{"eth0", "pending"}, {"eth1", "initialized"}, {"lo", "unmanaged"}});
+        monitor.linksChanged();
+        std::this_thread::sleep_for(200ms);
+        REQUIRE(monitor.managedLinks() == std::vector<std::string>{"eth0"});
+
+        REQUIRE_CALL(cb, changed(std::vector<std::string>{"eth1"})).IN_SEQUENCE(seq);
+        networkd.setLinks({{"eth0", "unmanaged"}, {"eth1", "configured"}, {"lo", "unmanaged"}});
+        std::this_thread::sleep_for(200ms);
+    }
+
+    monitor.onChange(nullptr);
+}
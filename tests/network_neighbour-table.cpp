@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <sys/socket.h>
+#include "network/NeighbourTable.h"
+
+using Neighbours = std::vector<velia::network::NeighbourTable::Neighbour>;
+
+TEST_CASE("Neighbour table")
+{
+    velia::network::NeighbourTable table;
+
+    table.set(2, AF_INET, "192.0.2.2", "02:02:02:02:02:02");
+    table.set(2, AF_INET, "192.0.2.1", "02:02:02:02:02:01");
+    table.set(2, AF_INET6, "2001:db8::1", "02:02:02:02:02:03");
+    table.set(3, AF_INET, "192.0.2.3", "02:02:02:02:02:04");
+
+    REQUIRE(table.neighbours(2, AF_INET) == Neighbours{{"192.0.2.1", "02:02:02:02:02:01"}, {"192.0.2.2", "02:02:02:02:02:02"}});
+    REQUIRE(table.neighbours(2, AF_INET6) == Neighbours{{"2001:db8::1", "02:02:02:02:02:03"}});
+    REQUIRE(table.neighbours(3, AF_INET) == Neighbours{{"192.0.2.3", "02:02:02:02:02:04"}});
+    REQUIRE(table.neighbours(3, AF_INET6).empty());
+    REQUIRE(table.neighbours(4, AF_INET).empty());
+
+    SECTION("Link-layer address changes")
+    {
+        table.set(2, AF_INET, "192.0.2.2", "02:02:02:02:02:22");
+        REQUIRE(table.neighbours(2, AF_INET) == Neighbours{{"192.0.2.1", "02:02:02:02:02:01"}, {"192.0.2.2", "02:02:02:02:02:22"}});
+    }
+
+    SECTION("Remove a neighbour")
+    {
+        table.remove(2, AF_INET, "192.0.2.1");
+        table.remove(2, AF_INET, "192.0.2.99");
+        REQUIRE(table.neighbours(2, AF_INET) == Neighbours{{"192.0.2.2", "02:02:02:02:02:02"}});
+        REQUIRE(table.neighbours(2, AF_INET6) == Neighbours{{"2001:db8::1", "02:02:02:02:02:03"}});
+    }
+
+    SECTION("Remove a link")
+    {
+        table.removeLink(2);
+        REQUIRE(table.neighbours(2, AF_INET).empty());
+        REQUIRE(table.neighbours(2, AF_INET6).empty());
+        REQUIRE(table.neighbours(3, AF_INET) == Neighbours{{"192.0.2.3", "02:02:02:02:02:04"}});
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <atomic>
+#include <sdbus-c++/sdbus-c++.h>
+#include <thread>
+#include "network/NetworkdReload.h"
+#include "test_log_setup.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/** @brief Implements just the bits of org.freedesktop.network1.Manager which are needed for reloading */
+class FakeNetworkd {
+public:
+    explicit FakeNetworkd(sdbus::IConnection& connection)
+        : m_manager(sdbus::createObject(connection, "/org/freedesktop/network1"))
+    {
+        m_manager->registerMethod("Reload").onInterface("org.freedesktop.network1.Manager").implementedAs([this]() { ++reloads; });
+        m_manager->registerMethod("Describe").onInterface("org.freedesktop.network1.Manager").implementedAs([this]() {
+            ++describes;
+            return std::string{R"({"Interfaces": [{"Name": "eth0", "NetworkFile": "/run/systemd/network/10-eth0.network"}, {"Name": "lo"}]})"};
+        });
+        m_manager->finishRegistration();
+    }
+
+    std::atomic<int> reloads = 0;
+    std::atomic<int> describes = 0;
+
+private:
+    std::unique_ptr<sdbus::IObject> m_manager;
+};
+}
+
+TEST_CASE("Reloading systemd-networkd")
+{
+    TEST_INIT_LOGS;
+
+    auto clientConnection = sdbus::createSessionBusConnection();
+    auto serverConnection = sdbus::createSessionBusConnection();
+    serverConnection->enterEventLoopAsync();
+
+    FakeNetworkd networkd(*serverConnection);
+    velia::network::NetworkdReload reload(*clientConnection, serverConnection->getUniqueName(), {"eth0"}, {"/run/systemd/network"}, 100ms, 1s);
+
+    SECTION("Nothing happens without a request")
+    {
+        std::this_thread::sleep_for(300ms);
+        REQUIRE(networkd.reloads == 0);
+    }
+
+    SECTION("A burst of requests results in a single reload")
+    {
+        for (int i = 0; i < 10; ++i) {
+            reload.request();
+            std::this_thread::sleep_for(10ms);
+        }
+        std::this_thread::sleep_for(300ms);
+        REQUIRE(networkd.reloads == 1);
+        REQUIRE(networkd.describes == 1);
+
+        SECTION("Requests after the reload trigger another one")
+        {
+            reload.request();
+            std::this_thread::sleep_for(300ms);
+            REQUIRE(networkd.reloads == 2);
+            REQUIRE(networkd.describes == 2);
+        }
+    }
+
+    SECTION("Requests which keep coming do not postpone the reload forever")
+    {
+        for (int i = 0; i < 30; ++i) {
+            reload.request();
+            std::this_thread::sleep_for(50ms);
+        }
+        REQUIRE(networkd.reloads >= 1);
+    }
+}
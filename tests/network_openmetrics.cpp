@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include "network/OpenMetrics.h"
+#include "prometheus-helpers/text-format.h"
+
+using namespace std::string_literals;
+using namespace velia::network;
+
+TEST_CASE("OpenMetrics export of interface counters")
+{
+    const std::vector<LinkCounters> links{
+        {.name = "eth0", .inOctets = 1000, .outOctets = 2000, .inPackets = 10, .outPackets = 20, .inDiscards = 1, .outDiscards = 2, .inErrors = 3, .outErrors = 4},
+        {.name = "lo", .inOctets = 18446744073709551615ULL, .outOctets = 0, .inPackets = 0, .outPackets = 0, .inDiscards = 0, .outDiscards = 0, .inErrors = 0, .outErrors = 0},
+    };
+
+    const auto document = renderOpenMetrics(links);
+    REQUIRE(document == R"(# TYPE velia_interface_in_octets_total counter
+# HELP velia_interface_in_octets_total Total number of octets received on the interface.
+velia_interface_in_octets_total{interface="eth0"} 1000
+velia_interface_in_octets_total{interface="lo"} 18446744073709551615
+# TYPE velia_interface_out_octets_total counter
+# HELP velia_interface_out_octets_total Total number of octets transmitted out of the interface.
+velia_interface_out_octets_total{interface="eth0"} 2000
+velia_interface_out_octets_total{interface="lo"} 0
+# TYPE velia_interface_in_packets_total counter
+# HELP velia_interface_in_packets_total Total number of packets received on the interface.
+velia_interface_in_packets_total{interface="eth0"} 10
+velia_interface_in_packets_total{interface="lo"} 0
+# TYPE velia_interface_out_packets_total counter
+# HELP velia_interface_out_packets_total Total number of packets transmitted out of the interface.
+velia_interface_out_packets_total{interface="eth0"} 20
+velia_interface_out_packets_total{interface="lo"} 0
+# TYPE velia_interface_in_discards_total counter
+# HELP velia_interface_in_discards_total Number of inbound packets which were discarded.
+velia_interface_in_discards_total{interface="eth0"} 1
+velia_interface_in_discards_total{interface="lo"} 0
+# TYPE velia_interface_out_discards_total counter
+# HELP velia_interface_out_discards_total Number of outbound packets which were discarded.
+velia_interface_out_discards_total{interface="eth0"} 2
+velia_interface_out_discards_total{interface="lo"} 0
+# TYPE velia_interface_in_errors_total counter
+# HELP velia_interface_in_errors_total Number of inbound packets that contained errors.
+velia_interface_in_errors_total{interface="eth0"} 3
+velia_interface_in_errors_total{interface="lo"} 0
+# TYPE velia_interface_out_errors_total counter
+# HELP velia_interface_out_errors_total Number of outbound packets that could not be transmitted because of errors.
+velia_interface_out_errors_total{interface="eth0"} 4
+velia_interface_out_errors_total{interface="lo"} 0
+)");
+
+    std::map<std::string, PrometheusFamily> families;
+    for (const auto& name : {"in_octets", "out_octets", "in_packets", "out_packets", "in_discards", "out_discards", "in_errors", "out_errors"}) {
+        families["velia_interface_"s + name + "_total"] = {.type = "counter", .samples = 2};
+    }
+    REQUIRE(parsePrometheusText(document) == families);
+
+    REQUIRE(renderOpenMetrics({}) == R"(# TYPE velia_interface_in_octets_total counter
+# HELP velia_interface_in_octets_total Total number of octets received on the interface.
+# TYPE velia_interface_out_octets_total counter
+# HELP velia_interface_out_octets_total Total number of octets transmitted out of the interface.
+# TYPE velia_interface_in_packets_total counter
+# HELP velia_interface_in_packets_total Total number of packets received on the interface.
+# TYPE velia_interface_out_packets_total counter
+# HELP velia_interface_out_packets_total Total number of packets transmitted out of the interface.
+# TYPE velia_interface_in_discards_total counter
+# HELP velia_interface_in_discards_total Number of inbound packets which were discarded.
+# TYPE velia_interface_out_discards_total counter
+# HELP velia_interface_out_discards_total Number of outbound packets which were discarded.
+# TYPE velia_interface_in_errors_total counter
+# HELP velia_interface_in_errors_total Number of inbound packets that contained errors.
+# TYPE velia_interface_out_errors_total counter
+# HELP velia_interface_out_errors_total Number of outbound packets that could not be transmitted because of errors.
+)");
+}
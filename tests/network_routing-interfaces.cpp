@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <sys/socket.h>
+#include "network/RoutingInterfaces.h"
+#include "tests/pretty_printers.h"
+
+using namespace std::string_literals;
+using velia::network::RoutingInterfaces;
+
+namespace {
+
+const auto ROUTER_ID = "/ietf-routing:routing/router-id"s;
+
+std::string iface(const std::string& name)
+{
+    return "/ietf-routing:routing/interfaces/interface[.='" + name + "']";
+}
+
+std::map<std::string, std::string> toMap(const velia::utils::YANGData& values)
+{
+    std::map<std::string, std::string> res;
+    for (const auto& [xpath, value] : values) {
+        res.emplace(xpath, value);
+    }
+    return res;
+}
+
+using Values = std::map<std::string, std::string>;
+using Removals = std::vector<std::string>;
+}
+
+TEST_CASE("ietf-routing interfaces and router-id")
+{
+    RoutingInterfaces routing(true);
+
+    // a link without addresses is not a network-layer interface
+    auto changes = routing.updateLink(1, "lo");
+    REQUIRE(changes.values.empty());
+    REQUIRE(changes.removals.empty());
+
+    changes = routing.updateAddress(1, AF_INET, "127.0.0.1", true);
+    REQUIRE(toMap(changes.values) == Values{{iface("lo"), "lo"}});
+    REQUIRE(changes.removals.empty());
+
+    changes = routing.updateAddress(1, AF_INET6, "::1", true);
+    REQUIRE(changes.values.empty());
+    REQUIRE(changes.removals.empty());
+
+    changes = routing.updateLink(2, "eth0");
+    REQUIRE(changes.values.empty());
+
+    changes = routing.updateAddress(2, AF_INET, "192.0.2.1", true);
+    REQUIRE(toMap(changes.values) == Values{{iface("eth0"), "eth0"}, {ROUTER_ID, "192.0.2.1"}});
+    REQUIRE(changes.removals.empty());
+
+    SECTION("The highest IPv4 address wins")
+    {
+        changes = routing.updateAddress(2, AF_INET6, "2001:db8::1", true);
+        REQUIRE(changes.values.empty());
+
+        changes = routing.updateAddress(2, AF_INET, "10.0.0.1", true);
+        REQUIRE(changes.values.empty());
+        REQUIRE(changes.removals.empty());
+
+        changes = routing.updateAddress(3, AF_INET, "198.51.100.1", true);
+        REQUIRE(toMap(changes.values) == Values{{ROUTER_ID, "198.51.100.1"}});
+
+        // the address arrived before the link was announced
+        changes = routing.updateLink(3, "eth1");
+        REQUIRE(toMap(changes.values) == Values{{iface("eth1"), "eth1"}});
+        REQUIRE(changes.removals.empty());
+
+        changes = routing.updateAddress(3, AF_INET, "198.51.100.1", false);
+        REQUIRE(toMap(changes.values) == Values{{ROUTER_ID, "192.0.2.1"}});
+        REQUIRE(changes.removals == Removals{iface("eth1")});
+
+        changes = routing.updateAddress(2, AF_INET, "192.0.2.1", false);
+        REQUIRE(toMap(changes.values) == Values{{ROUTER_ID, "10.0.0.1"}});
+        REQUIRE(changes.removals.empty());
+    }
+
+    SECTION("The same address on two links")
+    {
+        routing.updateLink(3, "eth1");
+        changes = routing.updateAddress(3, AF_INET, "192.0.2.1", true);
+        REQUIRE(toMap(changes.values) == Values{{iface("eth1"), "eth1"}});
+
+        changes = routing.updateLink(2, std::nullopt);
+        REQUIRE(changes.values.empty());
+        REQUIRE(changes.removals == Removals{iface("eth0")});
+
+        changes = routing.updateLink(3, std::nullopt);
+        REQUIRE(changes.values.empty());
+        REQUIRE(changes.removals == Removals{iface("eth1"), ROUTER_ID});
+    }
+
+    SECTION("Link rename")
+    {
+        changes = routing.updateLink(2, "wan");
+        REQUIRE(toMap(changes.values) == Values{{iface("wan"), "wan"}});
+        REQUIRE(changes.removals == Removals{iface("eth0")});
+    }
+
+    SECTION("Link removal before its addresses")
+    {
+        changes = routing.updateLink(2, std::nullopt);
+        REQUIRE(changes.removals == Removals{iface("eth0"), ROUTER_ID});
+
+        changes = routing.updateAddress(2, AF_INET, "192.0.2.1", false);
+        REQUIRE(changes.values.empty());
+        REQUIRE(changes.removals.empty());
+    }
+
+    SECTION("Only loopback addresses left")
+    {
+        changes = routing.updateAddress(2, AF_INET, "192.0.2.1", false);
+        REQUIRE(changes.values.empty());
+        REQUIRE(changes.removals == Removals{iface("eth0"), ROUTER_ID});
+    }
+}
+
+TEST_CASE("router-id is not published without the feature")
+{
+    RoutingInterfaces routing(false);
+    routing.updateLink(2, "eth0");
+    auto changes = routing.updateAddress(2, AF_INET, "192.0.2.1", true);
+    REQUIRE(toMap(changes.values) == Values{{iface("eth0"), "eth0"}});
+    REQUIRE(changes.removals.empty());
+}
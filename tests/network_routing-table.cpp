@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <netlink/route/route.h>
+#include "network/RoutingTable.h"
+#include "tests/pretty_printers.h"
+#include "tests/test_log_setup.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+using Route = std::unique_ptr<rtnl_route, decltype(&rtnl_route_put)>;
+
+Route makeRoute(const std::string& destination, uint32_t priority, int ifindex, const std::optional<std::string>& gateway = std::nullopt, uint8_t proto = RTPROT_STATIC)
+{
+    const auto family = destination.find(':') == std::string::npos ? AF_INET : AF_INET6;
+    Route route(rtnl_route_alloc(), rtnl_route_put);
+    rtnl_route_set_family(route.get(), family);
+    rtnl_route_set_table(route.get(), RT_TABLE_MAIN);
+    rtnl_route_set_type(route.get(), RTN_UNICAST);
+    rtnl_route_set_protocol(route.get(), proto);
+    rtnl_route_set_scope(route.get(), gateway ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK);
+    rtnl_route_set_priority(route.get(), priority);
+
+    nl_addr* addr;
+    REQUIRE(nl_addr_parse(destination.c_str(), family, &addr) == 0);
+    rtnl_route_set_dst(route.get(), addr);
+    nl_addr_put(addr);
+
+    auto* nh = rtnl_route_nh_alloc();
+    rtnl_route_nh_set_ifindex(nh, ifindex);
+    if (gateway) {
+        REQUIRE(nl_addr_parse(gateway->c_str(), family, &addr) == 0);
+        rtnl_route_nh_set_gateway(nh, addr);
+        nl_addr_put(addr);
+    }
+    rtnl_route_add_nexthop(route.get(), nh);
+
+    return route;
+}
+
+const auto RIB4 = "/ietf-routing:routing/ribs/rib[name='ipv4-master']/routes"s;
+const auto RIB6 = "/ietf-routing:routing/ribs/rib[name='ipv6-master']/routes"s;
+
+std::map<std::string, std::string> toMap(const velia::utils::YANGData& values)
+{
+    std::map<std::string, std::string> res;
+    for (const auto& [xpath, value] : values) {
+        res.emplace(xpath, value);
+    }
+    return res;
+}
+}
+
+TEST_CASE("Incremental routing table")
+{
+    TEST_INIT_LOGS;
+
+    velia::network::RoutingTable rib(spdlog::get("network"));
+    REQUIRE(!rib.updateLink(2, "eth0"));
+    REQUIRE(!rib.updateLink(3, "eth1"));
+
+    REQUIRE(rib.updateRoute(makeRoute("192.0.2.0/24", 0, 2).get(), NL_ACT_NEW));
+    REQUIRE(rib.updateRoute(makeRoute("203.0.113.0/24", 0, 3).get(), NL_ACT_NEW));
+    REQUIRE(rib.updateRoute(makeRoute("2001:db8::/32", 100, 2).get(), NL_ACT_NEW));
+
+    auto changes = rib.changes();
+    REQUIRE(changes.removals.empty());
+    REQUIRE(toMap(changes.values) == std::map<std::string, std::string>{
+                {RIB4 + "/route[1]/ietf-ipv4-unicast-routing:destination-prefix", "192.0.2.0/24"},
+                {RIB4 + "/route[1]/source-protocol", "static"},
+                {RIB4 + "/route[1]/route-preference", "0"},
+                {RIB4 + "/route[1]/next-hop/outgoing-interface", "eth0"},
+                {RIB4 + "/route[2]/ietf-ipv4-unicast-routing:destination-prefix", "203.0.113.0/24"},
+                {RIB4 + "/route[2]/source-protocol", "static"},
+                {RIB4 + "/route[2]/route-preference", "0"},
+                {RIB4 + "/route[2]/next-hop/outgoing-interface", "eth1"},
+                {RIB6 + "/route[1]/ietf-ipv6-unicast-routing:destination-prefix", "2001:db8::/32"},
+                {RIB6 + "/route[1]/source-protocol", "static"},
+                {RIB6 + "/route[1]/route-preference", "100"},
+                {RIB6 + "/route[1]/next-hop/outgoing-interface", "eth0"},
+            });
+
+    SECTION("Nothing changed")
+    {
+        REQUIRE(!rib.updateRoute(makeRoute("192.0.2.0/24", 0, 2).get(), NL_ACT_CHANGE));
+        changes = rib.changes();
+        REQUIRE(changes.removals.empty());
+        REQUIRE(changes.values.empty());
+    }
+
+    SECTION("Appending a route does not touch the preceding ones")
+    {
+        REQUIRE(rib.updateRoute(makeRoute("203.0.113.128/25", 0, 2, "192.0.2.1").get(), NL_ACT_NEW));
+        REQUIRE(rib.updateRoute(makeRoute("2001:db8:ffff::/48", 100, 3, "2001:db8::1").get(), NL_ACT_NEW));
+        changes = rib.changes();
+        REQUIRE(changes.removals.empty());
+        REQUIRE(toMap(changes.values) == std::map<std::string, std::string>{
+                    {RIB4 + "/route[3]/ietf-ipv4-unicast-routing:destination-prefix", "203.0.113.128/25"},
+                    {RIB4 + "/route[3]/source-protocol", "static"},
+                    {RIB4 + "/route[3]/route-preference", "0"},
+                    {RIB4 + "/route[3]/next-hop/ietf-ipv4-unicast-routing:next-hop-address", "192.0.2.1"},
+                    {RIB4 + "/route[3]/next-hop/outgoing-interface", "eth0"},
+                    {RIB6 + "/route[2]/ietf-ipv6-unicast-routing:destination-prefix", "2001:db8:ffff::/48"},
+                    {RIB6 + "/route[2]/source-protocol", "static"},
+                    {RIB6 + "/route[2]/route-preference", "100"},
+                    {RIB6 + "/route[2]/next-hop/ietf-ipv6-unicast-routing:next-hop-address", "2001:db8::1"},
+                    {RIB6 + "/route[2]/next-hop/outgoing-interface", "eth1"},
+                });
+    }
+
+    SECTION("Routes keep their list entries")
+    {
+        REQUIRE(rib.updateRoute(makeRoute("0.0.0.0/0", 0, 2, "192.0.2.1").get(), NL_ACT_NEW));
+        REQUIRE(rib.updateRoute(makeRoute("192.0.2.0/24", 0, 3, "203.0.113.1").get(), NL_ACT_CHANGE));
+        changes = rib.changes();
+        REQUIRE(changes.removals == std::vector<std::string>{RIB4 + "/route[1]/next-hop"});
+        REQUIRE(toMap(changes.values) == std::map<std::string, std::string>{
+                    {RIB4 + "/route[1]/ietf-ipv4-unicast-routing:destination-prefix", "192.0.2.0/24"},
+                    {RIB4 + "/route[1]/source-protocol", "static"},
+                    {RIB4 + "/route[1]/route-preference", "0"},
+                    {RIB4 + "/route[1]/next-hop/ietf-ipv4-unicast-routing:next-hop-address", "203.0.113.1"},
+                    {RIB4 + "/route[1]/next-hop/outgoing-interface", "eth1"},
+                    {RIB4 + "/route[3]/ietf-ipv4-unicast-routing:destination-prefix", "0.0.0.0/0"},
+                    {RIB4 + "/route[3]/source-protocol", "static"},
+                    {RIB4 + "/route[3]/route-preference", "0"},
+                    {RIB4 + "/route[3]/next-hop/ietf-ipv4-unicast-routing:next-hop-address", "192.0.2.1"},
+                    {RIB4 + "/route[3]/next-hop/outgoing-interface", "eth0"},
+                });
+    }
+
+    SECTION("Route added and removed before publishing")
+    {
+        REQUIRE(rib.updateRoute(makeRoute("198.51.100.0/24", 0, 2).get(), NL_ACT_NEW));
+        REQUIRE(rib.updateRoute(makeRoute("198.51.100.0/24", 0, 2).get(), NL_ACT_DEL));
+        changes = rib.changes();
+        REQUIRE(changes.removals.empty());
+        REQUIRE(changes.values.empty());
+    }
+
+    SECTION("Removing a route")
+    {
+        REQUIRE(rib.updateRoute(makeRoute("192.0.2.0/24", 0, 2).get(), NL_ACT_DEL));
+        REQUIRE(!rib.updateRoute(makeRoute("198.51.100.0/24", 0, 2).get(), NL_ACT_DEL));
+        changes = rib.changes();
+        // the last route takes over the freed list entry
+        REQUIRE(changes.removals == std::vector<std::string>{RIB4 + "/route[2]", RIB4 + "/route[1]/next-hop"});
+        REQUIRE(toMap(changes.values) == std::map<std::string, std::string>{
+                    {RIB4 + "/route[1]/ietf-ipv4-unicast-routing:destination-prefix", "203.0.113.0/24"},
+                    {RIB4 + "/route[1]/source-protocol", "static"},
+                    {RIB4 + "/route[1]/route-preference", "0"},
+                    {RIB4 + "/route[1]/next-hop/outgoing-interface", "eth1"},
+                });
+    }
+
+    SECTION("Routes which are not published")
+    {
+        REQUIRE(!rib.updateRoute(makeRoute("198.51.100.0/24", 0, 2, std::nullopt, RTPROT_BGP).get(), NL_ACT_NEW));
+
+        auto other = makeRoute("198.51.100.0/24", 0, 2);
+        rtnl_route_set_table(other.get(), RT_TABLE_LOCAL);
+        REQUIRE(!rib.updateRoute(other.get(), NL_ACT_NEW));
+
+        // a route which switches to an unsupported protocol disappears
+        REQUIRE(rib.updateRoute(makeRoute("203.0.113.0/24", 0, 3, std::nullopt, RTPROT_BGP).get(), NL_ACT_CHANGE));
+        changes = rib.changes();
+        REQUIRE(changes.removals == std::vector<std::string>{RIB4 + "/route[2]"});
+        REQUIRE(changes.values.empty());
+    }
+
+    SECTION("Renamed link")
+    {
+        REQUIRE(!rib.updateLink(4, "eth2"));
+        REQUIRE(rib.updateLink(3, "uplink"));
+        changes = rib.changes();
+        REQUIRE(changes.removals == std::vector<std::string>{RIB4 + "/route[2]/next-hop"});
+        REQUIRE(toMap(changes.values) == std::map<std::string, std::string>{
+                    {RIB4 + "/route[2]/ietf-ipv4-unicast-routing:destination-prefix", "203.0.113.0/24"},
+                    {RIB4 + "/route[2]/source-protocol", "static"},
+                    {RIB4 + "/route[2]/route-preference", "0"},
+                    {RIB4 + "/route[2]/next-hop/outgoing-interface", "uplink"},
+                });
+    }
+}
+
+TEST_CASE("Routing tables and VRFs as separate RIBs")
+{
+    TEST_INIT_LOGS;
+
+    const auto POLICY4 = "/ietf-routing:routing/ribs/rib[name='ipv4-policy']/routes"s;
+    const auto MGMT6 = "/ietf-routing:routing/ribs/rib[name='ipv6-mgmt']/routes"s;
+
+    velia::network::RoutingTable rib(spdlog::get("network"), {velia::network::MAIN_RIB, {.name = "policy", .table = uint32_t{100}}, {.name = "mgmt", .table = "vrf-mgmt"}});
+    REQUIRE(!rib.updateLink(2, "eth0"));
+
+    auto policy = makeRoute("0.0.0.0/0", 0, 2, "192.0.2.1");
+    rtnl_route_set_table(policy.get(), 100);
+    REQUIRE(rib.updateRoute(policy.get(), NL_ACT_NEW));
+    REQUIRE(rib.updateRoute(makeRoute("192.0.2.0/24", 0, 2).get(), NL_ACT_NEW));
+
+    // the VRF does not exist yet
+    auto mgmt = makeRoute("2001:db8::/32", 0, 2);
+    rtnl_route_set_table(mgmt.get(), 10);
+    REQUIRE(!rib.updateRoute(mgmt.get(), NL_ACT_NEW));
+
+    auto changes = rib.changes();
+    REQUIRE(changes.removals.empty());
+    REQUIRE(toMap(changes.values) == std::map<std::string, std::string>{
+                {RIB4 + "/route[1]/ietf-ipv4-unicast-routing:destination-prefix", "192.0.2.0/24"},
+                {RIB4 + "/route[1]/source-protocol", "static"},
+                {RIB4 + "/route[1]/route-preference", "0"},
+                {RIB4 + "/route[1]/next-hop/outgoing-interface", "eth0"},
+                {POLICY4 + "/route[1]/ietf-ipv4-unicast-routing:destination-prefix", "0.0.0.0/0"},
+                {POLICY4 + "/route[1]/source-protocol", "static"},
+                {POLICY4 + "/route[1]/route-preference", "0"},
+                {POLICY4 + "/route[1]/next-hop/ietf-ipv4-unicast-routing:next-hop-address", "192.0.2.1"},
+                {POLICY4 + "/route[1]/next-hop/outgoing-interface", "eth0"},
+            });
+
+    // a VRF which is not exported
+    REQUIRE(!rib.updateLink(4, "vrf-other", 10));
+    REQUIRE(!rib.updateRoute(mgmt.get(), NL_ACT_NEW));
+
+    REQUIRE(!rib.updateLink(3, "vrf-mgmt", 10));
+    REQUIRE(rib.updateRoute(mgmt.get(), NL_ACT_NEW));
+    changes = rib.changes();
+    REQUIRE(changes.removals.empty());
+    REQUIRE(toMap(changes.values) == std::map<std::string, std::string>{
+                {MGMT6 + "/route[1]/ietf-ipv6-unicast-routing:destination-prefix", "2001:db8::/32"},
+                {MGMT6 + "/route[1]/source-protocol", "static"},
+                {MGMT6 + "/route[1]/route-preference", "0"},
+                {MGMT6 + "/route[1]/next-hop/outgoing-interface", "eth0"},
+            });
+
+    SECTION("VRF removed")
+    {
+        REQUIRE(rib.updateLink(3, std::nullopt));
+    }
+
+    SECTION("VRF renamed")
+    {
+        REQUIRE(rib.updateLink(3, "vrf-renamed", 10));
+    }
+
+    // the whole RIB is gone, not just its routes
+    changes = rib.changes();
+    REQUIRE(changes.removals == std::vector<std::string>{"/ietf-routing:routing/ribs/rib[name='ipv6-mgmt']"});
+    REQUIRE(changes.values.empty());
+    REQUIRE(!rib.updateRoute(mgmt.get(), NL_ACT_CHANGE));
+
+    changes = rib.changes();
+    REQUIRE(changes.removals.empty());
+    REQUIRE(changes.values.empty());
+
+    // a VRF with the same name which appears again is published from scratch
+    REQUIRE(!rib.updateLink(5, "vrf-mgmt", 10));
+    REQUIRE(rib.updateRoute(mgmt.get(), NL_ACT_NEW));
+    changes = rib.changes();
+    REQUIRE(changes.removals.empty());
+    REQUIRE(toMap(changes.values) == std::map<std::string, std::string>{
+                {MGMT6 + "/route[1]/ietf-ipv6-unicast-routing:destination-prefix", "2001:db8::/32"},
+                {MGMT6 + "/route[1]/source-protocol", "static"},
+                {MGMT6 + "/route[1]/route-preference", "0"},
+                {MGMT6 + "/route[1]/next-hop/outgoing-interface", "eth0"},
+            });
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include "network/StatisticsSampler.h"
+#include "tests/test_log_setup.h"
+
+using namespace std::chrono_literals;
+using velia::network::InterfaceCounters;
+using velia::network::InterfaceRates;
+
+namespace {
+InterfaceCounters counters(uint64_t octets, uint64_t packets)
+{
+    return {
+        .inOctets = octets,
+        .inPackets = packets,
+        .inMulticastPackets = 0,
+        .inDiscards = 0,
+        .inErrors = 0,
+        .inUnknownProtos = 0,
+        .outOctets = 2 * octets,
+        .outPackets = 2 * packets,
+        .outDiscards = 0,
+        .outErrors = 0,
+    };
+}
+}
+
+TEST_CASE("Interface statistics sampler")
+{
+    TEST_INIT_LOGS;
+
+    std::map<std::string, InterfaceCounters> current{{"eth0", counters(0, 0)}};
+    std::mutex mtx;
+
+    // the background thread never kicks in during the test, all the samples are taken explicitly
+    velia::network::StatisticsSampler sampler([&]() {
+        std::lock_guard lock(mtx);
+        return current;
+    }, 1h, 10s);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    auto sampleAt = [&](std::chrono::seconds offset, std::map<std::string, InterfaceCounters> data) {
+        {
+            std::lock_guard lock(mtx);
+            current = std::move(data);
+        }
+        sampler.sample(t0 + offset);
+    };
+
+    SECTION("No rates are available after the first sample")
+    {
+        auto snapshot = sampler.snapshot();
+        REQUIRE(snapshot.size() == 1);
+        REQUIRE(snapshot["eth0"].counters == counters(0, 0));
+        REQUIRE(snapshot["eth0"].rates == std::nullopt);
+    }
+
+    SECTION("Rates")
+    {
+        sampleAt(0s, {{"eth0", counters(0, 0)}});
+        sampleAt(2s, {{"eth0", counters(1000, 12)}});
+        auto snapshot = sampler.snapshot();
+        REQUIRE(snapshot["eth0"].counters == counters(1000, 12));
+        REQUIRE(snapshot["eth0"].rates == InterfaceRates{.inBitsPerSecond = 4000, .outBitsPerSecond = 8000, .inPacketsPerSecond = 6, .outPacketsPerSecond = 12});
+
+        SECTION("Averaged over the window")
+        {
+            sampleAt(4s, {{"eth0", counters(1000, 12)}});
+            REQUIRE(sampler.snapshot()["eth0"].rates == InterfaceRates{.inBitsPerSecond = 2000, .outBitsPerSecond = 4000, .inPacketsPerSecond = 3, .outPacketsPerSecond = 6});
+
+            // the samples which are older than the window are forgotten
+            sampleAt(12s, {{"eth0", counters(1000, 12)}});
+            sampleAt(14s, {{"eth0", counters(1000, 12)}});
+            REQUIRE(sampler.snapshot()["eth0"].rates == InterfaceRates{.inBitsPerSecond = 0, .outBitsPerSecond = 0, .inPacketsPerSecond = 0, .outPacketsPerSecond = 0});
+        }
+
+        SECTION("Counters going backwards restart the history")
+        {
+            sampleAt(4s, {{"eth0", counters(100, 1)}});
+            snapshot = sampler.snapshot();
+            REQUIRE(snapshot["eth0"].counters == counters(100, 1));
+            REQUIRE(snapshot["eth0"].rates == std::nullopt);
+
+            sampleAt(5s, {{"eth0", counters(200, 2)}});
+            REQUIRE(sampler.snapshot()["eth0"].rates == InterfaceRates{.inBitsPerSecond = 800, .outBitsPerSecond = 1600, .inPacketsPerSecond = 1, .outPacketsPerSecond = 2});
+        }
+
+        SECTION("Interfaces come and go")
+        {
+            sampleAt(4s, {{"eth1", counters(5, 5)}});
+            snapshot = sampler.snapshot();
+            REQUIRE(snapshot.size() == 1);
+            REQUIRE(snapshot["eth1"].rates == std::nullopt);
+
+            // eth0 was forgotten in the meantime
+            sampleAt(6s, {{"eth0", counters(5000, 50)}, {"eth1", counters(5, 5)}});
+            snapshot = sampler.snapshot();
+            REQUIRE(snapshot.size() == 2);
+            REQUIRE(snapshot["eth0"].rates == std::nullopt);
+            REQUIRE(snapshot["eth1"].rates == InterfaceRates{.inBitsPerSecond = 0, .outBitsPerSecond = 0, .inPacketsPerSecond = 0, .outPacketsPerSecond = 0});
+        }
+    }
+
+    SECTION("A failing source yields no statistics")
+    {
+        velia::network::StatisticsSampler failing([]() -> std::map<std::string, InterfaceCounters> {
+            throw std::runtime_error("netlink is gone");
+        }, 1h, 10s);
+        REQUIRE(failing.snapshot().empty());
+    }
+}
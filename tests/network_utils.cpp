@@ -101,3 +101,14 @@ TEST_CASE("Active network configuration files")
                            "Link eth0 not found in networkctl JSON data",
                            std::invalid_argument);
 }
+
+TEST_CASE("Parsing just the selected members of networkctl JSON")
+{
+    const auto data = R"({"Interfaces": [{"Name": "eth0", "Type": "ether", "LLDP": {"ChassisID": "c1", "Other": 1}}, {"Name": "eth1", "Addresses": [{"Family": 2}]}], "Other": {"Name": "x"}})";
+
+    REQUIRE(velia::network::parseSelectedMembers(data, {{1, {"Interfaces"}}, {3, {"Name"}}}) == nlohmann::json::parse(R"({"Interfaces": [{"Name": "eth0"}, {"Name": "eth1"}]})"));
+    REQUIRE(velia::network::parseSelectedMembers(data, {{1, {"Interfaces"}}, {3, {"LLDP"}}, {4, {"ChassisID"}}}) == nlohmann::json::parse(R"({"Interfaces": [{"LLDP": {"ChassisID": "c1"}}, {}]})"));
+    REQUIRE(velia::network::parseSelectedMembers(data, {{1, {"Other"}}}) == nlohmann::json::parse(R"({"Other": {"Name": "x"}})"));
+    REQUIRE(velia::network::parseSelectedMembers(data, {}) == nlohmann::json::parse(data));
+    REQUIRE_THROWS_AS(velia::network::parseSelectedMembers(R"({"Interfaces": [)", {{1, {"Interfaces"}}}), nlohmann::json::parse_error);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include "text-format.h"
+
+namespace {
+const std::set<std::string> KNOWN_TYPES{"counter", "gauge", "histogram", "summary", "untyped"};
+const std::regex METRIC_NAME{"[a-zA-Z_:][a-zA-Z0-9_:]*"};
+const std::regex HELP_OR_TYPE{R"(# (HELP|TYPE) ([^ ]+) (.*))"};
+const std::regex SAMPLE{R"(([^{ ]+)(\{(.*)\})? ([^ ]+)( -?[0-9]+)?)"};
+const std::regex LABEL{R"(([a-zA-Z_][a-zA-Z0-9_]*)="((?:[^"\\]|\\[\\"n])*)\"(,|$))"};
+const std::regex VALUE{R"([+-]?([0-9]+(\.[0-9]*)?([eE][+-]?[0-9]+)?|Inf|NaN))"};
+}
+
+/** @short Checks a document against the rules of the Prometheus text exposition format, version 0.0.4
+ *
+ * This is what node_exporter's textfile collector reads. Any violation which would make it reject the whole file throws.
+ * On top of that, all samples must belong to a family which was introduced by a TYPE line, so that no type is silently lost.
+ */
+std::map<std::string, PrometheusFamily> parsePrometheusText(const std::string& document)
+{
+    std::map<std::string, PrometheusFamily> families;
+    std::set<std::string> helps;
+    std::set<std::string> series;
+    std::string current;
+
+    std::istringstream stream(document);
+    std::string line;
+    for (size_t lineNo = 1; std::getline(stream, line); ++lineNo) {
+        auto fail = [&](const std::string& what) {
+            throw std::runtime_error("line " + std::to_string(lineNo) + ": " + what + ": " + line);
+        };
+
+        if (line.empty()) {
+            continue;
+        }
+
+        std::smatch match;
+        if (line[0] == '#') {
+            if (line == "# EOF") {
+                fail("OpenMetrics EOF marker");
+            }
+            if (!std::regex_match(line, match, HELP_OR_TYPE)) {
+                continue; // just a comment
+            }
+
+            const auto name = match.str(2);
+            if (!std::regex_match(name, METRIC_NAME)) {
+                fail("invalid metric name");
+            }
+
+            if (match.str(1) == "HELP") {
+                if (!helps.insert(name).second) {
+                    fail("second HELP line for a metric name");
+                }
+                continue;
+            }
+
+            if (!KNOWN_TYPES.contains(match.str(3))) {
+                fail("unknown metric type");
+            }
+            if (families.contains(name)) {
+                fail("second TYPE line for a metric name, or TYPE reported after samples");
+            }
+            families[name].type = match.str(3);
+            current = name;
+            continue;
+        }
+
+        if (!std::regex_match(line, match, SAMPLE)) {
+            fail("invalid sample");
+        }
+
+        const auto name = match.str(1);
+        if (!std::regex_match(name, METRIC_NAME)) {
+            fail("invalid metric name");
+        }
+        if (!std::regex_match(match.str(4), VALUE)) {
+            fail("invalid value");
+        }
+
+        std::set<std::string> labelNames;
+        auto labels = match.str(3);
+        for (std::smatch label; !labels.empty(); labels = label.suffix()) {
+            if (!std::regex_search(labels, label, LABEL, std::regex_constants::match_continuous)) {
+                fail("invalid label");
+            }
+            if (!labelNames.insert(label.str(1)).second) {
+                fail("duplicate label name");
+            }
+        }
+
+        // the suffixed samples of the other types are not produced by us
+        const auto& family = families.find(name);
+        if (family == families.end() || name != current || (family->second.type != "counter" && family->second.type != "gauge")) {
+            fail("sample does not belong to the last counter or gauge family");
+        }
+        if (!series.insert(name + "{" + match.str(3) + "}").second) {
+            fail("duplicate series");
+        }
+        ++family->second.samples;
+    }
+
+    return families;
+}
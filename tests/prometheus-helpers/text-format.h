@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+/** @short What a Prometheus text format parser makes out of a document: metric family name -> its type and the number of samples */
+struct PrometheusFamily {
+    std::string type;
+    size_t samples = 0;
+
+    bool operator==(const PrometheusFamily&) const = default;
+};
+
+std::map<std::string, PrometheusFamily> parsePrometheusText(const std::string& document);
@@ -6,6 +6,7 @@
 */
 
 #include "trompeloeil_doctest.h"
+#include <sstream>
 #include <sysrepo-cpp/Connection.hpp>
 #include "firewall/Firewall.h"
 #include "test_log_setup.h"
@@ -13,10 +14,22 @@
 class MockNft {
 public:
     MAKE_MOCK1(consumeConfig, void(const std::string&));
-    void operator()(const std::string& config)
+    /** @short Echoes all added objects along with a new handle, just like `nft --echo --handle` */
+    std::string operator()(const std::string& config)
     {
         consumeConfig(config);
+        std::istringstream ss(config);
+        std::string echo;
+        for (std::string line; std::getline(ss, line);) {
+            if (line.starts_with("add ")) {
+                echo += line + " # handle " + std::to_string(++m_lastHandle) + "\n";
+            }
+        }
+        return echo;
     }
+
+private:
+    uint64_t m_lastHandle = 0;
 };
 
 const std::string NFTABLES_OUTPUT_START = R"(flush ruleset
@@ -41,27 +54,23 @@ TEST_CASE("nftables generator")
     SECTION("include files")
     {
         REQUIRE_CALL(nft, consumeConfig(NFTABLES_OUTPUT_START + "include \"/some/file\"\n"));
-        velia::firewall::SysrepoFirewall fwWithIncludes(srSess, [&nft] (const std::string& config) {nft.consumeConfig(config);}, {"/some/file"});
+        velia::firewall::SysrepoFirewall fwWithIncludes(srSess, std::ref(nft), {"/some/file"});
     }
 
     REQUIRE_CALL(nft, consumeConfig(NFTABLES_OUTPUT_START));
-    velia::firewall::SysrepoFirewall fw(srSess, [&nft] (const std::string& config) {nft.consumeConfig(config);});
+    velia::firewall::SysrepoFirewall fw(srSess, std::ref(nft));
     std::string inputData;
     std::string expectedOutput;
 
     SECTION("empty ACL start")
     {
-        // Add an empty ACL
-        {
-            REQUIRE_CALL(nft, consumeConfig(NFTABLES_OUTPUT_START));
-            srSess.setItem("/ietf-access-control-list:acls/acl[name='acls']/type", "mixed-eth-ipv4-ipv6-acl-type");
-            srSess.applyChanges(TIMEOUT);
-        }
+        // Add an empty ACL, which does not change any rule
+        srSess.setItem("/ietf-access-control-list:acls/acl[name='acls']/type", "mixed-eth-ipv4-ipv6-acl-type");
+        srSess.applyChanges(TIMEOUT);
 
         SECTION("add an IPv4 ACE")
         {
-            expectedOutput = NFTABLES_OUTPUT_START +
-                "add rule inet filter acls ip saddr 192.168.0.0/24 drop comment \"deny 192.168.0.0/24\"\n";
+            expectedOutput = "add rule inet filter acls position 4 ip saddr 192.168.0.0/24 drop comment \"deny 192.168.0.0/24\"\n";
             srSess.setItem(
                     "/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='deny 192.168.0.0/24']/matches/ipv4/source-ipv4-network",
                     "192.168.0.0/24");
@@ -70,8 +79,7 @@ TEST_CASE("nftables generator")
 
         SECTION("add an IPv6 ACE")
         {
-            expectedOutput = NFTABLES_OUTPUT_START +
-                "add rule inet filter acls ip6 saddr 2001:db8:85a3::8a2e:370:7334/128 accept comment \"deny an ipv6 address\"\n";
+            expectedOutput = "add rule inet filter acls position 4 ip6 saddr 2001:db8:85a3::8a2e:370:7334/128 accept comment \"deny an ipv6 address\"\n";
             srSess.setItem(
                     "/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='deny an ipv6 address']/matches/ipv6/source-ipv6-network",
                     "2001:0db8:85a3:0000:0000:8a2e:0370:7334/128");
@@ -80,30 +88,28 @@ TEST_CASE("nftables generator")
 
         SECTION("add ACE without 'matches'")
         {
-            expectedOutput = NFTABLES_OUTPUT_START +
-                "add rule inet filter acls drop comment \"drop eveything\"\n";
+            expectedOutput = "add rule inet filter acls position 4 drop comment \"drop eveything\"\n";
             srSess.setItem("/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='drop eveything']/actions/forwarding", "drop");
         }
 
         SECTION("add ACE with 'reject'")
         {
-            expectedOutput = NFTABLES_OUTPUT_START +
-                "add rule inet filter acls reject comment \"reject eveything\"\n";
+            expectedOutput = "add rule inet filter acls position 4 reject comment \"reject eveything\"\n";
             srSess.setItem("/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='reject eveything']/actions/forwarding", "reject");
         }
 
         SECTION("add ACE with 'reject'")
         {
-            expectedOutput = NFTABLES_OUTPUT_START +
-                "add rule inet filter acls reject comment \"reject eveything\"\n";
+            expectedOutput = "add rule inet filter acls position 4 reject comment \"reject eveything\"\n";
             srSess.setItem("/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='reject eveything']/actions/forwarding", "reject");
         }
 
         SECTION("add two ACEs")
         {
-            expectedOutput = NFTABLES_OUTPUT_START +
-                "add rule inet filter acls ip saddr 192.168.0.0/24 drop comment \"deny 192.168.0.0/24\"\n"
-                "add rule inet filter acls reject comment \"reject eveything\"\n";
+            // both are added right behind the localhost rule, so the last one goes first
+            expectedOutput =
+                "add rule inet filter acls position 4 reject comment \"reject eveything\"\n"
+                "add rule inet filter acls position 4 ip saddr 192.168.0.0/24 drop comment \"deny 192.168.0.0/24\"\n";
             srSess.setItem(
                     "/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='deny 192.168.0.0/24']/matches/ipv4/source-ipv4-network",
                     "192.168.0.0/24");
@@ -120,8 +126,7 @@ TEST_CASE("nftables generator")
     {
         // Add a non-empty ACL
         {
-            REQUIRE_CALL(nft, consumeConfig(NFTABLES_OUTPUT_START +
-                        "add rule inet filter acls ip saddr 192.168.0.0/24 drop comment \"deny 192.168.0.0/24\"\n"));
+            REQUIRE_CALL(nft, consumeConfig("add rule inet filter acls position 4 ip saddr 192.168.0.0/24 drop comment \"deny 192.168.0.0/24\"\n"));
             srSess.setItem("/ietf-access-control-list:acls/acl[name='acls']/type", "mixed-eth-ipv4-ipv6-acl-type");
             srSess.setItem(
                     "/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='deny 192.168.0.0/24']/matches/ipv4/source-ipv4-network",
@@ -132,9 +137,7 @@ TEST_CASE("nftables generator")
 
         SECTION("add another ACE")
         {
-            expectedOutput = NFTABLES_OUTPUT_START +
-                "add rule inet filter acls ip saddr 192.168.0.0/24 drop comment \"deny 192.168.0.0/24\"\n"
-                "add rule inet filter acls ip saddr 192.168.13.0/24 drop comment \"also deny 192.168.13.0/24\"\n";
+            expectedOutput = "add rule inet filter acls position 5 ip saddr 192.168.13.0/24 drop comment \"also deny 192.168.13.0/24\"\n";
             srSess.setItem(
                     "/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='also deny 192.168.13.0/24']/matches/ipv4/source-ipv4-network",
                     "192.168.13.0/24");
@@ -142,16 +145,23 @@ TEST_CASE("nftables generator")
 
         }
 
+        SECTION("change ACE")
+        {
+            expectedOutput = "replace rule inet filter acls handle 5 ip saddr 192.168.0.0/24 accept comment \"deny 192.168.0.0/24\"\n";
+            srSess.setItem("/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='deny 192.168.0.0/24']/actions/forwarding", "accept");
+        }
+
         SECTION("remove ACE")
         {
-            expectedOutput = NFTABLES_OUTPUT_START;
+            expectedOutput = "delete rule inet filter acls handle 5\n";
             srSess.deleteItem("/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='deny 192.168.0.0/24']");
         }
 
         SECTION("remove previous ACE and add another")
         {
-            expectedOutput = NFTABLES_OUTPUT_START +
-                "add rule inet filter acls ip saddr 192.168.13.0/24 drop comment \"deny 192.168.13.0/24\"\n";
+            expectedOutput =
+                "delete rule inet filter acls handle 5\n"
+                "add rule inet filter acls position 4 ip saddr 192.168.13.0/24 drop comment \"deny 192.168.13.0/24\"\n";
             srSess.deleteItem("/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='deny 192.168.0.0/24']");
             srSess.setItem(
                     "/ietf-access-control-list:acls/acl[name='acls']/aces/ace[name='deny 192.168.13.0/24']/matches/ipv4/source-ipv4-network",
@@ -161,7 +171,7 @@ TEST_CASE("nftables generator")
 
         SECTION("remove entire ACL")
         {
-            expectedOutput = NFTABLES_OUTPUT_START;
+            expectedOutput = "delete rule inet filter acls handle 5\n";
             srSess.deleteItem("/ietf-access-control-list:acls/acl[name='acls']");
         }
 
@@ -169,3 +179,48 @@ TEST_CASE("nftables generator")
         srSess.applyChanges(TIMEOUT);
     }
 }
+
+TEST_CASE("nftables ruleset updates")
+{
+    using velia::firewall::Rule;
+    const velia::firewall::InstalledRules installed{
+        .rules = {{"a", "drop comment \"a\""}, {"b", "accept comment \"b\""}, {"c", "reject comment \"c\""}},
+        .handles = {{"a", 5}, {"b", 6}, {"c", 7}},
+        .anchor = 4,
+    };
+
+    SECTION("no change")
+    {
+        REQUIRE(velia::firewall::generateNftUpdate(installed, installed.rules) == "");
+    }
+
+    SECTION("move the last rule to the front")
+    {
+        REQUIRE(velia::firewall::generateNftUpdate(installed, {installed.rules[2], installed.rules[0], installed.rules[1]}) ==
+                "delete rule inet filter acls handle 7\n"
+                "add rule inet filter acls position 4 reject comment \"c\"\n");
+    }
+
+    SECTION("move the first rule to the end")
+    {
+        REQUIRE(velia::firewall::generateNftUpdate(installed, {installed.rules[1], installed.rules[2], installed.rules[0]}) ==
+                "delete rule inet filter acls handle 5\n"
+                "add rule inet filter acls position 7 drop comment \"a\"\n");
+    }
+
+    SECTION("add, remove and change rules at once")
+    {
+        REQUIRE(velia::firewall::generateNftUpdate(installed, {
+                    {"x", "drop comment \"x\""},
+                    {"y", "drop comment \"y\""},
+                    installed.rules[0],
+                    {"z", "drop comment \"z\""},
+                    {"c", "accept comment \"c\""},
+                }) ==
+                "delete rule inet filter acls handle 6\n"
+                "add rule inet filter acls position 4 drop comment \"y\"\n"
+                "add rule inet filter acls position 4 drop comment \"x\"\n"
+                "add rule inet filter acls position 5 drop comment \"z\"\n"
+                "replace rule inet filter acls handle 7 accept comment \"c\"\n");
+    }
+}
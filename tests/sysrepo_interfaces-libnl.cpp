@@ -6,14 +6,21 @@
 */
 
 #include "trompeloeil_doctest.h"
+#include <algorithm>
+#include <array>
 #include <boost/algorithm/string/join.hpp>
 #include <cstdlib>
 #include <netlink/route/addr.h>
+#include <poll.h>
 #include <regex>
+#include <set>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <thread>
 #include "pretty_printers.h"
+#include "network/EthtoolSampler.h"
 #include "network/Factory.h"
+#include "network/Rtnetlink.h"
 #include "test_log_setup.h"
 #include "test_vars.h"
 #include "tests/configure.cmake.h"
@@ -60,6 +67,16 @@ auto dataFromSysrepoNoStatistics(sysrepo::Session session, const std::string& xp
     REQUIRE(res.erase("/statistics/out-octets") == 1);
     REQUIRE(res.erase("/statistics/out-errors") == 1);
     REQUIRE(res.erase("/statistics/out-discards") == 1);
+    REQUIRE(res.erase("/statistics/in-multicast-pkts") == 1);
+    REQUIRE(res.erase("/statistics/in-unknown-protos") == 1);
+    // the rates only appear once the statistics were sampled at least twice
+    res.erase("/statistics/velia-interfaces:rates");
+    res.erase("/statistics/velia-interfaces:rates/in-bits-per-second");
+    res.erase("/statistics/velia-interfaces:rates/out-bits-per-second");
+    res.erase("/statistics/velia-interfaces:rates/in-packets-per-second");
+    res.erase("/statistics/velia-interfaces:rates/out-packets-per-second");
+    // the bridge FDB is checked separately, its exact contents depend on the kernel version
+    std::erase_if(res, [](const auto& kv) { return kv.first.starts_with("/velia-interfaces:bridge-fdb"); });
     return res;
 }
 
@@ -71,7 +88,8 @@ TEST_CASE("Test ietf-interfaces and ietf-routing")
     TEST_SYSREPO_INIT;
     TEST_SYSREPO_INIT_CLIENT;
 
-    auto network = std::make_shared<velia::network::IETFInterfaces>(srSess);
+    // sample the statistics often enough so that they are up to date after each WAIT
+    auto network = std::make_shared<velia::network::IETFInterfaces>(srSess, 100ms);
 
     iproute2_exec_and_wait(WAIT, "link", "add", IFACE, "address", LINK_MAC, "type", "dummy");
 
@@ -165,6 +183,10 @@ TEST_CASE("Test ietf-interfaces and ietf-routing")
         REQUIRE(dataFromSysrepoNoStatistics(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE + "']", sysrepo::Datastore::Operational) == expectedIface);
         REQUIRE(dataFromSysrepoNoStatistics(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE_BRIDGE + "']", sysrepo::Datastore::Operational) == expectedBridge);
 
+        // the bridge learns the addresses of its ports
+        auto fdb = dataFromSysrepo(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE + "']/velia-interfaces:bridge-fdb", sysrepo::Datastore::Operational);
+        REQUIRE(fdb["/entry[mac-address='" + LINK_MAC + "'][vlan='0']/type"] == "permanent");
+
         iproute2_exec_and_wait(WAIT, "link", "set", "dev", IFACE, "up");
         iproute2_exec_and_wait(WAIT, "addr", "flush", "dev", IFACE); // sometimes, addresses are preserved even when enslaved
         expectedIface["/oper-status"] = "unknown";
@@ -200,6 +222,8 @@ TEST_CASE("Test ietf-interfaces and ietf-routing")
         REQUIRE(dataFromSysrepoNoStatistics(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE + "']", sysrepo::Datastore::Operational) == expectedIface);
         REQUIRE(dataFromSysrepoNoStatistics(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE_BRIDGE + "']", sysrepo::Datastore::Operational) == expectedBridge);
         iproute2_exec_and_wait(WAIT, "link", "set", "dev", IFACE, "nomaster");
+        fdb = dataFromSysrepo(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE + "']/velia-interfaces:bridge-fdb", sysrepo::Datastore::Operational);
+        REQUIRE(!fdb.contains("/entry[mac-address='" + LINK_MAC + "'][vlan='0']"));
         expectedIface.erase("/ietf-ip:ipv4");
         expectedIface.erase("/ietf-ip:ipv6/autoconf");
         expectedIface.erase("/ietf-ip:ipv6");
@@ -207,6 +231,25 @@ TEST_CASE("Test ietf-interfaces and ietf-routing")
         REQUIRE(dataFromSysrepoNoStatistics(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE_BRIDGE + "']", sysrepo::Datastore::Operational) == expectedBridge);
     }
 
+    SECTION("IP neighbours")
+    {
+        // dummy links are created with NOARP, and the neighbours on such links are not reported
+        iproute2_exec_and_wait(WAIT, "link", "set", "dev", IFACE, "arp", "on", "up");
+        iproute2_exec_and_wait(WAIT, "neigh", "add", "192.0.2.2", "lladdr", "02:02:02:02:02:10", "nud", "permanent", "dev", IFACE);
+        iproute2_exec_and_wait(WAIT, "neigh", "add", "2001:db8::2", "lladdr", "02:02:02:02:02:11", "nud", "permanent", "dev", IFACE);
+
+        auto ipv4 = dataFromSysrepo(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE + "']/ietf-ip:ipv4", sysrepo::Datastore::Operational);
+        REQUIRE(ipv4["/neighbor[ip='192.0.2.2']/link-layer-address"] == "02:02:02:02:02:10");
+        auto ipv6 = dataFromSysrepo(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE + "']/ietf-ip:ipv6", sysrepo::Datastore::Operational);
+        REQUIRE(ipv6["/neighbor[ip='2001:db8::2']/link-layer-address"] == "02:02:02:02:02:11");
+
+        iproute2_exec_and_wait(WAIT, "neigh", "del", "192.0.2.2", "dev", IFACE);
+        ipv4 = dataFromSysrepo(client, "/ietf-interfaces:interfaces/interface[name='" + IFACE + "']/ietf-ip:ipv4", sysrepo::Datastore::Operational);
+        REQUIRE(!ipv4.contains("/neighbor[ip='192.0.2.2']"));
+
+        iproute2_exec_and_wait(WAIT, "link", "set", "dev", IFACE, "down");
+    }
+
     SECTION("Add and remove routes")
     {
         iproute2_exec_and_wait(WAIT, "link", "set", "dev", IFACE, "up");
@@ -217,6 +260,8 @@ TEST_CASE("Test ietf-interfaces and ietf-routing")
         auto data = dataFromSysrepo(client, "/ietf-routing:routing", sysrepo::Datastore::Operational);
         REQUIRE(data["/control-plane-protocols"] == "");
         REQUIRE(data["/interfaces"] == "");
+        // the link-local address makes it a network-layer interface
+        REQUIRE(data["/interfaces/interface[.='" + IFACE + "']"] == IFACE);
         REQUIRE(data["/ribs"] == "");
 
         data = dataFromSysrepo(client, "/ietf-routing:routing/ribs/rib[name='ipv4-master']", sysrepo::Datastore::Operational);
@@ -273,6 +318,53 @@ TEST_CASE("Test ietf-interfaces and ietf-routing")
     iproute2_exec_and_wait(WAIT, "link", "del", IFACE, "type", "dummy"); // Executed later again by ctest fixture cleanup just for sure. It remains here because of doctest sections: The interface needs to be setup again.
 }
 
+TEST_CASE("Link speed and duplex via ethtool")
+{
+    TEST_SYSREPO_INIT_LOGS;
+    TEST_SYSREPO_INIT;
+    TEST_SYSREPO_INIT_CLIENT;
+
+    // veth always reports 10Gbps, full duplex
+    iproute2_exec_and_wait(0ms, "link", "add", "czechlight_v0", "type", "veth", "peer", "name", "czechlight_v1");
+    auto network = std::make_shared<velia::network::IETFInterfaces>(srSess);
+    std::this_thread::sleep_for(WAIT);
+
+    auto data = dataFromSysrepo(client, "/ietf-interfaces:interfaces/interface[name='czechlight_v0']", sysrepo::Datastore::Operational);
+    REQUIRE(data["/speed"] == "10000000000");
+    REQUIRE(data["/velia-interfaces:duplex"] == "full");
+
+    SECTION("links which appear later are picked up by the next sample")
+    {
+        // a long interval, so that only the explicit sample() calls matter
+        velia::network::EthtoolSampler sampler([rtnetlink = network->rtnetlink()]() {
+            std::map<int, std::string> names;
+            rtnetlink->forEachLink([&names](rtnl_link* link) { names.emplace(rtnl_link_get_ifindex(link), rtnl_link_get_name(link)); });
+            std::map<std::string, velia::network::Rtnetlink::EthtoolLinkInfo> res;
+            for (const auto& [ifindex, info] : rtnetlink->getEthtoolLinkInfo()) {
+                res.emplace(names.at(ifindex), info);
+            }
+            return res;
+        }, 1h);
+        REQUIRE(sampler.snapshot().at("czechlight_v0").speed == 10'000'000'000);
+
+        iproute2_exec_and_wait(WAIT, "link", "add", "czechlight_v2", "type", "veth", "peer", "name", "czechlight_v3");
+        iproute2_exec_and_wait(WAIT, "link", "add", IFACE, "type", "dummy");
+        REQUIRE(!sampler.snapshot().contains("czechlight_v2"));
+
+        sampler.sample();
+        auto snapshot = sampler.snapshot();
+        REQUIRE(snapshot.at("czechlight_v2").speed == 10'000'000'000);
+        REQUIRE(snapshot.at("czechlight_v2").fullDuplex == true);
+        // a dummy link has no idea about its speed
+        REQUIRE((!snapshot.contains(IFACE) || !snapshot.at(IFACE).speed));
+
+        iproute2_exec_and_wait(WAIT, "link", "del", "czechlight_v2");
+        iproute2_exec_and_wait(WAIT, "link", "del", IFACE);
+    }
+
+    iproute2_exec_and_wait(WAIT, "link", "del", "czechlight_v0");
+}
+
 TEST_CASE("concurrent modifications within a systemd-networkd callback")
 {
     TEST_SYSREPO_INIT_LOGS;
@@ -315,13 +407,265 @@ TEST_CASE("concurrent modifications within a systemd-networkd callback")
             std::this_thread::sleep_for(WAIT);
             ++reloaded;
         },
-        []() { return std::string{}; },
-        velia::network::LLDPDataProvider::LocalData{
-            .chassisId = "xxx",
-            .chassisSubtype = "local",
-        });
+        std::make_shared<velia::network::LLDPDataProvider>(
+            []() { return std::string{}; },
+            velia::network::LLDPDataProvider::LocalData{
+                .chassisId = "xxx",
+                .chassisSubtype = "local",
+            }));
 
     std::this_thread::sleep_for(WAIT);
     REQUIRE(reloaded == 2);
     // we're in a network namespace, and there are no doctest SECTIONs, so we do not have to clean up
 }
+
+TEST_CASE("Rtnetlink driven by an external event loop")
+{
+    TEST_SYSREPO_INIT_LOGS;
+
+    const auto iface = "czechlight1"s;
+    std::vector<std::pair<std::string, int>> linkEvents;
+    velia::network::Rtnetlink rtnetlink(
+        [&linkEvents](rtnl_link* link, int action) { linkEvents.emplace_back(rtnl_link_get_name(link), action); },
+        [](rtnl_addr*, int) {},
+        [](rtnl_route*, int) {},
+        [](rtnl_neigh*, int) {},
+        velia::network::Rtnetlink::EventLoop::External);
+
+    auto isReadable = [&rtnetlink]() {
+        pollfd pfd{.fd = rtnetlink.fd(), .events = POLLIN, .revents = 0};
+        return ::poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+    };
+
+    rtnetlink.processEvents(); // must not block when there is nothing to read
+    linkEvents.clear(); // the links left behind by other test cases might still be settling down
+
+    // the kernel sends the notification before ip(8) exits, so there's no need to wait
+    iproute2_exec_and_wait(0ms, "link", "add", iface, "type", "dummy");
+    REQUIRE(std::find_if(linkEvents.begin(), linkEvents.end(), [&iface](const auto& e) { return e.first == iface; }) == linkEvents.end()); // nothing is dispatched until the caller asks for it
+    REQUIRE(isReadable());
+    rtnetlink.processEvents();
+    REQUIRE(std::find(linkEvents.begin(), linkEvents.end(), std::pair{iface, NL_ACT_NEW}) != linkEvents.end());
+
+    linkEvents.clear();
+    iproute2_exec_and_wait(0ms, "link", "del", iface);
+    REQUIRE(isReadable());
+    rtnetlink.processEvents();
+    REQUIRE(std::find(linkEvents.begin(), linkEvents.end(), std::pair{iface, NL_ACT_DEL}) != linkEvents.end());
+}
+
+TEST_CASE("Rtnetlink tracks routes only from the selected tables")
+{
+    TEST_SYSREPO_INIT_LOGS;
+
+    const auto iface = "czechlight3"s;
+    iproute2_exec_and_wait(0ms, "link", "add", iface, "type", "dummy");
+    iproute2_exec_and_wait(0ms, "link", "set", "dev", iface, "up");
+
+    std::set<std::pair<uint32_t, int>> routeEvents;
+    velia::network::Rtnetlink rtnetlink(
+        [](rtnl_link*, int) {},
+        [](rtnl_addr*, int) {},
+        [&routeEvents](rtnl_route* route, int action) { routeEvents.emplace(rtnl_route_get_table(route), action); },
+        [](rtnl_neigh*, int) {},
+        velia::network::Rtnetlink::EventLoop::External,
+        {.ids = {100}, .vrfs = {}});
+
+    auto processAllEvents = [&rtnetlink]() {
+        std::array<pollfd, 2> pfds{{{.fd = rtnetlink.fd(), .events = POLLIN, .revents = 0}, {.fd = rtnetlink.routeFd(), .events = POLLIN, .revents = 0}}};
+        while (::poll(pfds.data(), pfds.size(), 0) > 0) {
+            rtnetlink.processEvents();
+        }
+    };
+
+    iproute2_exec_and_wait(0ms, "route", "add", "198.51.100.0/24", "dev", iface, "table", "100");
+    iproute2_exec_and_wait(0ms, "route", "add", "198.51.100.0/24", "dev", iface, "table", "101");
+    processAllEvents();
+    REQUIRE(routeEvents == std::set<std::pair<uint32_t, int>>{{100, NL_ACT_NEW}});
+
+    auto routes = rtnetlink.getRoutes();
+    REQUIRE(routes.size() == 1);
+    REQUIRE(rtnl_route_get_table(routes[0].get()) == 100);
+
+    routeEvents.clear();
+    iproute2_exec_and_wait(0ms, "route", "del", "198.51.100.0/24", "dev", iface, "table", "101");
+    iproute2_exec_and_wait(0ms, "route", "del", "198.51.100.0/24", "dev", iface, "table", "100");
+    processAllEvents();
+    REQUIRE(routeEvents == std::set<std::pair<uint32_t, int>>{{100, NL_ACT_DEL}});
+
+    iproute2_exec_and_wait(0ms, "link", "del", iface);
+}
+
+TEST_CASE("Rtnetlink replaces the next hops of a changed IPv6 route")
+{
+    TEST_SYSREPO_INIT_LOGS;
+
+    const auto iface = "czechlight4"s;
+    iproute2_exec_and_wait(0ms, "link", "add", iface, "type", "dummy");
+    iproute2_exec_and_wait(0ms, "link", "set", "dev", iface, "up");
+    iproute2_exec_and_wait(0ms, "-6", "addr", "add", "2001:db8::1/64", "dev", iface, "nodad");
+
+    std::vector<int> routeEvents;
+    velia::network::Rtnetlink rtnetlink(
+        [](rtnl_link*, int) {},
+        [](rtnl_addr*, int) {},
+        [&routeEvents](rtnl_route*, int action) { routeEvents.push_back(action); },
+        [](rtnl_neigh*, int) {},
+        velia::network::Rtnetlink::EventLoop::External,
+        {.ids = {100}, .vrfs = {}});
+
+    auto processAllEvents = [&rtnetlink]() {
+        std::array<pollfd, 2> pfds{{{.fd = rtnetlink.fd(), .events = POLLIN, .revents = 0}, {.fd = rtnetlink.routeFd(), .events = POLLIN, .revents = 0}}};
+        while (::poll(pfds.data(), pfds.size(), 0) > 0) {
+            rtnetlink.processEvents();
+        }
+    };
+
+    auto gateways = [&rtnetlink]() {
+        std::vector<std::string> res;
+        rtnetlink.forEachRoute([&res](rtnl_route* route) {
+            for (int i = 0; i < rtnl_route_get_nnexthops(route); ++i) {
+                std::array<char, INET6_ADDRSTRLEN> buf;
+                res.emplace_back(nl_addr2str(rtnl_route_nh_get_gateway(rtnl_route_nexthop_n(route, i)), buf.data(), buf.size()));
+            }
+        });
+        std::sort(res.begin(), res.end());
+        return res;
+    };
+
+    iproute2_exec_and_wait(0ms, "-6", "route", "add", "2001:db8:1::/48", "via", "2001:db8::a", "dev", iface, "table", "100");
+    processAllEvents();
+    REQUIRE(routeEvents == std::vector<int>{NL_ACT_NEW});
+    REQUIRE(gateways() == std::vector<std::string>{"2001:db8::a"});
+
+    // libnl on its own would merge the new next hop into the cached route
+    routeEvents.clear();
+    iproute2_exec_and_wait(0ms, "-6", "route", "replace", "2001:db8:1::/48", "via", "2001:db8::b", "dev", iface, "table", "100");
+    processAllEvents();
+    REQUIRE(routeEvents == std::vector<int>{NL_ACT_CHANGE});
+    REQUIRE(gateways() == std::vector<std::string>{"2001:db8::b"});
+
+    routeEvents.clear();
+    iproute2_exec_and_wait(0ms, "-6", "route", "append", "2001:db8:1::/48", "via", "2001:db8::c", "dev", iface, "table", "100");
+    processAllEvents();
+    REQUIRE(routeEvents == std::vector<int>{NL_ACT_CHANGE});
+    REQUIRE(gateways() == std::vector<std::string>{"2001:db8::b", "2001:db8::c"});
+
+    routeEvents.clear();
+    iproute2_exec_and_wait(0ms, "-6", "route", "replace", "2001:db8:1::/48", "via", "2001:db8::d", "dev", iface, "table", "100");
+    processAllEvents();
+    REQUIRE(routeEvents == std::vector<int>{NL_ACT_CHANGE});
+    REQUIRE(gateways() == std::vector<std::string>{"2001:db8::d"});
+
+    // a resync dumps the same route, so nothing changes
+    routeEvents.clear();
+    rtnetlink.resync();
+    REQUIRE(routeEvents.empty());
+    REQUIRE(gateways() == std::vector<std::string>{"2001:db8::d"});
+
+    iproute2_exec_and_wait(0ms, "-6", "route", "del", "2001:db8:1::/48", "table", "100");
+    processAllEvents();
+    REQUIRE(routeEvents == std::vector<int>{NL_ACT_DEL});
+    REQUIRE(gateways().empty());
+
+    iproute2_exec_and_wait(0ms, "link", "del", iface);
+}
+
+TEST_CASE("Link statistics dump")
+{
+    TEST_SYSREPO_INIT_LOGS;
+
+    velia::network::Rtnetlink rtnetlink([](rtnl_link*, int) {}, [](rtnl_addr*, int) {}, [](rtnl_route*, int) {}, [](rtnl_neigh*, int) {});
+
+    std::map<int, rtnl_link*> links;
+    auto fullLinks = rtnetlink.getLinks();
+    for (const auto& link : fullLinks) {
+        links.emplace(rtnl_link_get_ifindex(link.get()), link.get());
+    }
+
+    auto stats = rtnetlink.getLinkStatistics();
+    REQUIRE(stats.size() == links.size());
+    for (const auto& [ifindex, counters] : stats) {
+        REQUIRE(links.contains(ifindex));
+        // nothing should be generating traffic on the loopback in this network namespace
+        if (rtnl_link_get_name(links[ifindex]) == "lo"s) {
+            REQUIRE(counters.rx_bytes == rtnl_link_get_stat(links[ifindex], RTNL_LINK_RX_BYTES));
+            REQUIRE(counters.tx_packets == rtnl_link_get_stat(links[ifindex], RTNL_LINK_TX_PACKETS));
+        }
+    }
+}
+
+TEST_CASE("Rtnetlink recovers from lost notifications")
+{
+    TEST_SYSREPO_INIT_LOGS;
+
+    std::set<std::string> links;
+    velia::network::Rtnetlink rtnetlink(
+        [&links](rtnl_link* link, int action) {
+            if (action == NL_ACT_DEL) {
+                links.erase(rtnl_link_get_name(link));
+            } else {
+                links.insert(rtnl_link_get_name(link));
+            }
+        },
+        [](rtnl_addr*, int) {},
+        [](rtnl_route*, int) {},
+        [](rtnl_neigh*, int) {},
+        velia::network::Rtnetlink::EventLoop::External);
+    rtnetlink.invokeInitialCallbacks();
+
+    auto processAllEvents = [&rtnetlink]() {
+        pollfd pfd{.fd = rtnetlink.fd(), .events = POLLIN, .revents = 0};
+        while (::poll(&pfd, 1, 0) == 1) {
+            rtnetlink.processEvents();
+        }
+    };
+
+    SECTION("Explicit resync")
+    {
+        const auto iface = "czechlight2"s;
+
+        iproute2_exec_and_wait(0ms, "link", "add", iface, "type", "dummy");
+        REQUIRE(!links.contains(iface));
+        rtnetlink.resync();
+        REQUIRE(links.contains(iface));
+
+        iproute2_exec_and_wait(0ms, "link", "del", iface);
+        rtnetlink.resync();
+        REQUIRE(!links.contains(iface));
+
+        // the notifications which were queued in the meantime agree with the resynced state
+        processAllEvents();
+        REQUIRE(!links.contains(iface));
+        REQUIRE(rtnetlink.overruns() == 0);
+    }
+
+    SECTION("Socket buffer overrun")
+    {
+        // the kernel rounds this up to its minimum, which only fits a couple of messages
+        int tiny = 1;
+        REQUIRE(setsockopt(rtnetlink.fd(), SOL_SOCKET, SO_RCVBUF, &tiny, sizeof(tiny)) == 0);
+
+        const auto batchFile = std::filesystem::path(CMAKE_CURRENT_BINARY_DIR) / "tests/network-libnl-overrun.batch"s;
+        std::string addLinks, delLinks;
+        for (int i = 0; i < 64; ++i) {
+            addLinks += std::format("link add clstorm{} type dummy\n", i);
+            delLinks += std::format("link del clstorm{}\n", i);
+        }
+
+        velia::utils::writeFile(batchFile, addLinks);
+        iproute2_exec_and_wait(0ms, "-batch", batchFile.string());
+        processAllEvents();
+        REQUIRE(rtnetlink.overruns() > 0);
+        for (int i = 0; i < 64; ++i) {
+            REQUIRE(links.contains(std::format("clstorm{}", i)));
+        }
+
+        velia::utils::writeFile(batchFile, delLinks);
+        iproute2_exec_and_wait(0ms, "-batch", batchFile.string());
+        processAllEvents();
+        for (int i = 0; i < 64; ++i) {
+            REQUIRE(!links.contains(std::format("clstorm{}", i)));
+        }
+    }
+}
@@ -308,6 +308,71 @@ EmitLLDP=nearest-bridge
         client.applyChanges();
     }
 
+    SECTION("Changing one link only rewrites its own file")
+    {
+        const auto eth0 = [](const std::string& address) {
+            return R"([Match]
+Name=eth0
+
+[DHCPv4]
+UseDNS=true
+UseNTP=true
+
+[IPv6AcceptRA]
+UseDNS=false
+
+[Network]
+Address=)" + address + R"(
+LinkLocalAddressing=no
+IPv6AcceptRA=false
+DHCP=no
+LLDP=true
+EmitLLDP=nearest-bridge
+)";
+        };
+
+        expectedContents.set("eth0", eth0("192.0.2.1/24"));
+        expectedContents.set("eth1", R"([Match]
+Name=eth1
+
+[DHCPv4]
+UseDNS=false
+UseNTP=false
+
+[IPv6AcceptRA]
+UseDNS=true
+
+[Network]
+Address=2001:db8::1/32
+IPv6AcceptRA=true
+DHCP=no
+LLDP=true
+EmitLLDP=nearest-bridge
+)");
+
+        client.setItem("/ietf-interfaces:interfaces/interface[name='eth0']/enabled", "true");
+        client.setItem("/ietf-interfaces:interfaces/interface[name='eth0']/type", "iana-if-type:ethernetCsmacd");
+        client.setItem("/ietf-interfaces:interfaces/interface[name='eth0']/ietf-ip:ipv4/ietf-ip:address[ip='192.0.2.1']/ietf-ip:prefix-length", "24");
+        client.setItem("/ietf-interfaces:interfaces/interface[name='eth0']/ietf-ip:ipv4/czechlight-network:dhcp-client/enabled", "false");
+        client.setItem("/ietf-interfaces:interfaces/interface[name='eth1']/enabled", "true");
+        client.setItem("/ietf-interfaces:interfaces/interface[name='eth1']/type", "iana-if-type:ethernetCsmacd");
+        client.setItem("/ietf-interfaces:interfaces/interface[name='eth1']/ietf-ip:ipv6/ietf-ip:address[ip='2001:db8::1']/ietf-ip:prefix-length", "32");
+
+        REQUIRE_CALL(fake, cb(ChangedUnits{.deleted = {}, .changedOrNew = {"eth0", "eth1"}})).IN_SEQUENCE(seq1);
+        client.applyChanges();
+
+        // nobody else writes these files, so if the configuration of eth1 was generated and written again, this would be gone
+        const auto eth1Marker = "# not rewritten\n"s;
+        velia::utils::writeFile(NETWORK_FILE("eth1"), eth1Marker);
+        expectedContents.set("eth1", eth1Marker);
+
+        expectedContents.set("eth0", eth0("192.0.2.2/24"));
+        client.deleteItem("/ietf-interfaces:interfaces/interface[name='eth0']/ietf-ip:ipv4/ietf-ip:address[ip='192.0.2.1']");
+        client.setItem("/ietf-interfaces:interfaces/interface[name='eth0']/ietf-ip:ipv4/ietf-ip:address[ip='192.0.2.2']/ietf-ip:prefix-length", "24");
+        REQUIRE_CALL(fake, cb(ChangedUnits{.deleted = {}, .changedOrNew = {"eth0"}})).IN_SEQUENCE(seq1);
+        client.applyChanges();
+    }
+
     SECTION("Setup a bridge br0 over eth0 and eth1")
     {
         expectedContents.set("br0", R"([Match]
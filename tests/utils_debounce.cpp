@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <atomic>
+#include "utils/debounce.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+/** @short Waits until the callback has been invoked @p expected times, with a deadline that is generous even for a loaded machine */
+bool waitForCalls(const std::atomic<int>& calls, int expected)
+{
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (calls < expected && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(5ms);
+    }
+    return calls == expected;
+}
+}
+
+TEST_CASE("Debouncer")
+{
+    // Only the lower bounds of the delays are exact. The scheduler can always delay the callback some more, so the checks of the upper
+    // bounds leave plenty of slack.
+    const auto quietPeriod = 300ms;
+    const auto maxDelay = 1000ms;
+    std::atomic<int> calls = 0;
+    velia::utils::Debouncer debouncer([&calls]() { ++calls; }, quietPeriod, maxDelay);
+
+    SECTION("No trigger, no call")
+    {
+        std::this_thread::sleep_for(2 * quietPeriod);
+        REQUIRE(calls == 0);
+    }
+
+    SECTION("A burst is coalesced")
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 100; ++i) {
+            debouncer.trigger();
+        }
+        REQUIRE(waitForCalls(calls, 1));
+        REQUIRE(std::chrono::steady_clock::now() - start >= quietPeriod);
+
+        // nothing else is pending
+        std::this_thread::sleep_for(2 * quietPeriod);
+        REQUIRE(calls == 1);
+
+        start = std::chrono::steady_clock::now();
+        debouncer.trigger();
+        REQUIRE(waitForCalls(calls, 2));
+        REQUIRE(std::chrono::steady_clock::now() - start >= quietPeriod);
+    }
+
+    SECTION("Immediate trigger skips the quiet period")
+    {
+        auto start = std::chrono::steady_clock::now();
+        debouncer.trigger();
+        debouncer.triggerNow();
+        REQUIRE(waitForCalls(calls, 1));
+        REQUIRE(std::chrono::steady_clock::now() - start < quietPeriod);
+
+        // an ordinary trigger waits for the quiet period again
+        start = std::chrono::steady_clock::now();
+        debouncer.trigger();
+        REQUIRE(waitForCalls(calls, 2));
+        REQUIRE(std::chrono::steady_clock::now() - start >= quietPeriod);
+    }
+
+    SECTION("Continuous triggers are bounded by the maximal delay")
+    {
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < 2 * maxDelay + quietPeriod) {
+            debouncer.trigger();
+            std::this_thread::sleep_for(10ms);
+        }
+
+        // the quiet period never elapsed, so each of these calls was forced by the maximal delay
+        const int forced = calls;
+        REQUIRE(forced >= 1);
+        REQUIRE(forced <= 2);
+
+        // the last triggers are handled once they stop
+        REQUIRE(waitForCalls(calls, forced + 1));
+    }
+}
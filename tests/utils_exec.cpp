@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include "test_log_setup.h"
+#include "test_vars.h"
+#include "utils/exec.h"
+
+using namespace std::literals;
+
+TEST_CASE("Executing processes")
+{
+    TEST_INIT_LOGS;
+    auto log = spdlog::get("main");
+
+    SECTION("stdout is returned")
+    {
+        REQUIRE(velia::utils::execAndWait(log, SH_EXECUTABLE, {"-c", "echo hello; echo ignored >&2"}, "") == "hello\n");
+    }
+
+    SECTION("stdin is passed")
+    {
+        REQUIRE(velia::utils::execAndWait(log, SH_EXECUTABLE, {"-c", "read line; echo \"got $line\""}, "something\n") == "got something\n");
+    }
+
+    SECTION("Non-zero exit code")
+    {
+        REQUIRE_THROWS_WITH_AS(velia::utils::execAndWait(log, SH_EXECUTABLE, {"-c", "exit 3"}, ""),
+                               (SH_EXECUTABLE " returned non-zero exit code 3"s).c_str(),
+                               std::runtime_error);
+    }
+
+    SECTION("Output larger than a pipe buffer does not block the child")
+    {
+        // ~1.3 MB on stderr and stdout each, while the stdin is being written as well
+        const auto script = "i=0; while [ $i -lt 40000 ]; do echo xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx; echo yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy >&2; i=$((i+1)); done; cat >/dev/null";
+        auto out = velia::utils::execAndWait(log, SH_EXECUTABLE, {"-c", script}, std::string(1 << 20, 'z'));
+        REQUIRE(out.size() == 40000 * 32);
+    }
+
+    SECTION("A child which does not read its stdin")
+    {
+        REQUIRE(velia::utils::execAndWait(log, SH_EXECUTABLE, {"-c", "exec <&-; echo done"}, std::string(1 << 20, 'z')) == "done\n");
+    }
+
+    SECTION("Timeout")
+    {
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE_THROWS_WITH_AS(velia::utils::execAndWait(log, SH_EXECUTABLE, {"-c", "sleep 10"}, "", {}, 200ms),
+                               (SH_EXECUTABLE " timed out"s).c_str(),
+                               std::runtime_error);
+        REQUIRE(std::chrono::steady_clock::now() - start < 5s);
+    }
+
+    SECTION("Asynchronous execution")
+    {
+        auto future = velia::utils::execAsync(log, SH_EXECUTABLE, {"-c", "sleep 0.2; echo async"}, "");
+        REQUIRE(future.wait_for(0s) == std::future_status::timeout);
+        REQUIRE(future.get() == "async\n");
+    }
+
+    SECTION("Cancellation")
+    {
+        std::stop_source stop;
+        auto future = velia::utils::execAsync(log, SH_EXECUTABLE, {"-c", "sleep 10"}, "", {}, std::nullopt, stop.get_token());
+        std::this_thread::sleep_for(100ms);
+        stop.request_stop();
+        REQUIRE(future.wait_for(5s) == std::future_status::ready);
+        REQUIRE_THROWS_WITH_AS(future.get(), (SH_EXECUTABLE " cancelled"s).c_str(), std::runtime_error);
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <filesystem>
+#include "tests/configure.cmake.h"
+#include "utils/io.h"
+
+using namespace std::string_literals;
+
+TEST_CASE("Multi-file transactions")
+{
+    const auto dir = std::filesystem::path(CMAKE_CURRENT_BINARY_DIR) / "tests/utils_io";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "a");
+    std::filesystem::create_directories(dir / "b");
+
+    velia::utils::writeFile(dir / "a" / "existing", "old");
+
+    velia::utils::FileTransaction transaction;
+    REQUIRE(transaction.empty());
+
+    transaction.write(dir / "a" / "existing", "new contents");
+    transaction.write(dir / "a" / "new", "hello");
+    transaction.write(dir / "b" / "empty", "");
+    REQUIRE(!transaction.empty());
+
+    SECTION("Nothing is written before the commit")
+    {
+        REQUIRE(velia::utils::readFileToString(dir / "a" / "existing") == "old");
+        REQUIRE(!std::filesystem::exists(dir / "a" / "new"));
+        REQUIRE(!std::filesystem::exists(dir / "b" / "empty"));
+    }
+
+    SECTION("Commit")
+    {
+        SECTION("Writing a file again replaces the staged contents")
+        {
+            transaction.write(dir / "a" / "new", "world!");
+            REQUIRE(transaction.commit() == "new contents"s.size() + "world!"s.size());
+            REQUIRE(velia::utils::readFileToString(dir / "a" / "new") == "world!");
+        }
+
+        SECTION("All files")
+        {
+            REQUIRE(transaction.commit() == "new contents"s.size() + "hello"s.size());
+            REQUIRE(velia::utils::readFileToString(dir / "a" / "new") == "hello");
+        }
+
+        REQUIRE(transaction.empty());
+        REQUIRE(velia::utils::readFileToString(dir / "a" / "existing") == "new contents");
+        REQUIRE(velia::utils::readFileToString(dir / "b" / "empty") == "");
+        REQUIRE(!std::filesystem::exists(dir / "a" / "new~"));
+    }
+
+    SECTION("Failures are reported")
+    {
+        transaction.write(dir / "nonexistent" / "file", "x");
+        REQUIRE_THROWS_AS(transaction.commit(), std::runtime_error);
+    }
+}
+
+TEST_CASE("Replacing a file without syncing it")
+{
+    const auto dir = std::filesystem::path(CMAKE_CURRENT_BINARY_DIR) / "tests/utils_io-replace";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    velia::utils::replaceFile(dir / "metrics", "first");
+    REQUIRE(velia::utils::readFileToString(dir / "metrics") == "first");
+
+    velia::utils::replaceFile(dir / "metrics", "second");
+    REQUIRE(velia::utils::readFileToString(dir / "metrics") == "second");
+    REQUIRE(!std::filesystem::exists(dir / "metrics~"));
+
+    REQUIRE_THROWS(velia::utils::replaceFile(dir / "nonexistent" / "metrics", "x"));
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2026 CESNET, https://photonics.cesnet.cz/
+ *
+ */
+
+#include "trompeloeil_doctest.h"
+#include <atomic>
+#include "utils/periodic.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Periodic task")
+{
+    std::atomic<int> calls = 0;
+
+    SECTION("The first run happens in the constructor")
+    {
+        velia::utils::PeriodicTask task([&calls]() { ++calls; }, 1h);
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("Runs keep coming until destroyed")
+    {
+        {
+            velia::utils::PeriodicTask task([&calls]() { ++calls; }, 10ms);
+            for (auto deadline = std::chrono::steady_clock::now() + 10s; calls < 5 && std::chrono::steady_clock::now() < deadline;) {
+                std::this_thread::sleep_for(10ms);
+            }
+            REQUIRE(calls >= 5);
+        }
+        auto callsAfterDestruction = calls.load();
+        std::this_thread::sleep_for(50ms);
+        REQUIRE(calls == callsAfterDestruction);
+    }
+
+    REQUIRE(calls > 0);
+}